@@ -0,0 +1,58 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+// Som do sound timer: a emulação registra cada vez que "sound_timer > 0" muda
+// em um ring sem locks (um produtor, um consumidor), carimbando o evento com o
+// tempo emulado em unidades do escalonador. O gerador de onda quadrada
+// converte os carimbos em amostras e liga/desliga o bipe na amostra exata,
+// tanto no callback de áudio do SDL quanto ao gravar um WAV sem janela.
+
+#define CHIP8_AUDIO_RING_SIZE 4096 // Eventos (potência de 2)
+#define CHIP8_BEEP_HZ 440
+#define CHIP8_BEEP_AMPLITUDE 4000
+
+typedef struct {
+    uint64_t time;              // Tempo emulado do evento, em unidades do escalonador
+    uint8_t  on;                // 1 = bipe liga, 0 = desliga
+} Chip8AudioEvent;
+
+typedef struct {
+    Chip8AudioEvent events[CHIP8_AUDIO_RING_SIZE];
+    _Alignas(64) atomic_uint head;        // Escrito só pelo produtor
+    atomic_uint_least64_t now;            // Tempo emulado já coberto pelos eventos publicados
+    _Alignas(64) atomic_uint tail;        // Escrito só pelo consumidor
+    _Alignas(64) uint64_t last_time;      // Só o produtor: carimbo mais recente
+    uint8_t  on;                          // Só o produtor: estado do último evento publicado
+    uint32_t dropped;                     // Eventos adiados por ring cheio
+} Chip8AudioRing;
+
+typedef struct {
+    uint32_t sample_rate;
+    uint32_t clock_hz;          // Unidades do escalonador por segundo emulado
+    uint64_t pos;               // Próxima amostra, na escala do tempo emulado
+    uint32_t phase;             // Fase da onda quadrada (2^32 = um período)
+    uint32_t phase_step;
+    uint8_t  on;
+    uint32_t max_lag;           // Tempo real: atraso (em amostras) a partir do qual o gerador pula adiante
+    uint32_t resync_lag;        // Atraso deixado após pular
+} Chip8Beeper;
+
+// Produtor
+void chip8_audio_init(Chip8AudioRing *r);
+// Informa o estado do som no tempo `time` (não decrescente; valores menores são
+// tratados como o último); publica um evento só quando o estado muda
+void chip8_audio_update(Chip8AudioRing *r, uint64_t time, int on);
+
+// Consumidor
+void chip8_beeper_init(Chip8Beeper *b, uint32_t sample_rate, uint32_t clock_hz);
+uint64_t chip8_beeper_pending(const Chip8Beeper *b, Chip8AudioRing *r); // Amostras com tempo emulado já coberto
+// Gera n amostras seguindo o tempo emulado (sem limite: use chip8_beeper_pending)
+void chip8_beeper_render(Chip8Beeper *b, Chip8AudioRing *r, int16_t *out, uint32_t n);
+// Para o callback de áudio: gera n amostras sem passar do tempo emulado (o nível
+// atual se mantém enquanto a emulação não avança) e pula adiante se ficar atrasado
+void chip8_beeper_stream(Chip8Beeper *b, Chip8AudioRing *r, int16_t *out, uint32_t n);
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "chip8.h"
+
+// Motor em lote: N instâncias da mesma ROM em layout SoA (structure of arrays)
+//
+// As instâncias são agrupadas em fragmentos de CHIP8_BATCH_LANES lanes. Dentro
+// de um fragmento, cada registrador é um vetor indexado pela lane (V[x][lane],
+// pc[lane], display[linha][lane]...). A cada ciclo as lanes com o mesmo PC e o
+// mesmo opcode executam juntas, em laços sobre as lanes que o compilador
+// vetoriza; lanes que divergiram formam grupos menores (ou são executadas uma
+// a uma quando há muitos PCs diferentes) e voltam a andar juntas quando os PCs
+// coincidem de novo.
+//
+// A memória começa compartilhada (imagem da instância modelo). Na primeira
+// escrita (FX33/FX55) a lane recebe uma cópia privada de 4 KB. Os fragmentos
+// são distribuídos entre as threads de um pool fixo; cada chamada de
+// chip8_batch_run_frames sincroniza as threads uma única vez.
+//
+// Semântica idêntica a chip8_run + chip8_tick_timers por frame (acessos fora
+// da memória também fazem wrap-around em 4 KB, mas não são contados), com as
+// quirks da instância modelo.
+
+#define CHIP8_BATCH_LANES 64 // Lanes por fragmento (uma máscara de 64 bits)
+
+typedef struct Chip8Batch Chip8Batch;
+
+// Teclas (bit k = tecla k) da instância no início de cada frame
+// É chamada pelas threads do pool: precisa ser thread-safe
+typedef uint16_t (*Chip8BatchInputFn)(uint32_t instance, uint64_t frame, void *user);
+
+typedef struct {
+    uint64_t lane_steps;        // Instruções executadas somando todas as instâncias
+    uint64_t group_steps;       // Despachos de grupo (lane_steps / group_steps = lanes por despacho)
+} Chip8BatchStats;
+
+// Cria count instâncias, todas copiando o estado de proto (ROM já carregada)
+// threads <= 0 usa o número de processadores online. Retorna NULL se faltar
+// memória ou se proto não for um CHIP-8 (o lote não executa SUPER-CHIP / XO-CHIP)
+Chip8Batch *chip8_batch_create(const Chip8 *proto, uint32_t count, int threads);
+void chip8_batch_destroy(Chip8Batch *b);
+uint32_t chip8_batch_count(const Chip8Batch *b);
+int chip8_batch_threads(const Chip8Batch *b);
+
+// Executa frames de cycles_per_frame ciclos; após cada frame, decrementa os temporizadores
+// input pode ser NULL (mantém as teclas definidas por chip8_batch_set_keys)
+// Retorna 0, ou -1 se faltou memória para a cópia privada de alguma lane
+int chip8_batch_run_frames(Chip8Batch *b, uint32_t frames, uint32_t cycles_per_frame,
+                           Chip8BatchInputFn input, void *user);
+
+void chip8_batch_set_keys(Chip8Batch *b, uint32_t instance, uint16_t keys);
+uint64_t chip8_batch_display_hash(const Chip8Batch *b, uint32_t instance); // Mesmo hash de chip8_display_hash
+// Copia a instância para um Chip8 recém-inicializado (sem cache de instruções: chip8_run a aloca)
+void chip8_batch_export(const Chip8Batch *b, uint32_t instance, Chip8 *out);
+Chip8BatchStats chip8_batch_stats(const Chip8Batch *b);
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include "chip8.h"
+
+// Captura de vídeo em segundo plano: GIF animado (sem perdas) ou Y4M
+//
+// A emulação só copia o display para um slot de um ring de tamanho fixo
+// (chip8_capture_push, ~256 bytes no CHIP-8) a cada frame em que ele mudou;
+// a paleta, a escala inteira, a conversão de cor e a compressão ficam com uma
+// thread separada. Como no trace, a emulação nunca espera por ela: se o ring
+// estiver cheio, o frame é descartado e contado (o seguinte já traz o display
+// atualizado).
+//
+// O formato vem da extensão: ".y4m" grava YUV4MPEG2 4:4:4 a 60 quadros/s,
+// repetindo o quadro anterior nos frames em que o display não mudou; qualquer
+// outra grava um GIF89a de 4 cores em loop, só com o retângulo alterado de
+// cada quadro e a duração em centésimos calculada dos ticks de 60 Hz. Os
+// navegadores tratam atrasos menores que 2 centésimos como 10, então mudanças
+// mais rápidas que isso são agrupadas no quadro seguinte (até 50 quadros/s).
+//
+// No SUPER-CHIP e no XO-CHIP o vídeo tem sempre 128x64 (lores em 2x2).
+
+#define CHIP8_CAPTURE_RING 512      // Frames no ring (~1 MB, potência de 2)
+#define CHIP8_CAPTURE_MAX_SCALE 16  // Escala inteira máxima aplicada pelo codificador
+
+// Cores dos índices de pixel: apagado, plano 1 (o aceso do CHIP-8), só o plano 2, os dois
+typedef uint8_t Chip8CapturePalette[4][3];
+
+typedef struct {
+    uint64_t frame;             // Tick de 60 Hz a partir do qual o display é este
+    uint8_t  hires;
+    // No CHIP-8 só rows[0][y][0] (y < 32); nas máquinas estendidas, como Chip8.ext->screen
+    uint64_t rows[CHIP8_PLANES][CHIP8_HIRES_HEIGHT][2];
+} Chip8CaptureFrame;
+
+typedef struct {
+    Chip8CaptureFrame *ring;
+    _Alignas(64) atomic_size_t head;  // Escrito só pela emulação
+    size_t cached_tail;               // Última posição de tail vista pela emulação
+    uint64_t pushed;                  // Frames gravados no ring
+    uint64_t dropped;                 // Frames descartados com o ring cheio
+    _Alignas(64) atomic_size_t tail;  // Escrito só pela thread de codificação
+    atomic_int stop;
+    int gif;                          // 1 = GIF, 0 = Y4M
+    int scale;
+    int width, height;                // Resolução antes da escala (64x32 ou 128x64)
+    Chip8CapturePalette palette;
+    FILE *file;
+    void *encoder;                    // Estado da thread de codificação (capture.c)
+    void *thread;                     // pthread_t da thread de codificação
+} Chip8Capture;
+
+// Cria path e inicia a thread de codificação; NULL sem memória, com escala fora de
+// 1..CHIP8_CAPTURE_MAX_SCALE ou sem o arquivo
+Chip8Capture *chip8_capture_open(const char *path, Chip8Machine machine, int scale, const Chip8CapturePalette palette);
+// Emulação: o display de c vale a partir do tick `frame` (ticks crescentes)
+void chip8_capture_push(Chip8Capture *cap, const Chip8 *c, uint64_t frame);
+// Espera a thread de codificação liberar um slot: para ferramentas sem tempo real
+// (chip8_headless), que preferem esperar a descartar frames
+void chip8_capture_wait(Chip8Capture *cap);
+// Codifica o que falta, com o último quadro até o tick end_frame, e fecha o arquivo
+// (0, ou -1 se alguma escrita falhou)
+int chip8_capture_close(Chip8Capture *cap, uint64_t end_frame);
+
+#endif
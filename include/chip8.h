@@ -1,10 +1,78 @@
 #ifndef CHIP8_H // Previne a inclusão múltipla do arquivo
 #define CHIP8_H // Define o macro CHIP8_H para evitar inclusões múltiplas
 
+#include <stddef.h>
 #include <stdint.h>
 
+#define CHIP8_WIDTH 64
+#define CHIP8_HEIGHT 32
+
+// Modelos de máquina (Chip8.machine, escolhido por chip8_set_machine em machine.h)
+// SUPER-CHIP e XO-CHIP executam em machine.c e desenham no framebuffer planar Chip8.ext->screen
+typedef enum {
+  CHIP8_MACHINE_CHIP8 = 0, // CHIP-8 original: 4 KB, 64x32 em Chip8.display
+  CHIP8_MACHINE_SCHIP,     // SUPER-CHIP 1.1: 128x64, rolagem, sprites 16x16, FX75/FX85
+  CHIP8_MACHINE_XOCHIP,    // XO-CHIP: SUPER-CHIP + 64 KB, dois planos, F000 NNNN, padrão de áudio
+  CHIP8_MACHINE_COUNT
+} Chip8Machine;
+
+#define CHIP8_HIRES_WIDTH  128
+#define CHIP8_HIRES_HEIGHT 64
+#define CHIP8_PLANES       2              // Planos de bits do XO-CHIP (o SUPER-CHIP usa só o primeiro)
+#define CHIP8_MEMORY_SIZE  65536          // Memória do XO-CHIP; CHIP-8 e SUPER-CHIP usam os primeiros 4 KB
+#define CHIP8_ROM_MAX      (4096 - 0x200) // Maior ROM de CHIP-8 / SUPER-CHIP
+#define CHIP8_ROM_MAX_XO   (CHIP8_MEMORY_SIZE - 0x200)
+
+// Quirks: comportamentos em que as variantes do CHIP-8 divergem (bits de Chip8.quirks)
+// Sem nenhum bit (CHIP8_QUIRKS_MODERN), o núcleo segue as implementações modernas
+#define CHIP8_QUIRK_SHIFT_VY     0x01 // 8XY6/8XYE deslocam VY (e guardam em VX), como no COSMAC VIP
+#define CHIP8_QUIRK_LOAD_STORE_I 0x02 // FX55/FX65 deixam I = I + X + 1
+#define CHIP8_QUIRK_JUMP_VX      0x04 // BNNN salta para VX + NNN (SUPER-CHIP) em vez de V0 + NNN
+#define CHIP8_QUIRK_CLIP         0x08 // DXYN corta o sprite nas bordas em vez de dar a volta
+#define CHIP8_QUIRK_COUNT        16   // Combinações possíveis (um núcleo chip8_run para cada)
+#define CHIP8_QUIRKS_MODERN      0
+
+// Índice do handler de cada instrução na tabela pré-decodificada
+typedef enum {
+  CHIP8_OP_UNDECODED = 0, // Entrada ainda não decodificada (ou invalidada)
+  CHIP8_OP_NOP,           // Opcode desconhecido - ignorado
+  CHIP8_OP_00E0, CHIP8_OP_00EE,
+  CHIP8_OP_1NNN, CHIP8_OP_2NNN,
+  CHIP8_OP_3XKK, CHIP8_OP_4XKK, CHIP8_OP_5XY0,
+  CHIP8_OP_6XKK, CHIP8_OP_7XKK,
+  CHIP8_OP_8XY0, CHIP8_OP_8XY1, CHIP8_OP_8XY2, CHIP8_OP_8XY3, CHIP8_OP_8XY4,
+  CHIP8_OP_8XY5, CHIP8_OP_8XY6, CHIP8_OP_8XY7, CHIP8_OP_8XYE,
+  CHIP8_OP_9XY0,
+  CHIP8_OP_ANNN, CHIP8_OP_BNNN,
+  CHIP8_OP_DXYN,
+  CHIP8_OP_EX9E, CHIP8_OP_EXA1,
+  CHIP8_OP_FX07, CHIP8_OP_FX0A, CHIP8_OP_FX15, CHIP8_OP_FX18, CHIP8_OP_FX1E,
+  CHIP8_OP_FX29, CHIP8_OP_FX33, CHIP8_OP_FX55, CHIP8_OP_FX65,
+  CHIP8_OP_COUNT
+} Chip8Op;
+
+typedef struct { // Instrução pré-decodificada (8 bytes)
+    uint16_t opcode;            // opcode original (repassado aos handlers inst_*)
+    uint16_t nnn;               // endereço de 12 bits
+    uint8_t  op;                // Chip8Op
+    uint8_t  x;                 // nibble X
+    uint8_t  y;                 // nibble Y
+    uint8_t  kk;                // byte baixo
+} Chip8Decoded;
+
+// Parte das máquinas estendidas, alocada por chip8_set_machine (machine.h) só
+// quando o modelo pede: o CHIP-8 não carrega o framebuffer planar nem os 60 KB
+// a mais do XO-CHIP
+typedef struct {
+    // Framebuffer planar: cada linha tem 128 pixels em duas palavras (o bit 63 de
+    // [0] é a coluna 0, o de [1] a coluna 64). Em lores só as linhas 0-31 e a
+    // palavra [0] são usadas. dirty_rows: em hires, o bit y cobre as linhas 2y e 2y + 1
+    uint64_t screen[CHIP8_PLANES][CHIP8_HIRES_HEIGHT][2];
+    uint8_t  memory[];          // XO-CHIP: endereços 0x1000-0xFFFF (ausente no SUPER-CHIP)
+} Chip8Ext;
+
 typedef struct { // Estrutura para o Chip8
-    uint8_t  memory[4096];      // 4KB (4096 bytes) de memória
+    uint8_t  memory[4096];      // 4KB (4096 bytes) de memória; o resto dos 64 KB do XO-CHIP fica em ext
     uint8_t  V[16];             // V0–VF
     uint16_t I;                 // registrador de índice
     uint16_t pc;                // registrador de programa
@@ -15,13 +83,66 @@ typedef struct { // Estrutura para o Chip8
     uint8_t  delay_timer;       // timer de delay
     uint8_t  sound_timer;       // timer de som
 
-    uint8_t  display[64 * 32];  // 0 ou 1 (64x32 pixels)
+    uint64_t display[32];       // 32 linhas de 64 pixels; o bit 63 é a coluna 0
+    uint32_t display_gen;       // incrementado sempre que o display muda (DXYN / 00E0)
+    uint32_t dirty_rows;        // bit y = linha y mudou desde o último chip8_take_dirty_rows
     uint8_t  keypad[16];        // teclado de 16 teclas
+    uint32_t oob_accesses;      // acessos fora dos 4 KB (PC ou I); o endereço faz wrap-around
+    uint64_t idle_cycles;       // ciclos pulados por chip8_skip_idle (o estado final é o mesmo)
+    uint8_t  quirks;            // CHIP8_QUIRK_* (escolhidas por chip8_load_rom a partir do SHA-1 da ROM)
 
+    // Máquinas estendidas (SUPER-CHIP / XO-CHIP); no CHIP-8 ficam zerados
+    uint8_t  machine;           // Chip8Machine
+    uint8_t  hires;             // 1 = 128x64 (00FF), 0 = 64x32 (00FE)
+    uint8_t  planes;            // Planos selecionados por FN01 (bit p = plano p)
+    uint8_t  pitch;             // FX3A: o padrão toca a 4000 * 2^((pitch - 64) / 48) bits/s
+    uint8_t  flags[16];         // Registradores de FX75/FX85 (RPL do HP 48)
+    uint8_t  audio_pattern[16]; // F002: padrão de 128 bits tocado enquanto sound_timer > 0
+    Chip8Ext *ext;              // Framebuffer e memória das estendidas (NULL no CHIP-8)
+
+    // Cache de instruções do CHIP-8, uma por endereço (há ROMs com código em endereço
+    // ímpar): 4096 entradas alocadas por chip8_load_rom (ou pelo primeiro chip8_run),
+    // NULL nas máquinas estendidas. Cada Chip8 tem a sua; chip8_release libera
+    Chip8Decoded *decoded;
 } Chip8;
 
-void chip8_init(Chip8 *c); // Inicializa o Chip8
+// Laços ociosos: trechos que, com teclado e temporizadores fixos, repetem o
+// mesmo estado até o próximo tick ou a próxima tecla
+typedef enum {
+  CHIP8_IDLE_NONE = 0,
+  CHIP8_IDLE_HALT,       // 1NNN para o próprio endereço
+  CHIP8_IDLE_KEY_WAIT,   // FX0A sem nenhuma tecla pressionada
+  CHIP8_IDLE_TIMER_WAIT  // FX07 / 3X00 / 1NNN de volta, esperando delay_timer zerar
+} Chip8Idle;
+
+// Inicializa o Chip8 como CHIP-8, com ext = decoded = NULL (não libera os anteriores:
+// para reiniciar um Chip8 que já carregou uma ROM, chame chip8_release antes)
+void chip8_init(Chip8 *c);
 int chip8_load_rom(Chip8 *c, const char *path); // Carrega o ROM do Chip8 (retorna 0 em sucesso, -1 se erro)
-void chip8_cycle(Chip8 *c); // Executa um ciclo do Chip8
+// Carrega uma imagem já em memória (ex.: mapeada pela biblioteca de ROMs); 0, -2 se grande
+// demais ou -4 sem memória para a cache de instruções
+int chip8_load_rom_image(Chip8 *c, const uint8_t *data, size_t size);
+const char *chip8_load_error(int code); // Mensagem legível para o código retornado por chip8_load_rom
+void chip8_cycle(Chip8 *c); // Executa um ciclo do Chip8 (interpretador de referência)
+// Executa N ciclos usando a tabela pré-decodificada, no núcleo compilado para c->quirks
+// (sem memória para a tabela, pelo interpretador de referência)
+void chip8_run(Chip8 *c, uint32_t cycles);
+// Como chip8_run, mas para antes de um FX15/FX18 que ligaria um temporizador (com os
+// dois zerados, os ticks até ali não mudam nada); retorna os ciclos executados.
+// Nas máquinas estendidas (ou sem memória para a tabela) não executa nada e retorna 0
+uint32_t chip8_run_until_timer(Chip8 *c, uint32_t cycles);
+Chip8Decoded chip8_decode(uint16_t opcode); // Decodifica um opcode para a forma da tabela
+void chip8_invalidate(Chip8 *c, uint16_t addr, uint16_t len); // Invalida a cache após escrita na memória
+void chip8_tick_timers(Chip8 *c); // Decrementa os temporizadores (chamar a 60 Hz)
+uint64_t chip8_display_hash(const Chip8 *c); // Hash FNV-1a de 64 bits do display (ou de Chip8.ext->screen)
+uint8_t chip8_get_pixel(const Chip8 *c, int x, int y); // 0 ou 1 (com wrap-around nas bordas)
+uint32_t chip8_take_dirty_rows(Chip8 *c); // Devolve e zera a máscara de linhas alteradas
+void chip8_display_to_bytes(const Chip8 *c, uint8_t out[CHIP8_WIDTH * CHIP8_HEIGHT]); // Um byte (0/1) por pixel
+void chip8_set_keys(Chip8 *c, uint16_t keys); // Define o teclado a partir de uma máscara (bit k = tecla k)
+uint16_t chip8_get_keys(const Chip8 *c); // Máscara do teclado atual (bit k = tecla k)
+Chip8Idle chip8_idle(const Chip8 *c); // Classifica a instrução em PC (CHIP8_IDLE_NONE se não for um laço ocioso)
+// Se o PC está em um laço ocioso, aplica de uma vez o estado exato após N ciclos e
+// retorna N; caso contrário retorna 0 sem alterar nada
+uint32_t chip8_skip_idle(Chip8 *c, uint32_t cycles);
 
 #endif
@@ -0,0 +1,35 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+// Fila sem locks (um produtor, um consumidor) de eventos do teclado CHIP-8
+//
+// O frontend enfileira cada tecla pressionada ou solta com o instante em que
+// ela chegou (contador de alta resolução do host); a emulação converte o
+// instante no ciclo emulado correspondente e aplica o evento entre duas
+// instruções. Toques mais curtos que um frame não se perdem: cada evento vale
+// por pelo menos uma instrução.
+
+#define CHIP8_INPUT_QUEUE_SIZE 256 // Eventos (potência de 2)
+
+typedef struct {
+    uint64_t time;              // Instante de chegada (contador do host)
+    uint8_t  key;               // Tecla CHIP-8 (0x0-0xF)
+    uint8_t  down;              // 1 = pressionada, 0 = solta
+} Chip8InputEvent;
+
+typedef struct {
+    Chip8InputEvent events[CHIP8_INPUT_QUEUE_SIZE];
+    _Alignas(64) atomic_uint head; // Escrito só pelo produtor
+    _Alignas(64) atomic_uint tail; // Escrito só pelo consumidor
+} Chip8InputQueue;
+
+void chip8_input_init(Chip8InputQueue *q);
+int chip8_input_push(Chip8InputQueue *q, uint64_t time, uint8_t key, int down); // -1 se a fila estiver cheia
+int chip8_input_peek(Chip8InputQueue *q, Chip8InputEvent *ev); // 1 se há evento (sem removê-lo)
+void chip8_input_pop(Chip8InputQueue *q);
+uint16_t chip8_input_apply(uint16_t keys, const Chip8InputEvent *ev); // Máscara (bit k = tecla k) após o evento
+
+#endif
@@ -58,4 +58,12 @@ void inst_FX65(Chip8* chip8, uint16_t opcode); // LD Vx, [I] - Carregar registra
 // Instrução de desenho
 void inst_DXYN(Chip8* chip8, uint16_t opcode); // DRW Vx, Vy, nibble - Desenhar sprite
 
+// Variantes das instruções afetadas pelas quirks (CHIP8_QUIRK_* em chip8.h)
+void inst_8XY6_vy(Chip8* chip8, uint16_t opcode);  // SHR: Vx = Vy >> 1
+void inst_8XYE_vy(Chip8* chip8, uint16_t opcode);  // SHL: Vx = Vy << 1
+void inst_BNNN_vx(Chip8* chip8, uint16_t opcode);  // JP: VX + NNN
+void inst_FX55_inc(Chip8* chip8, uint16_t opcode); // LD [I], Vx e I += X + 1
+void inst_FX65_inc(Chip8* chip8, uint16_t opcode); // LD Vx, [I] e I += X + 1
+void inst_DXYN_clip(Chip8* chip8, uint16_t opcode); // DRW cortando nas bordas
+
 #endif
@@ -0,0 +1,33 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include "chip8.h"
+
+// Recompilador dinâmico (x86-64) para blocos básicos do CHIP-8
+//
+// Um bloco é uma sequência linear de instruções que termina em 1NNN, 2NNN,
+// 00EE, BNNN ou em uma instrução de salto condicional. Os registradores V[]
+// usados pelo bloco ficam em registradores do host enquanto ele executa.
+// DXYN, 00E0 e FX65 viram chamadas aos handlers do interpretador (com V[]
+// devolvido à estrutura em volta da chamada). FX0A e as escritas na memória
+// via I (FX33, FX55) não são traduzidas: o bloco termina antes delas e o
+// interpretador as executa; um FX0A sem tecla consome de uma vez o resto do
+// orçamento. Escritas de FX33/FX55 sobre código já traduzido descartam a
+// cache de blocos. Os blocos são traduzidos para as quirks do
+// Chip8 (c->quirks); se elas mudarem entre chamadas, a cache é descartada.
+//
+// Em plataformas sem suporte (não x86-64 Linux) e nas máquinas estendidas
+// (SUPER-CHIP / XO-CHIP), chip8_jit_run delega tudo para chip8_run.
+
+typedef struct Chip8Jit Chip8Jit;
+
+Chip8Jit *chip8_jit_create(void); // Aloca o JIT (retorna NULL apenas se faltar memória)
+void chip8_jit_destroy(Chip8Jit *jit); // Libera o JIT e o buffer de código
+int chip8_jit_native(const Chip8Jit *jit); // 1 se gera código nativo, 0 se apenas interpreta
+void chip8_jit_flush(Chip8Jit *jit); // Descarta todos os blocos (chamar após alterar a memória externamente)
+void chip8_jit_run(Chip8Jit *jit, Chip8 *c, uint32_t cycles); // Executa exatamente N ciclos
+// Como chip8_run_until_timer: para antes de um FX15/FX18 que ligaria um temporizador
+// e retorna os ciclos executados (blocos com FX15/FX18 ficam com o interpretador)
+uint32_t chip8_jit_run_until_timer(Chip8Jit *jit, Chip8 *c, uint32_t cycles);
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef LIBCHIP8_H
+#define LIBCHIP8_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// libchip8: API estável para embutir o núcleo (make lib gera libchip8.a e libchip8.so)
+//
+// O Chip8Core é opaco: a estrutura Chip8 (chip8.h) muda entre versões, esta
+// API não. Um núcleo guarda a máquina e o escalonador (clock e ticks de 60 Hz
+// exatos, como no chip8 e no chip8_headless); não há SDL, threads nem cópias:
+// o framebuffer é lido direto da máquina pelo ponteiro de
+// chip8_core_framebuffer, válido enquanto o núcleo existir e atualizado pelas
+// chamadas de execução. Um núcleo não deve ser usado por duas threads ao mesmo
+// tempo; núcleos diferentes são independentes.
+//
+// Na libchip8.so, só as funções deste cabeçalho são exportadas.
+
+#if defined(__GNUC__)
+#define CHIP8_API __attribute__((visibility("default")))
+#else
+#define CHIP8_API
+#endif
+
+#define CHIP8_CORE_API_VERSION 1 // Muda só se esta API mudar de forma incompatível
+
+// Modelos de máquina (os mesmos valores de Chip8Machine)
+#define CHIP8_CORE_MACHINE_CHIP8  0
+#define CHIP8_CORE_MACHINE_SCHIP  1 // SUPER-CHIP 1.1: até 128x64
+#define CHIP8_CORE_MACHINE_XOCHIP 2 // XO-CHIP: até 128x64, dois planos
+
+// Quirks (os mesmos bits de CHIP8_QUIRK_*)
+#define CHIP8_CORE_QUIRK_SHIFT_VY     0x01
+#define CHIP8_CORE_QUIRK_LOAD_STORE_I 0x02
+#define CHIP8_CORE_QUIRK_JUMP_VX      0x04
+#define CHIP8_CORE_QUIRK_CLIP         0x08
+
+typedef struct Chip8Core Chip8Core;
+
+CHIP8_API uint32_t chip8_core_api_version(void); // CHIP8_CORE_API_VERSION da biblioteca carregada
+
+// Novo núcleo sem ROM; NULL se o clock (instruções/s, 60 a 100000000) ou o modelo forem inválidos
+// ou faltar memória
+CHIP8_API Chip8Core *chip8_core_create(uint32_t clock_hz, int machine);
+CHIP8_API void chip8_core_destroy(Chip8Core *core);
+
+// Reinicia a máquina e carrega a imagem em 0x200, com as quirks do banco de ROMs;
+// 0, ou um código para chip8_core_error
+CHIP8_API int chip8_core_load_rom(Chip8Core *core, const uint8_t *data, size_t size);
+CHIP8_API const char *chip8_core_error(int code);
+CHIP8_API void chip8_core_set_quirks(Chip8Core *core, uint8_t quirks); // Após carregar: troca as quirks da ROM
+CHIP8_API uint8_t chip8_core_quirks(const Chip8Core *core);
+
+// Executa n instruções, aplicando os ticks de 60 Hz que caírem no caminho no ciclo exato
+CHIP8_API void chip8_core_run_cycles(Chip8Core *core, uint64_t n);
+// Executa até o próximo tick (um frame de 60 Hz) e o aplica
+CHIP8_API void chip8_core_run_frame(Chip8Core *core);
+CHIP8_API uint64_t chip8_core_frames(const Chip8Core *core);       // Ticks aplicados desde o carregamento
+CHIP8_API uint64_t chip8_core_instructions(const Chip8Core *core); // Instruções executadas desde o carregamento
+
+CHIP8_API void chip8_core_set_keypad(Chip8Core *core, uint16_t keys); // bit k = tecla k pressionada
+CHIP8_API int chip8_core_sound_on(const Chip8Core *core);            // 1 enquanto o sound timer está ativo
+
+// Framebuffer sem cópia: linhas de bits, bit 63 da primeira palavra = coluna 0.
+// No CHIP-8, 32 linhas de uma palavra (plane 0); no SUPER-CHIP e no XO-CHIP, 64 linhas
+// de duas palavras por plano (planes 0 e 1), das quais só as chip8_core_height primeiras
+// (e, em lores, só a primeira palavra) estão em uso. NULL se o plano não existir
+CHIP8_API const uint64_t *chip8_core_framebuffer(const Chip8Core *core, int plane, uint32_t *words_per_row);
+CHIP8_API int chip8_core_width(const Chip8Core *core);  // Resolução atual: 64 ou 128
+CHIP8_API int chip8_core_height(const Chip8Core *core); // 32 ou 64
+// Incrementado a cada mudança do display: compare com o valor anterior para saber se há frame novo
+CHIP8_API uint32_t chip8_core_display_gen(const Chip8Core *core);
+// Devolve e zera a máscara de linhas alteradas (bit y = linha y; em 128x64, linhas 2y e 2y + 1)
+CHIP8_API uint32_t chip8_core_take_dirty_rows(Chip8Core *core);
+CHIP8_API uint64_t chip8_core_display_hash(const Chip8Core *core); // O hash de chip8_headless e dos movies
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef LIBRARY_H
+#define LIBRARY_H
+
+#include <stdio.h>
+#include "chip8.h"
+
+// Biblioteca de ROMs: índice persistente de um diretório de .ch8
+//
+// chip8_library_open varre o diretório e grava o índice em
+// CHIP8_LIBRARY_INDEX dentro dele. Em cada entrada ficam o SHA-1 da ROM (a
+// mesma chave do banco de dados da comunidade CHIP-8), o tamanho, o título, o
+// autor e o ano tirados do nome do arquivo ou da nota .txt de mesmo nome, e as
+// teclas que a nota cita. Nas aberturas seguintes, ROMs e notas com o mesmo
+// tamanho e mtime do índice não são lidas de novo; só as novas ou alteradas
+// são hasheadas. As imagens são mapeadas com mmap na primeira carga e ficam
+// mapeadas até chip8_library_close.
+
+#define CHIP8_LIBRARY_INDEX ".chip8index"
+#define CHIP8_LIBRARY_VERSION 1
+
+typedef struct {
+    char file[256];             // Nome do .ch8 dentro do diretório
+    char title[128];
+    char author[128];
+    uint16_t year;              // 0 = desconhecido
+    uint8_t sha1[20];
+    uint32_t size;
+    int64_t mtime;              // mtime da ROM quando foi hasheada
+    int64_t notes_mtime;        // mtime da nota .txt (0 = sem nota)
+    uint16_t key_hints;         // Teclas citadas na nota (bit k = tecla k)
+    const uint8_t *image;       // Mapeamento da ROM (NULL até a primeira carga)
+} Chip8RomEntry;
+
+typedef struct {
+    char dir[4096];
+    Chip8RomEntry *entries;     // Ordenadas pelo SHA-1
+    uint32_t count;
+    uint32_t hashed;            // ROMs lidas e hasheadas nesta abertura (as demais vieram do índice)
+    int index_written;          // 1 se o índice foi regravado nesta abertura
+} Chip8Library;
+
+// Retornam 0 em sucesso ou um código negativo (ver chip8_library_error)
+int chip8_library_open(Chip8Library *lib, const char *dir);
+void chip8_library_close(Chip8Library *lib);
+const char *chip8_library_error(int code);
+
+// Entrada cujo SHA-1 começa com `hex` (4 a 40 dígitos); NULL se nenhuma ou mais de uma
+const Chip8RomEntry *chip8_library_find(const Chip8Library *lib, const char *hex);
+// Imagem mapeada da ROM (mapeia na primeira chamada); NULL com o código em *error
+const uint8_t *chip8_library_image(Chip8Library *lib, const Chip8RomEntry *e, int *error);
+// Carrega a imagem em c, já inicializado; 0 ou código negativo
+int chip8_library_load(Chip8Library *lib, const Chip8RomEntry *e, Chip8 *c);
+void chip8_library_path(const Chip8Library *lib, const Chip8RomEntry *e, char *out, size_t size);
+void chip8_library_print(const Chip8Library *lib, FILE *out); // Uma linha por ROM, em ordem de título
+
+void chip8_sha1(const uint8_t *data, size_t len, uint8_t out[20]);
+void chip8_sha1_hex(const uint8_t sha1[20], char out[41]);
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef MACHINE_H
+#define MACHINE_H
+
+#include <stddef.h>
+#include "chip8.h"
+
+// Máquinas estendidas: SUPER-CHIP 1.1 e XO-CHIP
+//
+// O modelo fica em Chip8.machine. chip8_cycle e chip8_run repassam as
+// máquinas estendidas para este módulo, que tem o próprio interpretador (a
+// tabela pré-decodificada, o JIT e o motor em lote cobrem só o CHIP-8).
+//
+// O framebuffer (Chip8.ext->screen) guarda cada plano como linhas de 128 bits em
+// duas palavras, no mesmo formato de Chip8.display: um sprite de 16x16 vira,
+// por linha, dois deslocamentos e dois XOR de 64 bits, e a rolagem move
+// palavras inteiras (00CN/00DN) ou desloca as duas palavras de uma linha
+// (00FB/00FC). Em lores a resolução é 64x32 e só a primeira palavra é usada.
+//
+// Instruções além do CHIP-8:
+//   SUPER-CHIP: 00CN, 00FB, 00FC, 00FD, 00FE, 00FF, DXY0 (16x16), FX30, FX75, FX85
+//   XO-CHIP:    as do SUPER-CHIP, 00DN, 5XY2, 5XY3, F000 NNNN, FN01, F002, FX3A
+
+#define CHIP8_BIG_FONT_ADDR 0x0A0 // Fonte 8x10 de FX30 (16 dígitos de 10 bytes), após a fonte 4x5
+
+// Troca o modelo (após chip8_init, antes de carregar a ROM): aloca a extensão
+// do modelo (Chip8.ext: framebuffer no SUPER-CHIP, framebuffer e 60 KB no
+// XO-CHIP) se c ainda não a tem, grava a fonte grande, zera a extensão, os
+// planos e os registradores extras e adota as quirks padrão do modelo (a ROM
+// ainda pode trazer as suas do banco de dados). 0, ou -1 sem memória (c não muda)
+int chip8_set_machine(Chip8 *c, Chip8Machine machine);
+// Deixa em c->ext a extensão do modelo (zerada se precisou ser alocada), sem
+// mexer no resto do estado (nas estendidas, descarta a cache de instruções do
+// CHIP-8); 0, ou -1 sem memória (c não muda)
+int chip8_machine_ext(Chip8 *c, Chip8Machine machine);
+// Libera a extensão e a cache de instruções (ext = decoded = NULL); c continua
+// utilizável como CHIP-8
+void chip8_release(Chip8 *c);
+// Copia src para dst (que já passou por chip8_init), com a extensão: dst não
+// compartilha nada com src e mantém a própria cache de instruções, invalidada só
+// onde a memória difere. 0, ou -1 sem memória (dst não muda)
+int chip8_copy(Chip8 *dst, const Chip8 *src);
+const char *chip8_machine_name(Chip8Machine machine); // "chip8", "schip" ou "xochip"
+int chip8_machine_parse(const char *text, Chip8Machine *machine); // 0, ou -1 se o nome for desconhecido
+uint8_t chip8_machine_quirks(Chip8Machine machine); // Quirks padrão do modelo
+uint32_t chip8_memory_size(const Chip8 *c); // Bytes endereçáveis (4096 ou 65536)
+uint8_t chip8_peek(const Chip8 *c, uint32_t addr); // Byte no endereço, com o wrap-around do modelo
+
+// Executa um opcode já buscado (PC já avançou) / N ciclos em máquina estendida
+void chip8_machine_execute(Chip8 *c, uint16_t opcode);
+void chip8_machine_run(Chip8 *c, uint32_t cycles);
+
+int chip8_screen_width(const Chip8 *c);  // 128 em hires, 64 em lores (e no CHIP-8)
+int chip8_screen_height(const Chip8 *c); // 64 em hires, 32 em lores (e no CHIP-8)
+// Bits dos planos acesos no pixel (bit p = plano p; no CHIP-8, o próprio pixel), com wrap-around
+uint8_t chip8_screen_pixel(const Chip8 *c, int x, int y);
+uint64_t chip8_screen_hash(const Chip8 *c); // FNV-1a 64 da resolução e dos planos (chip8_display_hash das máquinas estendidas)
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef MOVIE_H
+#define MOVIE_H
+
+#include <stddef.h>
+#include "chip8.h"
+
+// Gravação e reprodução determinística de entradas ("movie")
+//
+// Um movie guarda a máscara do teclado (bit k = tecla k) de cada frame, o
+// hash da ROM e as configurações que afetam a emulação. Um frame é o intervalo
+// entre dois ticks dos temporizadores no escalonador (sched.h) com o clock
+// gravado; partindo de chip8_init + chip8_load_rom, reproduzir as mesmas
+// máscaras gera os mesmos framebuffers em qualquer núcleo (referência,
+// pré-decodificado ou JIT).
+//
+// No arquivo, as máscaras são gravadas como sequências (máscara, repetições),
+// já que a mesma combinação de teclas costuma durar vários frames.
+
+#define CHIP8_MOVIE_VERSION 2 // A versão 1 (ciclos por frame em vez do clock) ainda é lida
+
+typedef struct {
+    uint64_t rom_hash;          // FNV-1a 64 do arquivo da ROM
+    uint32_t clock_hz;          // Clock do escalonador (ver sched.h)
+    int vip_costs;              // Custos de opcode do COSMAC VIP
+    uint8_t quirks;             // CHIP8_QUIRK_* da gravação (a reprodução usa estas, não as do banco)
+    uint8_t machine;            // Chip8Machine da gravação (a reprodução exige o mesmo modelo)
+    uint32_t frames;            // Frames gravados
+    uint32_t capacity;
+    uint16_t *keys;             // Máscara do teclado de cada frame
+    uint64_t final_hash;        // chip8_display_hash após o último frame
+    int has_final_hash;
+} Chip8Movie;
+
+void chip8_movie_init(Chip8Movie *m, uint64_t rom_hash, uint32_t clock_hz, int vip_costs);
+void chip8_movie_free(Chip8Movie *m);
+int chip8_movie_append(Chip8Movie *m, uint16_t keys); // 0, ou -1 se faltar memória
+
+// Retornam 0 em sucesso ou um código negativo (ver chip8_movie_error)
+int chip8_movie_save(const Chip8Movie *m, const char *path);
+int chip8_movie_load(Chip8Movie *m, const char *path);
+const char *chip8_movie_error(int code);
+
+int chip8_rom_file_hash(const char *path, uint64_t *hash); // FNV-1a 64 do arquivo (0 ou -1)
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdio.h>
+#include "chip8.h"
+
+// Perfilador do interpretador de referência (chip8_cycle)
+//
+// Só existe em builds com -DCHIP8_PROFILE (make PROFILE=1); sem a flag,
+// chip8_cycle não tem nenhuma instrução a mais e chip8_profile_create retorna
+// NULL. Com um perfil ligado na thread (chip8_profile_attach), cada instrução
+// conta uma execução no seu handler, no seu PC e na pilha de sub-rotinas
+// (2NNN/00EE) em que está; uma a cada CHIP8_PROFILE_SAMPLE execuções de cada
+// handler, e todo DXYN, é cronometrada em ns do host.
+
+#define CHIP8_PROFILE_SAMPLE 64      // Potência de 2
+#define CHIP8_PROFILE_MAX_DEPTH 16   // Profundidade da pilha do CHIP-8
+#define CHIP8_PROFILE_STACKS 65536   // Pilhas distintas guardadas (potência de 2)
+
+typedef struct {
+    uint64_t count;
+    uint16_t frames[CHIP8_PROFILE_MAX_DEPTH]; // Entradas das sub-rotinas, da mais externa à mais interna
+    uint16_t pc;
+    uint8_t  depth;
+    uint8_t  used;
+} Chip8ProfileStack;
+
+typedef struct {
+    uint64_t instructions;
+    uint64_t op_count[CHIP8_OP_COUNT];   // Execuções por handler (Chip8Op)
+    uint64_t op_timed[CHIP8_OP_COUNT];   // Execuções cronometradas
+    uint64_t op_ns[CHIP8_OP_COUNT];      // ns somados nas execuções cronometradas
+    uint64_t draw_calls;                 // inst_DXYN: todas as chamadas são cronometradas
+    uint64_t draw_ns;
+    uint64_t pc_count[4096];
+    uint16_t pc_opcode[4096];            // Último opcode executado em cada PC
+    uint16_t shadow[CHIP8_PROFILE_MAX_DEPTH]; // Entradas das sub-rotinas em execução
+    uint8_t  depth;
+    uint8_t  current_op;                 // Handler da instrução em andamento
+    uint32_t clock_overhead_ns;          // Custo de ler o relógio, descontado de cada medição
+    Chip8ProfileStack *stacks;
+    uint64_t stacks_dropped;             // Execuções cuja pilha não coube na tabela
+} Chip8Profile;
+
+Chip8Profile *chip8_profile_create(void); // NULL sem -DCHIP8_PROFILE ou sem memória
+void chip8_profile_destroy(Chip8Profile *p);
+void chip8_profile_attach(Chip8Profile *p); // Perfil usado por chip8_cycle nesta thread (NULL desliga)
+const char *chip8_profile_op_name(Chip8Op op); // "DXYN", "8XY4"...
+// Relatório plano: handlers por execuções, tempo estimado e os PCs mais executados
+void chip8_profile_report(const Chip8Profile *p, FILE *out, int top_pcs);
+// Pilhas colapsadas ("raiz;sub_0x2A4;0x2B0 DXYN contagem"), aceitas pelo flamegraph.pl
+int chip8_profile_write_collapsed(const Chip8Profile *p, const char *path, const char *root);
+
+#ifdef CHIP8_PROFILE
+extern _Thread_local Chip8Profile *chip8_profile_active;
+uint64_t chip8_profile_begin(Chip8Profile *p, const Chip8 *c); // Antes da instrução em PC: início da medição ou 0
+void chip8_profile_end(Chip8Profile *p, const Chip8 *c, uint64_t start);
+#endif
+
+#endif
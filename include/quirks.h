@@ -0,0 +1,34 @@
+#ifndef QUIRKS_H
+#define QUIRKS_H
+
+#include <stddef.h>
+#include "chip8.h"
+
+// Perfis de quirks e o banco de dados de ROMs conhecidas
+//
+// Um perfil é uma combinação nomeada de CHIP8_QUIRK_* (chip8.h). O banco de
+// dados associa o SHA-1 de uma ROM (a mesma chave da biblioteca, library.h)
+// ao perfil com que ela foi escrita; chip8_load_rom consulta o banco e deixa
+// a combinação em Chip8.quirks. ROMs fora do banco usam as quirks padrão do
+// modelo de máquina (CHIP8_QUIRKS_MODERN no CHIP-8; ver machine.h).
+
+typedef struct {
+    const char *name;
+    uint8_t quirks;
+    const char *description;
+} Chip8QuirkProfile;
+
+extern const Chip8QuirkProfile chip8_quirk_profiles[]; // Terminada por name == NULL
+
+// Quirks da ROM pelo SHA-1 da imagem (fallback, as padrão do modelo de máquina, se ela não estiver no banco)
+uint8_t chip8_quirks_for_rom(const uint8_t *data, size_t size, uint8_t fallback);
+// Consulta direta pelo SHA-1: 1 e a combinação em *quirks se a ROM está no banco, 0 se não
+int chip8_quirks_lookup(const uint8_t sha1[20], uint8_t *quirks);
+
+// Texto com perfis ("vip") e/ou quirks ("shift_vy", "load_store_i", "jump_vx",
+// "clip") separados por vírgula; 0, ou -1 se algum nome for desconhecido
+int chip8_quirks_parse(const char *text, uint8_t *quirks);
+// Nome do perfil com exatamente essas quirks ou a lista delas ("schip", "clip,jump_vx"); retorna `out`
+const char *chip8_quirks_describe(uint8_t quirks, char *out, size_t size);
+
+#endif
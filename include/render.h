@@ -0,0 +1,55 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stdint.h>
+#include "chip8.h"
+
+// Conversão do framebuffer empacotado (1 bit por pixel) para pixels de 32 bits
+//
+// As cores já chegam mapeadas no formato da textura (ex.: via SDL_MapRGBA uma
+// única vez na inicialização), então este módulo não depende do SDL. A
+// expansão usa AVX2 ou SSE2 quando disponíveis (escolhido em tempo de
+// execução) e um caminho escalar sem desvios nos demais casos. Defina
+// CHIP8_NO_SIMD para forçar o caminho escalar.
+
+#define CHIP8_RENDER_MAX_SCALE 16 // Fator máximo de pré-escala inteira
+
+typedef struct { // Paleta de duas cores (pixel apagado / aceso)
+    const char *name;
+    uint8_t off[3];             // RGB do pixel apagado
+    uint8_t on[3];              // RGB do pixel aceso
+} Chip8Palette;
+
+typedef void (*Chip8ExpandFn)(uint32_t *dst, uint64_t bits, uint32_t off, uint32_t on);
+
+typedef struct {
+    uint32_t off;               // Cor mapeada do pixel apagado
+    uint32_t on;                // Cor mapeada do pixel aceso
+    int scale;                  // Pré-escala inteira (1 = sem escala)
+    Chip8ExpandFn expand;       // Expande uma linha de 64 pixels
+    uint32_t planes[4];         // Máquinas estendidas: cor de cada combinação de planos (bit p = plano p)
+    const char *backend;        // "avx2", "sse2" ou "escalar"
+} Chip8Render;
+
+extern const Chip8Palette chip8_palettes[]; // Paletas embutidas (terminadas por name == NULL)
+
+// Procura uma paleta pelo nome ou interpreta "RRGGBB:RRGGBB" (apagado:aceso)
+// Retorna 0 em caso de sucesso e -1 se a especificação for inválida
+int chip8_palette_parse(const char *spec, Chip8Palette *out);
+
+void chip8_render_init(Chip8Render *r, uint32_t off, uint32_t on, int scale); // scale é limitado a [1, CHIP8_RENDER_MAX_SCALE]
+// Cores dos pixels só do segundo plano e dos dois planos (padrão: as duas iguais a `on`)
+void chip8_render_set_planes(Chip8Render *r, uint32_t second, uint32_t both);
+
+// Converte as linhas [first, first + count) do display para dst
+// dst aponta para o pixel (0, first * scale) e pitch é o tamanho em bytes de
+// cada linha de destino (cada linha do CHIP-8 ocupa scale linhas de destino)
+void chip8_render_rows(const Chip8Render *r, const uint64_t *display, int first, int count,
+                       void *dst, int pitch);
+
+// Máquinas estendidas: converte as linhas [first, first + count) de 128x64 do
+// framebuffer planar; em lores (hires = 0), cada pixel ocupa 2x2
+void chip8_render_screen(const Chip8Render *r, const uint64_t screen[CHIP8_PLANES][CHIP8_HIRES_HEIGHT][2],
+                         int hires, int first, int count, void *dst, int pitch);
+
+#endif
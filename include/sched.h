@@ -0,0 +1,56 @@
+#ifndef SCHED_H
+#define SCHED_H
+
+#include "chip8.h"
+#include "audio.h"
+
+// Escalonador de ciclos: relógio da CPU configurável e temporizadores a 60 Hz
+//
+// O tempo emulado é contado em unidades: no modelo uniforme cada instrução
+// custa 1 unidade e clock_hz é o número de instruções por segundo emulado; com
+// os custos do COSMAC VIP a unidade é 1 µs e cada instrução custa o tempo
+// aproximado que o interpretador original levava para executá-la. O k-ésimo
+// tick dos temporizadores acontece exatamente quando o tempo emulado atinge
+// k/60 s, então há sempre 60 ticks por segundo emulado, qualquer que seja o
+// clock ou a quantidade de frames que o frontend consegue desenhar.
+//
+// Com um ring de áudio ligado, cada mudança do som é carimbada no tempo do
+// escalonador: ticks no instante exato e FX18 no fim do bloco de chip8_run,
+// que passa a ter no máximo uma amostra de áudio de duração.
+
+#define CHIP8_TIMER_HZ 60
+#define CHIP8_DEFAULT_CLOCK_HZ 600 // 10 instruções por tick, o ritmo histórico deste emulador
+#define CHIP8_VIP_CLOCK_HZ 1000000 // Com custos do VIP: unidades de 1 µs
+#define CHIP8_CLOCK_MIN_HZ 60
+#define CHIP8_CLOCK_MAX_HZ 100000000
+
+typedef struct {
+    uint32_t clock_hz;          // Unidades por segundo emulado
+    int vip_costs;              // 1 = custo de cada opcode como no COSMAC VIP (unidades em µs)
+    uint64_t units;             // Tempo emulado desde o início, em unidades
+    uint64_t target;            // Até onde chip8_sched_run deve chegar
+    uint64_t ticks;             // Ticks de 60 Hz já aplicados
+    uint64_t instructions;      // Instruções executadas (ou puladas em laços ociosos)
+    uint32_t quantum;           // Máximo de unidades por bloco de chip8_run
+    Chip8AudioRing *audio;      // Eventos do som (NULL = sem áudio)
+    uint64_t audio_base;        // Tempo do áudio = audio_base + units (contínuo após chip8_sched_seek)
+} Chip8Sched;
+
+void chip8_sched_init(Chip8Sched *s, uint32_t clock_hz, int vip_costs);
+uint64_t chip8_sched_until_tick(const Chip8Sched *s); // Unidades até o próximo tick (sempre >= 1)
+// Conta `units` unidades já executadas e aplica os ticks que ficaram para trás
+void chip8_sched_advance(Chip8Sched *s, Chip8 *c, uint64_t units);
+// Conta n instruções do modelo uniforme já executadas por fora (chip8_cycle, JIT): carimba
+// a mudança do som causada por elas e avança n unidades. Use blocos de até `quantum`
+void chip8_sched_step(Chip8Sched *s, Chip8 *c, uint64_t n);
+// Emula `units` unidades com chip8_run, aplicando cada tick no ciclo exato
+// (com custos do VIP, a última instrução pode ultrapassar o limite; o excesso é descontado depois)
+void chip8_sched_run(Chip8Sched *s, Chip8 *c, uint64_t units);
+// Posiciona o escalonador exatamente no tick N (ex.: após voltar frames com o rewind)
+void chip8_sched_seek(Chip8Sched *s, uint64_t ticks);
+// Liga o ring de áudio; os blocos passam a durar no máximo uma amostra
+void chip8_sched_attach_audio(Chip8Sched *s, Chip8AudioRing *ring, uint32_t sample_rate);
+void chip8_sched_sync_audio(const Chip8Sched *s, const Chip8 *c); // Carimba o estado atual (após load/rewind)
+uint32_t chip8_vip_cost(uint16_t opcode); // Custo aproximado do opcode no COSMAC VIP, em µs
+
+#endif
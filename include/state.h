@@ -0,0 +1,60 @@
+#ifndef STATE_H
+#define STATE_H
+
+#include <stddef.h>
+#include "chip8.h"
+
+// Save states e rewind
+//
+// O estado é serializado em uma imagem plana de chip8_state_size(modelo)
+// bytes (little-endian, sem a cache de instruções, que é reconstruída): só o
+// XO-CHIP leva os 60 KB de memória além dos 4 KB, e só as máquinas
+// estendidas levam o framebuffer planar. O arquivo
+// de save state é essa imagem precedida de um cabeçalho com assinatura,
+// versão, tamanho e checksum.
+//
+// O buffer de rewind guarda, a cada frame, o XOR da imagem com a do frame
+// anterior comprimido em RLE (a maior parte dos bytes não muda), e a cada N
+// frames um keyframe completo (também em RLE). Tudo fica em uma arena de
+// tamanho fixo alocada na criação; quando ela enche, os frames mais antigos
+// são descartados.
+
+// Ainda são lidas as versões 1 (só CHIP-8, sem o bloco das máquinas estendidas)
+// e 2 (sempre com a memória e o framebuffer das estendidas, de CHIP8_STATE_SIZE bytes)
+#define CHIP8_STATE_VERSION 3
+#define CHIP8_STATE_V1_SIZE (4096 + 16 + 2 + 2 + 16 * 2 + 1 + 1 + 1 + 16 + 4 + CHIP8_HEIGHT * 8)
+#define CHIP8_STATE_CHIP8_SIZE (CHIP8_STATE_V1_SIZE + 5 + 16 + 16) // Imagem do CHIP-8
+#define CHIP8_STATE_SIZE (CHIP8_STATE_CHIP8_SIZE + (CHIP8_MEMORY_SIZE - 4096) + \
+                          CHIP8_PLANES * CHIP8_HIRES_HEIGHT * 2 * 8) // Maior imagem (XO-CHIP)
+
+size_t chip8_state_size(Chip8Machine machine); // Bytes da imagem de uma máquina do modelo
+// Grava a imagem de c em out e retorna o tamanho (chip8_state_size do modelo)
+size_t chip8_state_pack(const Chip8 *c, uint8_t out[CHIP8_STATE_SIZE]);
+// Restaura a imagem em c (que precisa ter passado por chip8_init), trocando a
+// extensão se o modelo da imagem pede outra. Apenas as entradas da cache de
+// instruções cujos bytes mudaram são invalidadas; quem usa o JIT deve chamar
+// chip8_jit_flush depois. 0, ou um código de chip8_state_error (-2 se o modelo
+// gravado é desconhecido ou size não é o dele, -7 sem memória)
+int chip8_state_unpack(Chip8 *c, const uint8_t *in, size_t size);
+
+// Retornam 0 em sucesso ou um código negativo (ver chip8_state_error). O arquivo
+// carregado precisa ser do modelo de c (-8 se não for): quem o usa já escolheu a
+// resolução e o framebuffer da apresentação
+int chip8_save_state(const Chip8 *c, const char *path);
+int chip8_load_state(Chip8 *c, const char *path);
+const char *chip8_state_error(int code); // Mensagem legível para os códigos acima
+
+typedef struct Chip8Rewind Chip8Rewind;
+
+// arena_bytes: memória total para os frames; keyframe_interval: frames entre keyframes
+Chip8Rewind *chip8_rewind_create(size_t arena_bytes, uint32_t keyframe_interval);
+void chip8_rewind_destroy(Chip8Rewind *r);
+// Registra o estado do frame atual. Se o registro não cabe na arena, o histórico
+// recomeça neste frame; retorna -1 se nem ele coube (o frame não foi registrado)
+int chip8_rewind_push(Chip8Rewind *r, const Chip8 *c);
+int chip8_rewind_step_back(Chip8Rewind *r, Chip8 *c, uint32_t frames); // Volta N frames (0 ou -1 se não há histórico suficiente)
+uint32_t chip8_rewind_frames(const Chip8Rewind *r); // Quantos frames ainda é possível voltar
+size_t chip8_rewind_used(const Chip8Rewind *r); // Bytes da arena em uso
+void chip8_rewind_clear(Chip8Rewind *r); // Descarta o histórico (ex.: após carregar um save state)
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include "chip8.h"
+
+// Trace binário da execução do interpretador de referência (chip8_cycle)
+//
+// Como o perfilador, só existe em builds com -DCHIP8_TRACE (make TRACE=1); sem
+// a flag, chip8_cycle não muda e chip8_trace_open retorna NULL. Com um trace
+// ligado na thread (chip8_trace_attach), cada instrução grava um registro de
+// 12 bytes (PC, opcode, I, registrador alterado e ciclos desde o registro
+// anterior) em um ring de tamanho fixo. Uma thread separada esvazia o ring no
+// arquivo; a emulação nunca espera por ela: se o ring estiver cheio, o
+// registro é descartado, contado, e o próximo registro gravado é marcado.
+//
+// Arquivo: cabeçalho de 16 bytes ("C8TRACE", versão, tamanho do registro)
+// seguido dos registros, tudo little-endian. chip8_trace_read lê de volta.
+
+#define CHIP8_TRACE_VERSION 1
+#define CHIP8_TRACE_RECORD_SIZE 12   // Bytes por registro no arquivo
+#define CHIP8_TRACE_RING 1048576    // Registros no ring (12 MB, potência de 2)
+
+// Bits de Chip8TraceRecord.reg (os 4 bits baixos são o índice do registrador)
+#define CHIP8_TRACE_REG_CHANGED 0x10 // Algum V mudou: o de menor índice está em reg & 0x0F
+#define CHIP8_TRACE_REG_MULTI   0x20 // Mais de um V mudou (8XY4, FX65...)
+#define CHIP8_TRACE_TICK        0x40 // Tick antes desta instrução (só os que decrementam algum temporizador)
+#define CHIP8_TRACE_GAP         0x80 // Registros anteriores a este foram descartados
+
+typedef struct {
+    uint16_t pc;                // Endereço da instrução
+    uint16_t opcode;
+    uint16_t i;                 // I depois da instrução
+    uint8_t  reg;               // Índice | CHIP8_TRACE_* flags
+    uint8_t  value;             // Novo valor de V[reg & 0x0F] (com CHIP8_TRACE_REG_CHANGED)
+    uint32_t delta;             // Ciclos emulados desde o registro anterior (1 = instrução seguinte)
+} Chip8TraceRecord;
+
+typedef struct {
+    Chip8TraceRecord *ring;
+    _Alignas(64) atomic_size_t head;  // Escrito só pela emulação
+    size_t cached_tail;               // Última posição de tail vista pela emulação
+    uint64_t cycles;                  // Ciclos desde o último registro gravado
+    uint8_t pending;                  // Flags (TICK / GAP) do próximo registro
+    uint64_t records;                 // Registros gravados no ring
+    uint64_t dropped;                 // Registros descartados com o ring cheio
+    _Alignas(64) atomic_size_t tail;  // Escrito só pela thread de gravação
+    atomic_int stop;
+    int write_error;
+    FILE *file;
+    void *thread;                     // pthread_t da thread de gravação
+} Chip8Trace;
+
+Chip8Trace *chip8_trace_open(const char *path); // NULL sem -DCHIP8_TRACE, sem memória ou sem o arquivo
+// Para a gravação, esvazia o ring e fecha o arquivo (0, ou -1 se alguma escrita falhou)
+int chip8_trace_close(Chip8Trace *t);
+void chip8_trace_attach(Chip8Trace *t); // Trace usado por chip8_cycle nesta thread (NULL desliga)
+// Conta n ciclos emulados que não passaram por chip8_cycle (entram no delta do próximo registro)
+void chip8_trace_advance(Chip8Trace *t, uint64_t n);
+
+// Leitura (disponível em qualquer build): 0, ou -1 se o arquivo não for um trace
+int chip8_trace_read_header(FILE *in);
+int chip8_trace_read(FILE *in, Chip8TraceRecord *r); // 1 = registro lido, 0 = fim do arquivo
+// Desmontagem de um opcode ("LD V1, 0x42", "DRW V0, V1, 5"); retorna `out`
+const char *chip8_disassemble(uint16_t opcode, char *out, size_t size);
+
+#ifdef CHIP8_TRACE
+extern _Thread_local Chip8Trace *chip8_trace_active;
+// Depois da instrução em `pc`: `v_before` são os registradores antes dela
+void chip8_trace_record(Chip8Trace *t, const Chip8 *c, uint16_t pc, uint16_t opcode, const uint8_t v_before[16]);
+#endif
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef TRIPLE_H
+#define TRIPLE_H
+
+#include <stdatomic.h>
+#include "chip8.h"
+
+// Triple buffer sem locks para entregar frames da thread de emulação à de
+// renderização
+//
+// Há três cópias do display: a do escritor (back), a do leitor (front) e uma
+// intermediária. Publicar troca back e intermediária com um atomic_exchange;
+// consumir troca front e intermediária só se esta tiver um frame novo. Nenhum
+// lado espera pelo outro: o escritor sempre tem um buffer livre e o leitor
+// sempre pega o frame mais recente, descartando os intermediários.
+//
+// dirty_rows de um frame publicado cobre todas as linhas alteradas desde o
+// último frame que o leitor consumiu, mesmo que frames tenham sido descartados;
+// input_time também passa adiante, para medir a latência entrada -> tela.
+
+typedef struct {
+    uint64_t display[CHIP8_HEIGHT];
+    uint8_t  machine;           // Chip8Machine: nas estendidas, o frame está em screen
+    uint8_t  hires;
+    uint64_t screen[CHIP8_PLANES][CHIP8_HIRES_HEIGHT][2]; // Copiado só nas máquinas estendidas
+    uint32_t dirty_rows;        // Linhas alteradas desde o frame consumido anterior
+    uint32_t display_gen;
+    uint64_t frame;             // Número do frame (tick dos temporizadores) emulado
+    uint64_t input_time;        // Instante (contador do host) da entrada mais antiga refletida pela
+                                // primeira vez neste frame; 0 se nenhuma
+} Chip8Frame;
+
+typedef struct {
+    Chip8Frame buffers[3];
+    _Alignas(64) atomic_uint middle; // Índice do buffer intermediário | bit de frame novo
+    _Alignas(64) unsigned back;      // Usado só pelo escritor
+    uint32_t carry_dirty;            // Linhas de frames publicados que o leitor não viu
+    uint64_t carry_input;            // input_time de um frame que o leitor não viu
+    _Alignas(64) unsigned front;     // Usado só pelo leitor
+} Chip8TripleBuffer;
+
+void chip8_triple_init(Chip8TripleBuffer *t);
+// Escritor: copia o display, consome as linhas sujas de c e publica o frame
+void chip8_triple_publish(Chip8TripleBuffer *t, Chip8 *c, uint64_t frame, uint64_t input_time);
+// Leitor: 1 se um frame novo passou a ser o front, 0 se o front não mudou
+int chip8_triple_acquire(Chip8TripleBuffer *t);
+const Chip8Frame *chip8_triple_front(const Chip8TripleBuffer *t);
+
+#endif
@@ -0,0 +1,109 @@
+#include <string.h>
+#include "audio.h"
+
+#define RING_MASK (CHIP8_AUDIO_RING_SIZE - 1u)
+
+void chip8_audio_init(Chip8AudioRing* r) {
+  memset(r->events, 0, sizeof(r->events));
+  atomic_init(&r->head, 0u);
+  atomic_init(&r->tail, 0u);
+  atomic_init(&r->now, 0u);
+  r->last_time = 0;
+  r->on = 0;
+  r->dropped = 0;
+}
+
+void chip8_audio_update(Chip8AudioRing* r, uint64_t time, int on) {
+  if (time < r->last_time) {
+    time = r->last_time;
+  }
+  r->last_time = time;
+
+  if ((uint8_t)(on != 0) != r->on) {
+    unsigned head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    if (head - atomic_load_explicit(&r->tail, memory_order_acquire) < CHIP8_AUDIO_RING_SIZE) {
+      r->events[head & RING_MASK].time = time;
+      r->events[head & RING_MASK].on = (uint8_t)(on != 0);
+      atomic_store_explicit(&r->head, head + 1, memory_order_release);
+      r->on = (uint8_t)(on != 0);
+    } else {
+      // Ring cheio: o estado não muda aqui, então a próxima chamada tenta de novo
+      r->dropped++;
+    }
+  }
+  // Publicado depois do evento: quem lê `now` vê todos os eventos até ele
+  atomic_store_explicit(&r->now, time, memory_order_release);
+}
+
+void chip8_beeper_init(Chip8Beeper* b, uint32_t sample_rate, uint32_t clock_hz) {
+  b->sample_rate = sample_rate;
+  b->clock_hz = clock_hz;
+  b->pos = 0;
+  b->phase = 0;
+  b->phase_step = (uint32_t)(((uint64_t)CHIP8_BEEP_HZ << 32) / sample_rate);
+  b->on = 0;
+  b->max_lag = sample_rate / 20;    // 50 ms
+  b->resync_lag = sample_rate / 200; // 5 ms
+}
+
+static inline uint64_t to_sample(const Chip8Beeper* b, uint64_t time) {
+  return time * b->sample_rate / b->clock_hz;
+}
+
+uint64_t chip8_beeper_pending(const Chip8Beeper* b, Chip8AudioRing* r) {
+  uint64_t now = to_sample(b, atomic_load_explicit(&r->now, memory_order_acquire));
+  return now > b->pos ? now - b->pos : 0;
+}
+
+// Gera n amostras; com advance = 0 o tempo emulado não anda (nenhum evento é aplicado)
+static void render(Chip8Beeper* b, Chip8AudioRing* r, int16_t* out, uint32_t n, int advance) {
+  unsigned tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+  unsigned head = atomic_load_explicit(&r->head, memory_order_acquire);
+  uint64_t next = tail != head ? to_sample(b, r->events[tail & RING_MASK].time) : UINT64_MAX;
+
+  for (uint32_t i = 0; i < n; i++) {
+    if (advance) {
+      while (next <= b->pos) {
+        uint8_t on = r->events[tail & RING_MASK].on;
+        if (on && !b->on) {
+          b->phase = 0; // Todo bipe começa na mesma fase
+        }
+        b->on = on;
+        tail++;
+        next = tail != head ? to_sample(b, r->events[tail & RING_MASK].time) : UINT64_MAX;
+      }
+      b->pos++;
+    }
+    if (b->on) {
+      out[i] = (b->phase & 0x80000000u) ? -CHIP8_BEEP_AMPLITUDE : CHIP8_BEEP_AMPLITUDE;
+      b->phase += b->phase_step;
+    } else {
+      out[i] = 0;
+    }
+  }
+  atomic_store_explicit(&r->tail, tail, memory_order_release);
+}
+
+void chip8_beeper_render(Chip8Beeper* b, Chip8AudioRing* r, int16_t* out, uint32_t n) {
+  render(b, r, out, n, 1);
+}
+
+void chip8_beeper_stream(Chip8Beeper* b, Chip8AudioRing* r, int16_t* out, uint32_t n) {
+  uint64_t pending = chip8_beeper_pending(b, r);
+  if (pending > b->max_lag) {
+    // Muito atrás da emulação (início, catch-up, dispositivo atrasado): aplica os
+    // eventos até perto do presente em vez de acumular latência
+    unsigned tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&r->head, memory_order_acquire);
+    b->pos += pending - b->resync_lag;
+    while (tail != head && to_sample(b, r->events[tail & RING_MASK].time) <= b->pos) {
+      b->on = r->events[tail & RING_MASK].on;
+      tail++;
+    }
+    atomic_store_explicit(&r->tail, tail, memory_order_release);
+    pending = b->resync_lag;
+  }
+  uint32_t ready = pending < n ? (uint32_t)pending : n;
+  render(b, r, out, ready, 1);
+  render(b, r, out + ready, n - ready, 0);
+}
@@ -0,0 +1,768 @@
+#define _POSIX_C_SOURCE 200809L // pthread / sysconf
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "batch.h"
+
+#define LANES CHIP8_BATCH_LANES
+#define ALL_LANES (~0ULL)
+#define MAX_GROUP_SCANS 4 // Varreduras de PC por ciclo antes de executar as lanes restantes uma a uma
+#define MIN_LOCKSTEP_LANES 4 // Média mínima de lanes por despacho para continuar em lockstep
+
+typedef struct { // Um fragmento de LANES instâncias em layout SoA
+    uint8_t  V[16][LANES];
+    uint16_t pc[LANES];
+    uint16_t I[LANES];
+    uint16_t stack[16][LANES];
+    uint8_t  sp[LANES];
+    uint8_t  delay_timer[LANES];
+    uint8_t  sound_timer[LANES];
+    uint16_t keys[LANES];               // bit k = tecla k pressionada
+    uint64_t display[CHIP8_HEIGHT][LANES];
+    uint8_t *mem[LANES];                // cópia privada da memória (NULL = imagem compartilhada)
+    uint64_t written;                   // bit b = algum byte do bloco [64b, 64b+63] foi escrito por alguma lane
+    uint64_t active;                    // lanes com instância (o último fragmento pode estar incompleto)
+    uint32_t base;                      // índice da instância na lane 0
+    int oom;                            // falhou ao alocar memória privada
+    int diverged;                       // lanes executadas uma a uma, um frame inteiro por vez
+    uint64_t lane_steps;
+    uint64_t group_steps;
+} Shard;
+
+struct Chip8Batch {
+    uint8_t image[4096];                // memória inicial compartilhada
+    uint8_t quirks;                     // CHIP8_QUIRK_* da instância modelo (as mesmas em todas as lanes)
+    Chip8Decoded decoded[4096];         // pré-decodificação da imagem (vale enquanto o bloco não foi escrito)
+    uint32_t count;
+    uint32_t nshards;
+    Shard *shards;
+    uint64_t frame;                     // frames já executados
+
+    // Pool de threads
+    int nthreads;                       // inclui a thread que chama chip8_batch_run_frames
+    pthread_t *workers;
+    pthread_mutex_t lock;
+    pthread_cond_t start_cv;
+    pthread_cond_t done_cv;
+    uint64_t job;                       // incrementado a cada chamada
+    int busy;                           // workers ainda executando o trabalho atual
+    int stop;
+    atomic_uint next_shard;
+
+    // Trabalho atual
+    uint32_t job_frames;
+    uint32_t job_cycles;
+    Chip8BatchInputFn job_input;
+    void *job_user;
+};
+
+// Inline garantido: lane_run é instanciado uma vez por combinação de quirks
+#if defined(__GNUC__)
+#define LANE_INLINE static inline __attribute__((always_inline))
+#else
+#define LANE_INLINE static inline
+#endif
+
+static inline int ctz64(uint64_t v) {
+#if defined(__GNUC__)
+  return __builtin_ctzll(v);
+#else
+  int n = 0;
+  while (!(v & 1)) {
+    v >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+static inline int popcount64(uint64_t v) {
+#if defined(__GNUC__)
+  return __builtin_popcountll(v);
+#else
+  int n = 0;
+  for (; v; v &= v - 1) n++;
+  return n;
+#endif
+}
+
+// Executa o corpo para cada lane da máscara. Com todas as lanes ativas o laço
+// é contínuo (vetorizável); caso contrário percorre apenas os bits setados
+#define LANE_LOOP(mask, ...) do { \
+    if ((mask) == ALL_LANES) { \
+      for (int l = 0; l < LANES; l++) { __VA_ARGS__ } \
+    } else { \
+      for (uint64_t m_ = (mask); m_; m_ &= m_ - 1) { int l = ctz64(m_); __VA_ARGS__ } \
+    } \
+  } while (0)
+
+static inline const uint8_t *lane_mem(const Chip8Batch *b, const Shard *s, int l) {
+  return s->mem[l] ? s->mem[l] : b->image;
+}
+
+// Memória gravável da lane: cria a cópia privada na primeira escrita
+static inline uint8_t *lane_mem_w(const Chip8Batch *b, Shard *s, int l) {
+  if (!s->mem[l]) {
+    s->mem[l] = malloc(4096);
+    if (!s->mem[l]) {
+      s->oom = 1;
+      return NULL;
+    }
+    memcpy(s->mem[l], b->image, 4096);
+  }
+  return s->mem[l];
+}
+
+static inline uint64_t chunk_bits(uint16_t pc) {
+  return (1ULL << ((pc & 0x0FFF) >> 6)) | (1ULL << (((pc + 1) & 0x0FFF) >> 6));
+}
+
+static inline uint16_t lane_opcode(const Chip8Batch *b, const Shard *s, int l, uint16_t pc) {
+  const uint8_t *mem = lane_mem(b, s, l);
+  return (uint16_t)((mem[pc & 0x0FFF] << 8) | mem[(pc + 1) & 0x0FFF]);
+}
+
+// Executa uma instrução para o grupo de lanes (todas com PC = pc)
+static void exec_group(const Chip8Batch *b, Shard *s, const Chip8Decoded *d, uint16_t pc, uint64_t mask) {
+  const uint16_t next = (uint16_t)(pc + 2);
+  const uint8_t x = d->x, y = d->y, kk = d->kk;
+  const uint16_t nnn = d->nnn;
+  uint8_t *vx = s->V[x];
+  uint8_t *vy = s->V[y];
+  uint8_t *vf = s->V[0xF];
+  const uint8_t quirks = b->quirks; // Testadas uma vez por grupo, fora dos laços sobre as lanes
+
+  switch ((Chip8Op)d->op) {
+    case CHIP8_OP_00E0:
+      LANE_LOOP(mask, s->pc[l] = next;
+        for (int r = 0; r < CHIP8_HEIGHT; r++) s->display[r][l] = 0;);
+      break;
+    case CHIP8_OP_00EE:
+      LANE_LOOP(mask, s->pc[l] = next;
+        if (s->sp[l] > 0) {
+          s->sp[l]--;
+          s->pc[l] = s->stack[s->sp[l]][l];
+        });
+      break;
+    case CHIP8_OP_1NNN:
+      LANE_LOOP(mask, s->pc[l] = nnn;);
+      break;
+    case CHIP8_OP_2NNN:
+      LANE_LOOP(mask, s->pc[l] = next;
+        if (s->sp[l] < 16) {
+          s->stack[s->sp[l]][l] = next;
+          s->sp[l]++;
+          s->pc[l] = nnn;
+        });
+      break;
+    case CHIP8_OP_3XKK: LANE_LOOP(mask, s->pc[l] = (uint16_t)(next + ((vx[l] == kk) << 1));); break;
+    case CHIP8_OP_4XKK: LANE_LOOP(mask, s->pc[l] = (uint16_t)(next + ((vx[l] != kk) << 1));); break;
+    case CHIP8_OP_5XY0: LANE_LOOP(mask, s->pc[l] = (uint16_t)(next + ((vx[l] == vy[l]) << 1));); break;
+    case CHIP8_OP_9XY0: LANE_LOOP(mask, s->pc[l] = (uint16_t)(next + ((vx[l] != vy[l]) << 1));); break;
+    case CHIP8_OP_EX9E: LANE_LOOP(mask, s->pc[l] = (uint16_t)(next + (((s->keys[l] >> (vx[l] & 0x0F)) & 1) << 1));); break;
+    case CHIP8_OP_EXA1: LANE_LOOP(mask, s->pc[l] = (uint16_t)(next + ((~(s->keys[l] >> (vx[l] & 0x0F)) & 1) << 1));); break;
+    case CHIP8_OP_BNNN: {
+      const uint8_t *base = s->V[(quirks & CHIP8_QUIRK_JUMP_VX) ? x : 0];
+      LANE_LOOP(mask, s->pc[l] = (uint16_t)(base[l] + nnn););
+      break;
+    }
+    default:
+      // Demais instruções não mexem no PC além do avanço normal
+      LANE_LOOP(mask, s->pc[l] = next;);
+      break;
+  }
+
+  // Mesma ordem de leitura/escrita de chip8_run (importa quando x, y ou ambos são F)
+  switch ((Chip8Op)d->op) {
+    case CHIP8_OP_6XKK: LANE_LOOP(mask, vx[l] = kk;); break;
+    case CHIP8_OP_7XKK: LANE_LOOP(mask, vx[l] = (uint8_t)(vx[l] + kk);); break;
+    case CHIP8_OP_8XY0: LANE_LOOP(mask, vx[l] = vy[l];); break;
+    case CHIP8_OP_8XY1: LANE_LOOP(mask, vx[l] |= vy[l];); break;
+    case CHIP8_OP_8XY2: LANE_LOOP(mask, vx[l] &= vy[l];); break;
+    case CHIP8_OP_8XY3: LANE_LOOP(mask, vx[l] ^= vy[l];); break;
+    case CHIP8_OP_8XY4:
+      LANE_LOOP(mask, uint16_t sum = (uint16_t)(vx[l] + vy[l]);
+        vf[l] = (uint8_t)(sum >> 8);
+        vx[l] = (uint8_t)sum;);
+      break;
+    case CHIP8_OP_8XY5:
+      LANE_LOOP(mask, vf[l] = vx[l] >= vy[l];
+        vx[l] = (uint8_t)(vx[l] - vy[l]););
+      break;
+    case CHIP8_OP_8XY6: {
+      const uint8_t *src = (quirks & CHIP8_QUIRK_SHIFT_VY) ? vy : vx;
+      LANE_LOOP(mask, uint8_t value = src[l];
+        vf[l] = value & 0x01;
+        vx[l] = value >> 1;);
+      break;
+    }
+    case CHIP8_OP_8XY7:
+      LANE_LOOP(mask, vf[l] = vy[l] >= vx[l];
+        vx[l] = (uint8_t)(vy[l] - vx[l]););
+      break;
+    case CHIP8_OP_8XYE: {
+      const uint8_t *src = (quirks & CHIP8_QUIRK_SHIFT_VY) ? vy : vx;
+      LANE_LOOP(mask, uint8_t value = src[l];
+        vf[l] = (value & 0x80) >> 7;
+        vx[l] = (uint8_t)(value << 1););
+      break;
+    }
+    case CHIP8_OP_ANNN: LANE_LOOP(mask, s->I[l] = nnn;); break;
+    case CHIP8_OP_FX07: LANE_LOOP(mask, vx[l] = s->delay_timer[l];); break;
+    case CHIP8_OP_FX15: LANE_LOOP(mask, s->delay_timer[l] = vx[l];); break;
+    case CHIP8_OP_FX18: LANE_LOOP(mask, s->sound_timer[l] = vx[l];); break;
+    case CHIP8_OP_FX1E: LANE_LOOP(mask, s->I[l] = (uint16_t)(s->I[l] + vx[l]);); break;
+    case CHIP8_OP_FX29: LANE_LOOP(mask, s->I[l] = (uint16_t)(0x050 + (vx[l] & 0x0F) * 5);); break;
+    case CHIP8_OP_FX0A:
+      LANE_LOOP(mask,
+        if (s->keys[l]) {
+          vx[l] = (uint8_t)ctz64(s->keys[l]);
+        } else {
+          s->pc[l] = pc; // Sem tecla: repete a instrução
+        });
+      break;
+    case CHIP8_OP_DXYN: {
+      const int n = d->opcode & 0x000F;
+      const int clip = (quirks & CHIP8_QUIRK_CLIP) != 0;
+      LANE_LOOP(mask,
+        const uint8_t *mem = lane_mem(b, s, l);
+        uint8_t px = vx[l] % 64;
+        uint8_t py0 = vy[l] % 32;
+        uint16_t i = s->I[l];
+        uint64_t collision = 0;
+        int rows = clip && py0 + n > 32 ? 32 - py0 : n;
+        for (int row = 0; row < rows; row++) {
+          uint8_t py = (py0 + row) % 32;
+          uint64_t bits = (uint64_t)mem[(i + row) & 0x0FFF] << 56;
+          bits = clip ? bits >> px : (bits >> px) | (bits << ((64 - px) & 63));
+          collision |= s->display[py][l] & bits;
+          s->display[py][l] ^= bits;
+        }
+        vf[l] = collision ? 1 : 0;);
+      break;
+    }
+    case CHIP8_OP_FX33:
+      LANE_LOOP(mask,
+        uint8_t *mem = lane_mem_w(b, s, l);
+        if (mem) {
+          uint16_t i = s->I[l];
+          uint8_t value = vx[l];
+          mem[i & 0x0FFF] = value / 100;
+          mem[(i + 1) & 0x0FFF] = (value / 10) % 10;
+          mem[(i + 2) & 0x0FFF] = value % 10;
+          s->written |= chunk_bits(i) | chunk_bits((uint16_t)(i + 1));
+        });
+      break;
+    case CHIP8_OP_FX55:
+      LANE_LOOP(mask,
+        uint8_t *mem = lane_mem_w(b, s, l);
+        if (mem) {
+          uint16_t i = s->I[l];
+          for (int r = 0; r <= x; r++) {
+            mem[(i + r) & 0x0FFF] = s->V[r][l];
+            s->written |= 1ULL << (((i + r) & 0x0FFF) >> 6);
+          }
+        });
+      if (quirks & CHIP8_QUIRK_LOAD_STORE_I) {
+        LANE_LOOP(mask, s->I[l] = (uint16_t)(s->I[l] + x + 1););
+      }
+      break;
+    case CHIP8_OP_FX65:
+      LANE_LOOP(mask,
+        const uint8_t *mem = lane_mem(b, s, l);
+        uint16_t i = s->I[l];
+        for (int r = 0; r <= x; r++) {
+          s->V[r][l] = mem[(i + r) & 0x0FFF];
+        });
+      if (quirks & CHIP8_QUIRK_LOAD_STORE_I) {
+        LANE_LOOP(mask, s->I[l] = (uint16_t)(s->I[l] + x + 1););
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+// Instrução no PC da lane. Se o bloco nunca foi escrito, vale a pré-decodificação compartilhada
+static inline Chip8Decoded fetch(const Chip8Batch *b, const Shard *s, int l, uint16_t pc) {
+  if (pc < 4096 - 1 && !(s->written & chunk_bits(pc))) {
+    return b->decoded[pc];
+  }
+  return chip8_decode(lane_opcode(b, s, l, pc));
+}
+
+// Um ciclo para todas as lanes ativas do fragmento
+static void shard_step(const Chip8Batch *b, Shard *s) {
+  uint64_t pending = s->active;
+  int scans = 0;
+
+  while (pending) {
+    int lead = ctz64(pending);
+    uint16_t pc = s->pc[lead];
+    uint64_t mask;
+
+    if (scans < MAX_GROUP_SCANS) {
+      // Todas as lanes pendentes com o mesmo PC formam o grupo
+      mask = 0;
+      for (int l = 0; l < LANES; l++) {
+        mask |= (uint64_t)(s->pc[l] == pc) << l;
+      }
+      mask &= pending;
+      scans++;
+    } else {
+      // Muitas divergências neste ciclo: não vale varrer de novo
+      mask = 1ULL << lead;
+    }
+
+    Chip8Decoded d = fetch(b, s, lead, pc);
+    if (pc >= 4096 - 1 || (s->written & chunk_bits(pc))) {
+      if (mask & (mask - 1)) {
+        // Memória possivelmente diferente entre lanes: mantém só as de mesmo opcode
+        uint64_t same = 0;
+        for (uint64_t m = mask; m; m &= m - 1) {
+          int l = ctz64(m);
+          if (lane_opcode(b, s, l, pc) == d.opcode) {
+            same |= 1ULL << l;
+          }
+        }
+        mask = same;
+      }
+    }
+
+    pending &= ~mask;
+    exec_group(b, s, &d, pc, mask);
+    s->lane_steps += (uint64_t)popcount64(mask);
+    s->group_steps++;
+  }
+}
+
+// Caminho escalar para lanes divergentes: uma lane por vez, registradores em variáveis locais
+// Com `quirks` constante (ver LANE_CORE), os testes de quirk somem do laço
+LANE_INLINE void lane_run(const Chip8Batch *b, Shard *s, int l, uint32_t cycles, const uint8_t quirks) {
+  uint8_t v[16];
+  for (int r = 0; r < 16; r++) v[r] = s->V[r][l];
+  uint16_t pc = s->pc[l];
+  uint16_t I = s->I[l];
+  uint8_t sp = s->sp[l];
+  const uint16_t keys = s->keys[l];
+
+  for (; cycles > 0; cycles--) {
+    Chip8Decoded d = fetch(b, s, l, pc);
+    const uint8_t x = d.x, y = d.y;
+    pc = (uint16_t)(pc + 2);
+
+    switch ((Chip8Op)d.op) {
+      case CHIP8_OP_00E0:
+        for (int r = 0; r < CHIP8_HEIGHT; r++) s->display[r][l] = 0;
+        break;
+      case CHIP8_OP_00EE:
+        if (sp > 0) {
+          sp--;
+          pc = s->stack[sp][l];
+        }
+        break;
+      case CHIP8_OP_1NNN: pc = d.nnn; break;
+      case CHIP8_OP_2NNN:
+        if (sp < 16) {
+          s->stack[sp][l] = pc;
+          sp++;
+          pc = d.nnn;
+        }
+        break;
+      case CHIP8_OP_3XKK: if (v[x] == d.kk) pc += 2; break;
+      case CHIP8_OP_4XKK: if (v[x] != d.kk) pc += 2; break;
+      case CHIP8_OP_5XY0: if (v[x] == v[y]) pc += 2; break;
+      case CHIP8_OP_6XKK: v[x] = d.kk; break;
+      case CHIP8_OP_7XKK: v[x] = (uint8_t)(v[x] + d.kk); break;
+      case CHIP8_OP_8XY0: v[x] = v[y]; break;
+      case CHIP8_OP_8XY1: v[x] |= v[y]; break;
+      case CHIP8_OP_8XY2: v[x] &= v[y]; break;
+      case CHIP8_OP_8XY3: v[x] ^= v[y]; break;
+      case CHIP8_OP_8XY4: {
+        uint16_t sum = (uint16_t)(v[x] + v[y]);
+        v[0xF] = (uint8_t)(sum >> 8);
+        v[x] = (uint8_t)sum;
+        break;
+      }
+      case CHIP8_OP_8XY5: v[0xF] = v[x] >= v[y]; v[x] = (uint8_t)(v[x] - v[y]); break;
+      case CHIP8_OP_8XY6: {
+        uint8_t value = v[(quirks & CHIP8_QUIRK_SHIFT_VY) ? y : x];
+        v[0xF] = value & 0x01;
+        v[x] = value >> 1;
+        break;
+      }
+      case CHIP8_OP_8XY7: v[0xF] = v[y] >= v[x]; v[x] = (uint8_t)(v[y] - v[x]); break;
+      case CHIP8_OP_8XYE: {
+        uint8_t value = v[(quirks & CHIP8_QUIRK_SHIFT_VY) ? y : x];
+        v[0xF] = (value & 0x80) >> 7;
+        v[x] = (uint8_t)(value << 1);
+        break;
+      }
+      case CHIP8_OP_9XY0: if (v[x] != v[y]) pc += 2; break;
+      case CHIP8_OP_ANNN: I = d.nnn; break;
+      case CHIP8_OP_BNNN: pc = (uint16_t)(v[(quirks & CHIP8_QUIRK_JUMP_VX) ? x : 0] + d.nnn); break;
+      case CHIP8_OP_DXYN: {
+        const uint8_t *mem = lane_mem(b, s, l);
+        const int n = d.opcode & 0x000F;
+        uint8_t px = v[x] % 64;
+        uint8_t py0 = v[y] % 32;
+        uint64_t collision = 0;
+        int rows = (quirks & CHIP8_QUIRK_CLIP) && py0 + n > 32 ? 32 - py0 : n;
+        for (int row = 0; row < rows; row++) {
+          uint8_t py = (py0 + row) % 32;
+          uint64_t bits = (uint64_t)mem[(I + row) & 0x0FFF] << 56;
+          bits = (quirks & CHIP8_QUIRK_CLIP) ? bits >> px : (bits >> px) | (bits << ((64 - px) & 63));
+          collision |= s->display[py][l] & bits;
+          s->display[py][l] ^= bits;
+        }
+        v[0xF] = collision ? 1 : 0;
+        break;
+      }
+      case CHIP8_OP_EX9E: if ((keys >> (v[x] & 0x0F)) & 1) pc += 2; break;
+      case CHIP8_OP_EXA1: if (!((keys >> (v[x] & 0x0F)) & 1)) pc += 2; break;
+      case CHIP8_OP_FX07: v[x] = s->delay_timer[l]; break;
+      case CHIP8_OP_FX0A:
+        if (keys) {
+          v[x] = (uint8_t)ctz64(keys);
+        } else {
+          pc = (uint16_t)(pc - 2);
+        }
+        break;
+      case CHIP8_OP_FX15: s->delay_timer[l] = v[x]; break;
+      case CHIP8_OP_FX18: s->sound_timer[l] = v[x]; break;
+      case CHIP8_OP_FX1E: I = (uint16_t)(I + v[x]); break;
+      case CHIP8_OP_FX29: I = (uint16_t)(0x050 + (v[x] & 0x0F) * 5); break;
+      case CHIP8_OP_FX33: {
+        uint8_t *mem = lane_mem_w(b, s, l);
+        if (mem) {
+          mem[I & 0x0FFF] = v[x] / 100;
+          mem[(I + 1) & 0x0FFF] = (v[x] / 10) % 10;
+          mem[(I + 2) & 0x0FFF] = v[x] % 10;
+          s->written |= chunk_bits(I) | chunk_bits((uint16_t)(I + 1));
+        }
+        break;
+      }
+      case CHIP8_OP_FX55: {
+        uint8_t *mem = lane_mem_w(b, s, l);
+        if (mem) {
+          for (int r = 0; r <= x; r++) {
+            mem[(I + r) & 0x0FFF] = v[r];
+            s->written |= 1ULL << (((I + r) & 0x0FFF) >> 6);
+          }
+        }
+        if (quirks & CHIP8_QUIRK_LOAD_STORE_I) I = (uint16_t)(I + x + 1);
+        break;
+      }
+      case CHIP8_OP_FX65: {
+        const uint8_t *mem = lane_mem(b, s, l);
+        for (int r = 0; r <= x; r++) v[r] = mem[(I + r) & 0x0FFF];
+        if (quirks & CHIP8_QUIRK_LOAD_STORE_I) I = (uint16_t)(I + x + 1);
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  for (int r = 0; r < 16; r++) s->V[r][l] = v[r];
+  s->pc[l] = pc;
+  s->I[l] = I;
+  s->sp[l] = sp;
+}
+
+// Um lane_run por combinação de quirks, escolhido uma vez por fragmento e frame
+#define LANE_CORE(q) \
+  static void lane_run_q##q(const Chip8Batch *b, Shard *s, int l, uint32_t cycles) { lane_run(b, s, l, cycles, q); }
+LANE_CORE(0) LANE_CORE(1) LANE_CORE(2) LANE_CORE(3) LANE_CORE(4) LANE_CORE(5) LANE_CORE(6) LANE_CORE(7)
+LANE_CORE(8) LANE_CORE(9) LANE_CORE(10) LANE_CORE(11) LANE_CORE(12) LANE_CORE(13) LANE_CORE(14) LANE_CORE(15)
+
+static void (* const lane_cores[CHIP8_QUIRK_COUNT])(const Chip8Batch *b, Shard *s, int l, uint32_t cycles) = {
+  lane_run_q0, lane_run_q1, lane_run_q2, lane_run_q3, lane_run_q4, lane_run_q5, lane_run_q6, lane_run_q7,
+  lane_run_q8, lane_run_q9, lane_run_q10, lane_run_q11, lane_run_q12, lane_run_q13, lane_run_q14, lane_run_q15,
+};
+
+// As lanes voltaram a andar juntas? (os maiores grupos de PC cobrem 3/4 das lanes)
+static int converged(const Shard *s) {
+  uint64_t pending = s->active;
+  int total = popcount64(s->active);
+  for (int scan = 0; scan < MAX_GROUP_SCANS && pending; scan++) {
+    uint16_t pc = s->pc[ctz64(pending)];
+    for (int l = 0; l < LANES; l++) {
+      if (s->pc[l] == pc) pending &= ~(1ULL << l);
+    }
+  }
+  return popcount64(pending) * 4 <= total;
+}
+
+static void shard_run(Chip8Batch *b, Shard *s) {
+  for (uint32_t f = 0; f < b->job_frames; f++) {
+    if (b->job_input) {
+      uint64_t frame = b->frame + f;
+      for (uint64_t m = s->active; m; m &= m - 1) {
+        int l = ctz64(m);
+        s->keys[l] = b->job_input(s->base + (uint32_t)l, frame, b->job_user);
+      }
+    }
+    if (!s->diverged) {
+      uint64_t lane_steps = s->lane_steps, group_steps = s->group_steps;
+      for (uint32_t c = 0; c < b->job_cycles; c++) {
+        shard_step(b, s);
+      }
+      // Poucas lanes por despacho: o agrupamento custa mais do que economiza
+      lane_steps = s->lane_steps - lane_steps;
+      group_steps = s->group_steps - group_steps;
+      s->diverged = lane_steps < group_steps * MIN_LOCKSTEP_LANES;
+    } else {
+      // Lanes divergentes: cada uma executa o frame inteiro de uma vez
+      void (*run)(const Chip8Batch *, Shard *, int, uint32_t) = lane_cores[b->quirks & (CHIP8_QUIRK_COUNT - 1)];
+      for (uint64_t m = s->active; m; m &= m - 1) {
+        run(b, s, ctz64(m), b->job_cycles);
+      }
+      s->lane_steps += (uint64_t)popcount64(s->active) * b->job_cycles;
+      s->group_steps += (uint64_t)popcount64(s->active) * b->job_cycles;
+      s->diverged = !converged(s);
+    }
+    // Temporizadores (60 Hz = uma vez por frame)
+    for (int l = 0; l < LANES; l++) {
+      s->delay_timer[l] -= s->delay_timer[l] > 0;
+      s->sound_timer[l] -= s->sound_timer[l] > 0;
+    }
+  }
+}
+
+// Pega fragmentos até acabar (distribuição dinâmica entre as threads)
+static void run_shards(Chip8Batch *b) {
+  for (;;) {
+    unsigned idx = atomic_fetch_add(&b->next_shard, 1);
+    if (idx >= b->nshards) {
+      return;
+    }
+    shard_run(b, &b->shards[idx]);
+  }
+}
+
+static void *worker_main(void *arg) {
+  Chip8Batch *b = arg;
+  uint64_t seen = 0;
+
+  pthread_mutex_lock(&b->lock);
+  for (;;) {
+    while (!b->stop && b->job == seen) {
+      pthread_cond_wait(&b->start_cv, &b->lock);
+    }
+    if (b->stop) {
+      break;
+    }
+    seen = b->job;
+    pthread_mutex_unlock(&b->lock);
+
+    run_shards(b);
+
+    pthread_mutex_lock(&b->lock);
+    if (--b->busy == 0) {
+      pthread_cond_signal(&b->done_cv);
+    }
+  }
+  pthread_mutex_unlock(&b->lock);
+  return NULL;
+}
+
+Chip8Batch *chip8_batch_create(const Chip8 *proto, uint32_t count, int threads) {
+  if (count == 0 || proto->machine != CHIP8_MACHINE_CHIP8) {
+    return NULL;
+  }
+
+  Chip8Batch *b = calloc(1, sizeof(*b));
+  if (!b) {
+    return NULL;
+  }
+  b->count = count;
+  b->nshards = (count + LANES - 1) / LANES;
+
+  // Fragmentos alinhados a linha de cache (sem compartilhamento falso entre threads)
+  size_t shards_size = ((sizeof(Shard) * b->nshards) + 63) & ~(size_t)63;
+  b->shards = aligned_alloc(64, shards_size);
+  if (!b->shards) {
+    free(b);
+    return NULL;
+  }
+  memset(b->shards, 0, shards_size);
+
+  memcpy(b->image, proto->memory, sizeof(b->image));
+  b->quirks = proto->quirks;
+  for (int a = 0; a < 4096 - 1; a++) {
+    b->decoded[a] = chip8_decode((uint16_t)((b->image[a] << 8) | b->image[a + 1]));
+  }
+
+  for (uint32_t si = 0; si < b->nshards; si++) {
+    Shard *s = &b->shards[si];
+    uint32_t lanes = count - si * LANES;
+    s->base = si * LANES;
+    s->active = lanes >= LANES ? ALL_LANES : (1ULL << lanes) - 1;
+    for (int l = 0; l < LANES; l++) {
+      for (int r = 0; r < 16; r++) {
+        s->V[r][l] = proto->V[r];
+        s->stack[r][l] = proto->stack[r];
+      }
+      s->pc[l] = proto->pc;
+      s->I[l] = proto->I;
+      s->sp[l] = proto->sp;
+      s->delay_timer[l] = proto->delay_timer;
+      s->sound_timer[l] = proto->sound_timer;
+      for (int r = 0; r < CHIP8_HEIGHT; r++) {
+        s->display[r][l] = proto->display[r];
+      }
+      s->keys[l] = chip8_get_keys(proto);
+    }
+  }
+
+  if (threads <= 0) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = online > 0 ? (int)online : 1;
+  }
+  if ((uint32_t)threads > b->nshards) {
+    threads = (int)b->nshards; // Mais threads que fragmentos não ajuda
+  }
+  b->nthreads = threads;
+
+  pthread_mutex_init(&b->lock, NULL);
+  pthread_cond_init(&b->start_cv, NULL);
+  pthread_cond_init(&b->done_cv, NULL);
+  if (threads > 1) {
+    b->workers = calloc((size_t)threads - 1, sizeof(pthread_t));
+    if (!b->workers) {
+      chip8_batch_destroy(b);
+      return NULL;
+    }
+    for (int t = 0; t < threads - 1; t++) {
+      if (pthread_create(&b->workers[t], NULL, worker_main, b) != 0) {
+        b->nthreads = t + 1; // Segue com as threads que conseguiu criar
+        break;
+      }
+    }
+  }
+
+  return b;
+}
+
+void chip8_batch_destroy(Chip8Batch *b) {
+  if (!b) {
+    return;
+  }
+  if (b->workers) {
+    pthread_mutex_lock(&b->lock);
+    b->stop = 1;
+    pthread_cond_broadcast(&b->start_cv);
+    pthread_mutex_unlock(&b->lock);
+    for (int t = 0; t < b->nthreads - 1; t++) {
+      pthread_join(b->workers[t], NULL);
+    }
+    free(b->workers);
+  }
+  pthread_cond_destroy(&b->done_cv);
+  pthread_cond_destroy(&b->start_cv);
+  pthread_mutex_destroy(&b->lock);
+  for (uint32_t si = 0; si < b->nshards; si++) {
+    for (int l = 0; l < LANES; l++) {
+      free(b->shards[si].mem[l]);
+    }
+  }
+  free(b->shards);
+  free(b);
+}
+
+uint32_t chip8_batch_count(const Chip8Batch *b) {
+  return b->count;
+}
+
+int chip8_batch_threads(const Chip8Batch *b) {
+  return b->nthreads;
+}
+
+int chip8_batch_run_frames(Chip8Batch *b, uint32_t frames, uint32_t cycles_per_frame,
+                           Chip8BatchInputFn input, void *user) {
+  if (frames == 0) {
+    return 0;
+  }
+
+  b->job_frames = frames;
+  b->job_cycles = cycles_per_frame;
+  b->job_input = input;
+  b->job_user = user;
+  atomic_store(&b->next_shard, 0);
+
+  if (b->nthreads > 1) {
+    pthread_mutex_lock(&b->lock);
+    b->busy = b->nthreads - 1;
+    b->job++;
+    pthread_cond_broadcast(&b->start_cv);
+    pthread_mutex_unlock(&b->lock);
+  }
+
+  run_shards(b); // A thread chamadora também trabalha
+
+  if (b->nthreads > 1) {
+    pthread_mutex_lock(&b->lock);
+    while (b->busy > 0) {
+      pthread_cond_wait(&b->done_cv, &b->lock);
+    }
+    pthread_mutex_unlock(&b->lock);
+  }
+
+  b->frame += frames;
+  for (uint32_t si = 0; si < b->nshards; si++) {
+    if (b->shards[si].oom) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+void chip8_batch_set_keys(Chip8Batch *b, uint32_t instance, uint16_t keys) {
+  b->shards[instance / LANES].keys[instance % LANES] = keys;
+}
+
+uint64_t chip8_batch_display_hash(const Chip8Batch *b, uint32_t instance) {
+  const Shard *s = &b->shards[instance / LANES];
+  int l = (int)(instance % LANES);
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (int y = 0; y < CHIP8_HEIGHT; y++) {
+    hash ^= s->display[y][l];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+void chip8_batch_export(const Chip8Batch *b, uint32_t instance, Chip8 *out) {
+  const Shard *s = &b->shards[instance / LANES];
+  int l = (int)(instance % LANES);
+
+  chip8_init(out); // Cache de instruções vazia: chip8_run decodifica sob demanda
+  memcpy(out->memory, lane_mem(b, s, l), sizeof(b->image));
+  for (int r = 0; r < 16; r++) {
+    out->V[r] = s->V[r][l];
+    out->stack[r] = s->stack[r][l];
+  }
+  chip8_set_keys(out, s->keys[l]);
+  out->pc = s->pc[l];
+  out->I = s->I[l];
+  out->sp = s->sp[l];
+  out->delay_timer = s->delay_timer[l];
+  out->sound_timer = s->sound_timer[l];
+  out->quirks = b->quirks;
+  for (int r = 0; r < CHIP8_HEIGHT; r++) {
+    out->display[r] = s->display[r][l];
+  }
+}
+
+Chip8BatchStats chip8_batch_stats(const Chip8Batch *b) {
+  Chip8BatchStats st = {0, 0};
+  for (uint32_t si = 0; si < b->nshards; si++) {
+    st.lane_steps += b->shards[si].lane_steps;
+    st.group_steps += b->shards[si].group_steps;
+  }
+  return st;
+}
@@ -0,0 +1,537 @@
+#define _POSIX_C_SOURCE 200809L // clock_gettime, opendir
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include "chip8.h"
+#include "instructions.h"
+#include "machine.h"
+
+// Benchmarks do núcleo: microbenchmarks de cada handler inst_* e do despacho
+// (chip8_cycle e chip8_run), mais as ROMs de um diretório com teclas fixas.
+// Cada medida é a mediana de várias amostras de tempo de CPU, depois de um
+// aquecimento.
+// O resultado é gravado em JSON e pode ser comparado com uma baseline gravada
+// antes: a execução falha se alguma medida piorar além do limite.
+
+#define DEFAULT_REPEATS       7
+#define DEFAULT_THRESHOLD     10.0    // % de piora tolerada
+#define MICRO_CALLS           200000  // Chamadas por repetição de um microbenchmark
+#define DISPATCH_CYCLES       2000000 // Instruções por repetição do despacho
+#define MIN_SAMPLE_SECONDS    0.02    // Duração mínima de uma amostra
+#define ROM_FRAMES            600
+#define ROM_CYCLES_PER_FRAME  1000    // Alto, para medir o núcleo e não a espera pelos temporizadores
+#define MAX_RESULTS           512
+#define JSON_VERSION          2       // Na 1, os ciclos/s das ROMs incluíam os pulados em laços ociosos
+
+typedef enum {
+  KIND_NS_PER_OP,      // Menor é melhor
+  KIND_CYCLES_PER_SEC  // Maior é melhor
+} ResultKind;
+
+static const char* const kind_names[] = {"ns_per_op", "cycles_per_sec"};
+
+typedef struct {
+  char name[160];
+  ResultKind kind;
+  double value;
+  int has_hash;
+  uint64_t hash;       // ROMs: hash do framebuffer final (a entrada é fixa, então não deve mudar)
+} Result;
+
+typedef struct {
+  const char* name;
+  void (*handler)(Chip8*, uint16_t);
+  uint16_t opcode;
+} MicroBench;
+
+// Um caso por handler; DXYN em três alturas (a última com wrap-around nas duas bordas)
+static const MicroBench micro_benches[] = {
+  {"inst_00E0", inst_00E0, 0x00E0},
+  {"inst_1NNN", inst_1NNN, 0x1200},
+  {"inst_3XKK", inst_3XKK, 0x3133},
+  {"inst_4XKK", inst_4XKK, 0x4133},
+  {"inst_5XY0", inst_5XY0, 0x5120},
+  {"inst_6XKK", inst_6XKK, 0x6142},
+  {"inst_7XKK", inst_7XKK, 0x7101},
+  {"inst_8XY0", inst_8XY0, 0x8120},
+  {"inst_8XY1", inst_8XY1, 0x8121},
+  {"inst_8XY2", inst_8XY2, 0x8122},
+  {"inst_8XY3", inst_8XY3, 0x8123},
+  {"inst_8XY4", inst_8XY4, 0x8124},
+  {"inst_8XY5", inst_8XY5, 0x8125},
+  {"inst_8XY6", inst_8XY6, 0x8126},
+  {"inst_8XY7", inst_8XY7, 0x8127},
+  {"inst_8XYE", inst_8XYE, 0x812E},
+  {"inst_9XY0", inst_9XY0, 0x9120},
+  {"inst_ANNN", inst_ANNN, 0xA300},
+  {"inst_BNNN", inst_BNNN, 0xB300},
+  {"inst_DXYN_n1", inst_DXYN, 0xD121},
+  {"inst_DXYN_n8", inst_DXYN, 0xD128},
+  {"inst_DXYN_n15_wrap", inst_DXYN, 0xD34F},
+  {"inst_EX9E", inst_EX9E, 0xE19E},
+  {"inst_EXA1", inst_EXA1, 0xE1A1},
+  {"inst_FX07", inst_FX07, 0xF107},
+  {"inst_FX0A", inst_FX0A, 0xF10A},
+  {"inst_FX15", inst_FX15, 0xF115},
+  {"inst_FX18", inst_FX18, 0xF118},
+  {"inst_FX1E", inst_FX1E, 0xF11E},
+  {"inst_FX29", inst_FX29, 0xF129},
+  {"inst_FX33", inst_FX33, 0xF133},
+  {"inst_FX55", inst_FX55, 0xFF55},
+  {"inst_FX65", inst_FX65, 0xFF65},
+  // Variantes das quirks (I avança a cada chamada nas _inc: percorre a memória com wrap-around)
+  {"inst_8XY6_vy", inst_8XY6_vy, 0x8126},
+  {"inst_8XYE_vy", inst_8XYE_vy, 0x812E},
+  {"inst_BNNN_vx", inst_BNNN_vx, 0xB300},
+  {"inst_DXYN_n15_clip", inst_DXYN_clip, 0xD34F},
+  {"inst_FX55_inc", inst_FX55_inc, 0xFF55},
+  {"inst_FX65_inc", inst_FX65_inc, 0xFF65},
+};
+
+// Máquinas estendidas, pelo interpretador de machine.c: XO-CHIP em hires com os dois planos selecionados
+static const MicroBench machine_benches[] = {
+  {"machine_DXY0_16x16", chip8_machine_execute, 0xD340},
+  {"machine_DXYN_n8", chip8_machine_execute, 0xD128},
+  {"machine_00C4", chip8_machine_execute, 0x00C4},
+  {"machine_00D4", chip8_machine_execute, 0x00D4},
+  {"machine_00FB", chip8_machine_execute, 0x00FB},
+  {"machine_00FC", chip8_machine_execute, 0x00FC},
+};
+
+// Laço sintético para o despacho: mistura de aritmética, saltos condicionais,
+// memória e desenho, terminando em um salto para o início (não é um laço ocioso)
+static const uint8_t dispatch_program[] = {
+  0x60, 0x05, // 6005  V0 = 5
+  0x71, 0x01, // 7101  V1 += 1
+  0x82, 0x14, // 8214  V2 += V1
+  0x83, 0x22, // 8322  V3 &= V2
+  0x33, 0x07, // 3307  pula se V3 == 7
+  0x84, 0x36, // 8436  V4 >>= 1
+  0xA3, 0x00, // A300  I = 0x300
+  0xF1, 0x1E, // F11E  I += V1
+  0xF2, 0x65, // F265  V0..V2 = [I]
+  0x22, 0x1A, // 221A  chama 0x21A
+  0xD0, 0x15, // D015  desenha 5 linhas
+  0x41, 0x00, // 4100  pula se V1 != 0
+  0x65, 0x00, // 6500
+  0x12, 0x00, // 1200  volta ao início
+  0x00, 0x00, // (não executado)
+  0x85, 0x04, // 0x21A: 8504  V5 += V0
+  0x00, 0xEE, // 00EE  retorna
+};
+
+// Tempo de CPU da thread: não conta o tempo em que outro processo usou o processador
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int compare_double(const void* a, const void* b) {
+  double x = *(const double*)a, y = *(const double*)b;
+  return (x > y) - (x < y);
+}
+
+static double median(double* v, int n) {
+  qsort(v, (size_t)n, sizeof(double), compare_double);
+  return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+typedef void (*BenchBody)(void* arg); // Uma passada do que está sendo medido
+
+static double time_passes(BenchBody body, void* arg, uint32_t passes) {
+  double start = now_seconds();
+  for (uint32_t i = 0; i < passes; i++) {
+    body(arg);
+  }
+  return now_seconds() - start;
+}
+
+// Mediana do tempo de uma passada, em segundos. Depois de uma passada de
+// aquecimento, cada amostra repete a passada até durar pelo menos
+// MIN_SAMPLE_SECONDS, para que a resolução do relógio e interrupções isoladas
+// não pesem na medida
+static double measure(BenchBody body, void* arg, int repeats) {
+  double samples[64];
+  double first = time_passes(body, arg, 1);
+  uint32_t passes = 1;
+  if (first < MIN_SAMPLE_SECONDS) {
+    passes = first > 0 ? (uint32_t)(MIN_SAMPLE_SECONDS / first) + 1 : 1000;
+  }
+  for (int r = 0; r < repeats; r++) {
+    samples[r] = time_passes(body, arg, passes) / passes;
+  }
+  return median(samples, repeats);
+}
+
+// Estado comum dos microbenchmarks: registradores não nulos, sprite em I e uma tecla pressionada
+static void micro_setup(Chip8* chip8) {
+  chip8_release(chip8); // Extensão de um machine_setup anterior
+  chip8_init(chip8);
+  for (int i = 0; i < 16; i++) {
+    chip8->V[i] = (uint8_t)(i * 17 + 3);
+  }
+  chip8->V[3] = 60; // DXYN_n15_wrap: x = 60, y = V4
+  chip8->V[4] = 28;
+  chip8->I = 0x300;
+  for (int i = 0; i < 16; i++) {
+    chip8->memory[0x300 + i] = (uint8_t)(0xA5 ^ (i * 29));
+  }
+  chip8->keypad[chip8->V[1] & 0x0F] = 1;
+  chip8->pc = 0x200;
+}
+
+// Como micro_setup, mas no XO-CHIP em hires, com dois planos e 64 bytes de sprite em I (DXY0 nos dois planos)
+static void machine_setup(Chip8* chip8) {
+  micro_setup(chip8);
+  chip8_set_machine(chip8, CHIP8_MACHINE_XOCHIP);
+  chip8->hires = 1;
+  chip8->planes = 3;
+  for (int i = 0; i < 64; i++) {
+    chip8->memory[0x300 + i] = (uint8_t)(0xA5 ^ (i * 29));
+  }
+}
+
+typedef struct {
+  Chip8 chip8;
+  const MicroBench* bench;
+  int threaded;             // Despacho: chip8_run em vez de chip8_cycle
+  const Chip8* initial;     // ROMs: estado logo após chip8_load_rom
+} BenchContext;
+
+static void micro_body(void* arg) {
+  BenchContext* ctx = arg;
+  void (*handler)(Chip8*, uint16_t) = ctx->bench->handler;
+  uint16_t opcode = ctx->bench->opcode;
+  for (int i = 0; i < MICRO_CALLS; i++) {
+    handler(&ctx->chip8, opcode);
+  }
+}
+
+// Chamada e retorno juntos (00EE precisa de uma chamada antes)
+static void call_return_body(void* arg) {
+  BenchContext* ctx = arg;
+  for (int i = 0; i < MICRO_CALLS; i++) {
+    inst_2NNN(&ctx->chip8, 0x2300);
+    inst_00EE(&ctx->chip8, 0x00EE);
+  }
+}
+
+static void dispatch_body(void* arg) {
+  BenchContext* ctx = arg;
+  if (ctx->threaded) {
+    chip8_run(&ctx->chip8, DISPATCH_CYCLES);
+  } else {
+    for (int i = 0; i < DISPATCH_CYCLES; i++) {
+      chip8_cycle(&ctx->chip8);
+    }
+  }
+}
+
+// Teclas fixas: uma tecla (ou nenhuma) por 8 frames, escolhida por um hash (splitmix64) do frame
+static uint16_t fixed_keys(uint64_t frame) {
+  uint64_t h = (frame / 8) + 0x9E3779B97F4A7C15ULL;
+  h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+  h ^= h >> 31;
+  uint32_t key = (uint32_t)(h % 20);
+  return key < 16 ? (uint16_t)(1u << key) : 0;
+}
+
+static void rom_body(void* arg) {
+  BenchContext* ctx = arg;
+  chip8_copy(&ctx->chip8, ctx->initial); // CHIP-8: nada a alocar
+  for (uint64_t f = 0; f < ROM_FRAMES; f++) {
+    chip8_set_keys(&ctx->chip8, fixed_keys(f));
+    chip8_run(&ctx->chip8, ROM_CYCLES_PER_FRAME);
+    chip8_tick_timers(&ctx->chip8);
+  }
+}
+
+static BenchContext ctx; // Compartilhado pelas medidas (chip8_copy reaproveita a cache de ctx.chip8)
+
+static void run_micro(const MicroBench* b, int repeats, Result* out) {
+  micro_setup(&ctx.chip8);
+  ctx.bench = b;
+  snprintf(out->name, sizeof(out->name), "%s", b->name);
+  out->kind = KIND_NS_PER_OP;
+  out->value = measure(micro_body, &ctx, repeats) * 1e9 / MICRO_CALLS;
+}
+
+static void run_machine_micro(const MicroBench* b, int repeats, Result* out) {
+  machine_setup(&ctx.chip8);
+  ctx.bench = b;
+  snprintf(out->name, sizeof(out->name), "%s", b->name);
+  out->kind = KIND_NS_PER_OP;
+  out->value = measure(micro_body, &ctx, repeats) * 1e9 / MICRO_CALLS;
+}
+
+static void run_call_return(int repeats, Result* out) {
+  micro_setup(&ctx.chip8);
+  snprintf(out->name, sizeof(out->name), "inst_2NNN+inst_00EE");
+  out->kind = KIND_NS_PER_OP;
+  out->value = measure(call_return_body, &ctx, repeats) * 1e9 / MICRO_CALLS;
+}
+
+// Despacho: o laço sintético pelo interpretador de referência ou pela tabela pré-decodificada
+static void run_dispatch(int threaded, int repeats, Result* out) {
+  micro_setup(&ctx.chip8);
+  memcpy(ctx.chip8.memory + 0x200, dispatch_program, sizeof(dispatch_program));
+  chip8_invalidate(&ctx.chip8, 0x200, sizeof(dispatch_program));
+  ctx.threaded = threaded;
+  snprintf(out->name, sizeof(out->name), "%s", threaded ? "chip8_run_dispatch" : "chip8_cycle_dispatch");
+  out->kind = KIND_NS_PER_OP;
+  out->value = measure(dispatch_body, &ctx, repeats) * 1e9 / DISPATCH_CYCLES;
+}
+
+// ROM inteira: ciclos executados por segundo (os pulados em laços ociosos ficam de fora:
+// senão, uma ROM parada mediria o atalho e não o interpretador)
+static int run_rom(const char* path, const char* name, int repeats, Result* out) {
+  static Chip8 initial;
+  chip8_release(&initial); // Cache da ROM anterior
+  chip8_init(&initial);
+  if (chip8_load_rom(&initial, path) != 0) {
+    return -1;
+  }
+  ctx.initial = &initial;
+  double seconds = measure(rom_body, &ctx, repeats);
+  snprintf(out->name, sizeof(out->name), "rom:%s", name);
+  out->kind = KIND_CYCLES_PER_SEC;
+  uint64_t executed = (uint64_t)ROM_FRAMES * ROM_CYCLES_PER_FRAME - ctx.chip8.idle_cycles;
+  out->value = seconds > 0 ? (double)executed / seconds : 0.0;
+  out->has_hash = 1;
+  out->hash = chip8_display_hash(&ctx.chip8);
+  return 0;
+}
+
+static int has_ch8_suffix(const char* name) {
+  size_t len = strlen(name);
+  return len > 4 && strcasecmp(name + len - 4, ".ch8") == 0;
+}
+
+static int compare_names(const void* a, const void* b) {
+  return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+// ROMs do diretório em ordem alfabética (resultados na mesma ordem a cada execução)
+static int run_roms(const char* dir, int repeats, Result* results, int count) {
+  DIR* d = opendir(dir);
+  if (!d) {
+    printf("Aviso: diretório de ROMs não encontrado: %s\n", dir);
+    return count;
+  }
+  char* names[MAX_RESULTS];
+  int n = 0;
+  struct dirent* ent;
+  while ((ent = readdir(d)) != NULL && n < MAX_RESULTS) {
+    if (has_ch8_suffix(ent->d_name) && (names[n] = strdup(ent->d_name)) != NULL) {
+      n++;
+    }
+  }
+  closedir(d);
+  qsort(names, (size_t)n, sizeof(char*), compare_names);
+
+  for (int i = 0; i < n; i++) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s", dir, names[i]);
+    if (count < MAX_RESULTS && run_rom(path, names[i], repeats, &results[count]) == 0) {
+      count++;
+    }
+    free(names[i]);
+  }
+  return count;
+}
+
+static void json_string(FILE* out, const char* s) {
+  fputc('"', out);
+  for (; *s; s++) {
+    unsigned char ch = (unsigned char)*s;
+    if (ch == '"' || ch == '\\') {
+      fprintf(out, "\\%c", ch);
+    } else if (ch < 0x20) {
+      fprintf(out, "\\u%04x", ch);
+    } else {
+      fputc(ch, out);
+    }
+  }
+  fputc('"', out);
+}
+
+// Uma medida por linha: o formato que read_baseline sabe ler
+static int write_json(const char* path, const Result* results, int count, int repeats) {
+  FILE* out = fopen(path, "w");
+  if (!out) {
+    return -1;
+  }
+  fprintf(out, "{\n  \"version\": %d,\n  \"repeats\": %d,\n  \"rom_frames\": %d,\n  \"rom_cycles_per_frame\": %d,\n"
+               "  \"results\": [\n", JSON_VERSION, repeats, ROM_FRAMES, ROM_CYCLES_PER_FRAME);
+  for (int i = 0; i < count; i++) {
+    const Result* r = &results[i];
+    fprintf(out, "    {\"name\": ");
+    json_string(out, r->name);
+    fprintf(out, ", \"kind\": \"%s\", \"value\": %.3f", kind_names[r->kind], r->value);
+    if (r->has_hash) {
+      fprintf(out, ", \"hash\": \"0x%016llx\"", (unsigned long long)r->hash);
+    }
+    fprintf(out, "}%s\n", i + 1 < count ? "," : "");
+  }
+  fprintf(out, "  ]\n}\n");
+  return fclose(out) == 0 ? 0 : -1;
+}
+
+// Lê uma baseline gravada por write_json (não é um parser JSON genérico). Os ciclos/s
+// de uma baseline anterior a JSON_VERSION medem outra coisa: ficam de fora (medidas novas)
+static int read_baseline(const char* path, Result* results, int max) {
+  FILE* in = fopen(path, "r");
+  if (!in) {
+    return -1;
+  }
+  char line[1024];
+  int count = 0, version = 1;
+  while (fgets(line, sizeof(line), in) && count < max) {
+    char* field = strstr(line, "\"version\": ");
+    if (field) {
+      version = atoi(field + strlen("\"version\": "));
+      continue;
+    }
+    char* name = strstr(line, "{\"name\": \"");
+    char* value = strstr(line, "\"value\": ");
+    if (!name || !value || (version < JSON_VERSION && strstr(line, "\"cycles_per_sec\""))) {
+      continue;
+    }
+    Result* r = &results[count];
+    memset(r, 0, sizeof(*r));
+    name += strlen("{\"name\": \"");
+    size_t len = 0;
+    for (; *name && *name != '"' && len + 1 < sizeof(r->name); name++) {
+      if (*name == '\\' && name[1]) {
+        name++;
+      }
+      r->name[len++] = *name;
+    }
+    r->kind = strstr(line, "\"cycles_per_sec\"") ? KIND_CYCLES_PER_SEC : KIND_NS_PER_OP;
+    r->value = strtod(value + strlen("\"value\": "), NULL);
+    char* hash = strstr(line, "\"hash\": \"");
+    if (hash) {
+      r->has_hash = 1;
+      r->hash = strtoull(hash + strlen("\"hash\": \""), NULL, 16);
+    }
+    count++;
+  }
+  fclose(in);
+  return count;
+}
+
+// Compara com a baseline; retorna o número de regressões além do limite
+static int compare_baseline(const Result* results, int count, const Result* base, int base_count, double threshold) {
+  int regressions = 0;
+  printf("\nComparação com a baseline (limite: %.1f%% de piora)\n", threshold);
+  for (int i = 0; i < count; i++) {
+    const Result* r = &results[i];
+    const Result* b = NULL;
+    for (int j = 0; j < base_count && !b; j++) {
+      if (strcmp(base[j].name, r->name) == 0 && base[j].kind == r->kind) {
+        b = &base[j];
+      }
+    }
+    if (!b || b->value <= 0 || r->value <= 0) {
+      printf("  %-44s (nova medida)\n", r->name);
+      continue;
+    }
+    // Piora relativa: mais ns por operação ou menos ciclos por segundo
+    double worse = r->kind == KIND_NS_PER_OP ? r->value / b->value : b->value / r->value;
+    double change = (worse - 1.0) * 100.0;
+    int regressed = change > threshold;
+    regressions += regressed;
+    printf("  %-44s %+7.1f%%%s%s\n", r->name, -change, regressed ? "  REGRESSÃO" : "",
+           r->has_hash && b->has_hash && r->hash != b->hash ? "  (framebuffer final mudou)" : "");
+  }
+  return regressions;
+}
+
+static void usage(const char* prog) {
+  printf("Uso: %s [diretorio] [-n repeticoes] [-o arquivo] [--baseline arquivo] [--threshold pct]\n", prog);
+  printf("  diretorio        ROMs .ch8 medidas inteiras (padrão: games)\n");
+  printf("  -n N             repetições por medida, usa a mediana (padrão: %d)\n", DEFAULT_REPEATS);
+  printf("  -o ARQ           grava os resultados em JSON\n");
+  printf("  --baseline ARQ   compara com um JSON gravado antes (código 1 se houver regressão)\n");
+  printf("  --threshold P    piora máxima tolerada, em %% (padrão: %.0f)\n", DEFAULT_THRESHOLD);
+}
+
+int main(int argc, char* argv[]) {
+  const char* dir = "games";
+  const char* out_path = NULL;
+  const char* baseline_path = NULL;
+  double threshold = DEFAULT_THRESHOLD;
+  int repeats = DEFAULT_REPEATS;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      repeats = atoi(argv[++i]);
+      if (repeats < 1 || repeats > 64) {
+        usage(argv[0]);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      out_path = argv[++i];
+    } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+      baseline_path = argv[++i];
+    } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+      threshold = strtod(argv[++i], NULL);
+    } else if (argv[i][0] != '-') {
+      dir = argv[i];
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  static Result results[MAX_RESULTS];
+  int count = 0;
+  for (size_t i = 0; i < sizeof(micro_benches) / sizeof(micro_benches[0]); i++) {
+    run_micro(&micro_benches[i], repeats, &results[count++]);
+  }
+  for (size_t i = 0; i < sizeof(machine_benches) / sizeof(machine_benches[0]); i++) {
+    run_machine_micro(&machine_benches[i], repeats, &results[count++]);
+  }
+  run_call_return(repeats, &results[count++]);
+  run_dispatch(0, repeats, &results[count++]);
+  run_dispatch(1, repeats, &results[count++]);
+  count = run_roms(dir, repeats, results, count);
+
+  for (int i = 0; i < count; i++) {
+    if (results[i].kind == KIND_NS_PER_OP) {
+      printf("%-44s %10.2f ns/op\n", results[i].name, results[i].value);
+    } else {
+      printf("%-44s %14.0f ciclos/s\n", results[i].name, results[i].value);
+    }
+  }
+
+  if (out_path) {
+    if (write_json(out_path, results, count, repeats) != 0) {
+      printf("Erro: não foi possível gravar %s\n", out_path);
+      return 1;
+    }
+    printf("Resultados gravados em %s\n", out_path);
+  }
+
+  if (baseline_path) {
+    static Result base[MAX_RESULTS];
+    int base_count = read_baseline(baseline_path, base, MAX_RESULTS);
+    if (base_count < 0) {
+      printf("Erro: não foi possível ler a baseline %s\n", baseline_path);
+      return 1;
+    }
+    int regressions = compare_baseline(results, count, base, base_count, threshold);
+    if (regressions) {
+      printf("%d medida(s) pioraram mais de %.1f%%\n", regressions, threshold);
+      return 1;
+    }
+    printf("Nenhuma regressão acima de %.1f%%\n", threshold);
+  }
+  return 0;
+}
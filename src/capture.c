@@ -0,0 +1,455 @@
+#define _POSIX_C_SOURCE 200809L // pthread / nanosleep
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "capture.h"
+
+#define ENCODE_IDLE_NS 1000000 // Espera da thread de codificação com o ring vazio (1 ms)
+#define GIF_MIN_DELAY 2        // Centésimos: abaixo disso os navegadores usam 10
+#define GIF_MAX_DELAY 60000    // Centésimos por quadro (o campo tem 16 bits)
+#define LZW_MIN_CODE_SIZE 2    // 4 cores
+#define LZW_CLEAR (1 << LZW_MIN_CODE_SIZE)
+#define LZW_END (LZW_CLEAR + 1)
+#define LZW_MAX_CODES 4096
+
+#define MAX_PIXELS (CHIP8_HIRES_WIDTH * CHIP8_HIRES_HEIGHT)
+
+// Compressor LZW do GIF: com só 4 símbolos, o dicionário é uma trie em tabela
+typedef struct {
+  uint16_t child[LZW_MAX_CODES][4]; // Código de prefixo + pixel (0 = ainda não existe)
+  uint16_t next_code;
+  int code_size;
+  int prefix;                       // Código da sequência atual (-1 = vazia)
+  uint32_t bits;                    // Bits ainda não completaram um byte
+  int bit_count;
+  uint8_t block[255];               // Sub-bloco de dados em montagem
+  int block_len;
+  FILE* file;
+} Lzw;
+
+typedef struct {
+  uint8_t image[MAX_PIXELS];   // Frame recém-tirado do ring, em índices de cor
+  uint8_t pending[MAX_PIXELS]; // Último frame recebido, ainda sem duração conhecida
+  uint64_t pending_frame;      // Tick a partir do qual o frame pendente vale
+  int has_pending;
+  uint64_t first_frame;        // Tick do primeiro frame: o início do vídeo
+  uint8_t canvas[MAX_PIXELS];  // GIF: o que o decodificador mostra depois do último quadro
+  uint64_t written_cs;         // GIF: centésimos de segundo já gravados
+  uint8_t yuv[4][3];           // Y4M: cores da paleta em Y'CbCr (BT.601, faixa limitada)
+  uint8_t* planes;             // Y4M: quadro escalado (planos Y, Cb e Cr)
+  Lzw lzw;
+} Encoder;
+
+static inline void put16(uint8_t* p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static void lzw_byte(Lzw* z, uint8_t byte) {
+  z->block[z->block_len++] = byte;
+  if (z->block_len == (int)sizeof(z->block)) {
+    fputc(z->block_len, z->file);
+    fwrite(z->block, 1, (size_t)z->block_len, z->file);
+    z->block_len = 0;
+  }
+}
+
+static void lzw_code(Lzw* z, unsigned code) {
+  z->bits |= (uint32_t)code << z->bit_count;
+  z->bit_count += z->code_size;
+  while (z->bit_count >= 8) {
+    lzw_byte(z, (uint8_t)z->bits);
+    z->bits >>= 8;
+    z->bit_count -= 8;
+  }
+}
+
+static void lzw_reset(Lzw* z) {
+  memset(z->child, 0, sizeof(z->child));
+  z->next_code = LZW_END + 1;
+  z->code_size = LZW_MIN_CODE_SIZE + 1;
+}
+
+static void lzw_begin(Lzw* z) {
+  fputc(LZW_MIN_CODE_SIZE, z->file);
+  z->bits = 0;
+  z->bit_count = 0;
+  z->block_len = 0;
+  z->prefix = -1;
+  lzw_reset(z);
+  lzw_code(z, LZW_CLEAR);
+}
+
+static void lzw_pixel(Lzw* z, uint8_t pixel) {
+  if (z->prefix < 0) {
+    z->prefix = pixel;
+    return;
+  }
+  uint16_t code = z->child[z->prefix][pixel];
+  if (code) {
+    z->prefix = code;
+    return;
+  }
+  lzw_code(z, (unsigned)z->prefix);
+  if (z->next_code < LZW_MAX_CODES) {
+    // O decodificador cresce o código um passo depois: aumenta quando o próximo não cabe
+    if (z->next_code == 1u << z->code_size) {
+      z->code_size++;
+    }
+    z->child[z->prefix][pixel] = z->next_code++;
+  } else {
+    // Dicionário cheio: recomeça
+    lzw_code(z, LZW_CLEAR);
+    lzw_reset(z);
+  }
+  z->prefix = pixel;
+}
+
+static void lzw_end(Lzw* z) {
+  lzw_code(z, (unsigned)z->prefix);
+  // Depois do último código o decodificador ainda cria uma entrada: o END já vem com o tamanho novo
+  if (z->next_code == 1u << z->code_size && z->code_size < 12) {
+    z->code_size++;
+  }
+  lzw_code(z, LZW_END);
+  if (z->bit_count > 0) {
+    lzw_byte(z, (uint8_t)z->bits);
+  }
+  if (z->block_len > 0) {
+    fputc(z->block_len, z->file);
+    fwrite(z->block, 1, (size_t)z->block_len, z->file);
+  }
+  fputc(0, z->file);
+}
+
+static inline unsigned row_bit(uint64_t row, int x) {
+  return (unsigned)(row >> (63 - (x & 63))) & 1;
+}
+
+// Frame do ring -> um índice de cor por pixel (bit do plano 1 | bit do plano 2 << 1)
+static void frame_indices(const Chip8Capture* cap, const Chip8CaptureFrame* f, uint8_t* out) {
+  if (cap->width == CHIP8_WIDTH) {
+    for (int y = 0; y < CHIP8_HEIGHT; y++) {
+      for (int x = 0; x < CHIP8_WIDTH; x++) {
+        out[y * CHIP8_WIDTH + x] = (uint8_t)row_bit(f->rows[0][y][0], x);
+      }
+    }
+    return;
+  }
+  // Em lores, cada pixel de 64x32 ocupa 2x2
+  int shift = f->hires ? 0 : 1;
+  for (int y = 0; y < CHIP8_HIRES_HEIGHT; y++) {
+    int sy = y >> shift;
+    for (int x = 0; x < CHIP8_HIRES_WIDTH; x++) {
+      int sx = x >> shift;
+      out[y * CHIP8_HIRES_WIDTH + x] =
+        (uint8_t)(row_bit(f->rows[0][sy][sx >> 6], sx) | row_bit(f->rows[1][sy][sx >> 6], sx) << 1);
+    }
+  }
+}
+
+// Tick -> centésimos de segundo desde o início do vídeo (arredondado)
+static uint64_t frame_cs(const Encoder* e, uint64_t frame) {
+  return ((frame - e->first_frame) * 100 + CHIP8_TIMER_HZ / 2) / CHIP8_TIMER_HZ;
+}
+
+// GIF: grava `image` como um quadro que dura `delay` centésimos, só com o retângulo
+// que mudou em relação ao anterior (os pixels de fora continuam na tela)
+static void gif_frame(Chip8Capture* cap, Encoder* e, const uint8_t* image, uint64_t delay) {
+  int w = cap->width, s = cap->scale;
+  int x0 = w, y0 = cap->height, x1 = 0, y1 = 0;
+  for (int y = 0; y < cap->height; y++) {
+    for (int x = 0; x < w; x++) {
+      if (image[y * w + x] != e->canvas[y * w + x]) {
+        x0 = x < x0 ? x : x0;
+        x1 = x > x1 ? x : x1;
+        y0 = y < y0 ? y : y0;
+        y1 = y;
+      }
+    }
+  }
+  if (x0 > x1) {
+    x0 = x1 = y0 = y1 = 0; // Nada mudou (quadro só de espera): um pixel igual ao da tela
+  }
+
+  // Extensão de controle (sem descarte: o próximo quadro se desenha por cima) e descritor
+  uint8_t header[18] = {0x21, 0xF9, 0x04, 0x04, 0, 0, 0, 0, 0x2C};
+  put16(header + 4, (uint16_t)delay);
+  put16(header + 9, (uint16_t)(x0 * s));
+  put16(header + 11, (uint16_t)(y0 * s));
+  put16(header + 13, (uint16_t)((x1 - x0 + 1) * s));
+  put16(header + 15, (uint16_t)((y1 - y0 + 1) * s));
+  fwrite(header, 1, sizeof(header), cap->file);
+
+  Lzw* z = &e->lzw;
+  z->file = cap->file;
+  lzw_begin(z);
+  for (int y = y0; y <= y1; y++) {
+    for (int ry = 0; ry < s; ry++) {
+      for (int x = x0; x <= x1; x++) {
+        for (int rx = 0; rx < s; rx++) {
+          lzw_pixel(z, image[y * w + x]);
+        }
+      }
+    }
+    memcpy(&e->canvas[y * w + x0], &image[y * w + x0], (size_t)(x1 - x0 + 1));
+  }
+  lzw_end(z);
+}
+
+// GIF: o frame pendente passa a ter duração até o tick `until`
+static void gif_emit(Chip8Capture* cap, Encoder* e, uint64_t until) {
+  uint64_t delay = frame_cs(e, until) - e->written_cs;
+  if (delay < GIF_MIN_DELAY) {
+    delay = GIF_MIN_DELAY;
+  }
+  e->written_cs += delay;
+  while (delay > GIF_MAX_DELAY) {
+    gif_frame(cap, e, e->pending, GIF_MAX_DELAY);
+    delay -= GIF_MAX_DELAY;
+  }
+  gif_frame(cap, e, e->pending, delay);
+}
+
+// Y4M: o frame pendente repetido em cada tick até `until`. Um frame que só começa em
+// `until` (o display depois do último tick, no fechamento) não ocupa nenhum; o vídeo
+// vazio ainda leva um quadro
+static void y4m_emit(Chip8Capture* cap, Encoder* e, uint64_t until) {
+  int s = cap->scale;
+  size_t plane = (size_t)cap->width * s * cap->height * s;
+  uint8_t* out = e->planes;
+  for (int y = 0; y < cap->height; y++) {
+    for (int ry = 0; ry < s; ry++) {
+      for (int x = 0; x < cap->width; x++) {
+        const uint8_t* yuv = e->yuv[e->pending[y * cap->width + x]];
+        for (int rx = 0; rx < s; rx++, out++) {
+          out[0] = yuv[0];
+          out[plane] = yuv[1];
+          out[2 * plane] = yuv[2];
+        }
+      }
+    }
+  }
+  uint64_t count = until > e->pending_frame ? until - e->pending_frame : until == e->first_frame;
+  for (uint64_t k = 0; k < count; k++) {
+    fputs("FRAME\n", cap->file);
+    fwrite(e->planes, 1, 3 * plane, cap->file);
+  }
+}
+
+// Um frame novo encerra o pendente; mudanças em menos de GIF_MIN_DELAY só trocam a imagem dele
+static void encode_frame(Chip8Capture* cap, Encoder* e, uint64_t frame) {
+  size_t pixels = (size_t)cap->width * cap->height;
+  if (!e->has_pending) {
+    e->first_frame = frame;
+    e->pending_frame = frame;
+    e->has_pending = 1;
+    memcpy(e->pending, e->image, pixels);
+    return;
+  }
+  if (frame < e->pending_frame) {
+    frame = e->pending_frame; // Ticks fora de ordem contam como o mesmo instante
+  }
+  if (memcmp(e->image, e->pending, pixels) == 0) {
+    return;
+  }
+  if (cap->gif ? frame_cs(e, frame) - e->written_cs < GIF_MIN_DELAY : frame == e->pending_frame) {
+    memcpy(e->pending, e->image, pixels);
+    return;
+  }
+  if (cap->gif) {
+    gif_emit(cap, e, frame);
+  } else {
+    y4m_emit(cap, e, frame);
+  }
+  e->pending_frame = frame;
+  memcpy(e->pending, e->image, pixels);
+}
+
+// Codifica os frames [tail, head) e libera o espaço no ring
+static size_t drain_ring(Chip8Capture* cap) {
+  Encoder* e = cap->encoder;
+  size_t tail = atomic_load_explicit(&cap->tail, memory_order_relaxed);
+  // acquire: pareia com o release da emulação, os frames até head estão completos
+  size_t head = atomic_load_explicit(&cap->head, memory_order_acquire);
+  size_t done = 0;
+  while (tail != head) {
+    const Chip8CaptureFrame* f = &cap->ring[tail & (CHIP8_CAPTURE_RING - 1)];
+    uint64_t frame = f->frame;
+    frame_indices(cap, f, e->image);
+    // release: a emulação só reutiliza o slot depois de convertido
+    atomic_store_explicit(&cap->tail, ++tail, memory_order_release);
+    encode_frame(cap, e, frame);
+    done++;
+  }
+  return done;
+}
+
+static void* encode_main(void* arg) {
+  Chip8Capture* cap = arg;
+  while (!atomic_load_explicit(&cap->stop, memory_order_acquire)) {
+    if (drain_ring(cap) == 0) {
+      struct timespec idle = {0, ENCODE_IDLE_NS};
+      nanosleep(&idle, NULL);
+    }
+  }
+  drain_ring(cap);
+  return NULL;
+}
+
+static int write_header(Chip8Capture* cap) {
+  int w = cap->width * cap->scale, h = cap->height * cap->scale;
+  if (!cap->gif) {
+    return fprintf(cap->file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", w, h, CHIP8_TIMER_HZ) < 0 ? -1 : 0;
+  }
+  // Tela lógica com tabela global de 4 cores e o bloco NETSCAPE2.0 (repetição infinita)
+  uint8_t header[13 + 12 + 19] = {'G', 'I', 'F', '8', '9', 'a'};
+  put16(header + 6, (uint16_t)w);
+  put16(header + 8, (uint16_t)h);
+  header[10] = 0x80 | (LZW_MIN_CODE_SIZE - 1) << 4 | (LZW_MIN_CODE_SIZE - 1);
+  memcpy(header + 13, cap->palette, 12);
+  static const uint8_t loop[19] = {0x21, 0xFF, 0x0B, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0', 0x03, 0x01, 0, 0, 0};
+  memcpy(header + 25, loop, sizeof(loop));
+  return fwrite(header, 1, sizeof(header), cap->file) == sizeof(header) ? 0 : -1;
+}
+
+static int has_suffix(const char* path, const char* suffix) {
+  size_t n = strlen(path), k = strlen(suffix);
+  if (n < k) {
+    return 0;
+  }
+  for (size_t i = 0; i < k; i++) {
+    char c = path[n - k + i];
+    if ((c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c) != suffix[i]) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+Chip8Capture* chip8_capture_open(const char* path, Chip8Machine machine, int scale, const Chip8CapturePalette palette) {
+  if (scale < 1 || scale > CHIP8_CAPTURE_MAX_SCALE) {
+    return NULL;
+  }
+  Chip8Capture* cap = calloc(1, sizeof(Chip8Capture));
+  Encoder* e = calloc(1, sizeof(Encoder));
+  pthread_t* thread = malloc(sizeof(pthread_t));
+  if (!cap || !e || !thread) {
+    free(cap);
+    free(e);
+    free(thread);
+    return NULL;
+  }
+  int extended = machine != CHIP8_MACHINE_CHIP8;
+  cap->width = extended ? CHIP8_HIRES_WIDTH : CHIP8_WIDTH;
+  cap->height = extended ? CHIP8_HIRES_HEIGHT : CHIP8_HEIGHT;
+  cap->scale = scale;
+  cap->gif = !has_suffix(path, ".y4m");
+  memcpy(cap->palette, palette, sizeof(cap->palette));
+  for (int k = 0; k < 4; k++) {
+    int r = palette[k][0], g = palette[k][1], b = palette[k][2];
+    e->yuv[k][0] = (uint8_t)(16 + ((66 * r + 129 * g + 25 * b + 128) >> 8));
+    e->yuv[k][1] = (uint8_t)(128 + ((-38 * r - 74 * g + 112 * b + 128) >> 8));
+    e->yuv[k][2] = (uint8_t)(128 + ((112 * r - 94 * g - 18 * b + 128) >> 8));
+  }
+  if (!cap->gif) {
+    e->planes = malloc((size_t)3 * cap->width * scale * cap->height * scale);
+  }
+  cap->encoder = e;
+  cap->ring = malloc(sizeof(Chip8CaptureFrame) * CHIP8_CAPTURE_RING);
+  cap->file = cap->ring && (cap->gif || e->planes) ? fopen(path, "wb") : NULL;
+  if (!cap->file || write_header(cap) != 0) {
+    if (cap->file) {
+      fclose(cap->file);
+    }
+    free(cap->ring);
+    free(e->planes);
+    free(e);
+    free(cap);
+    free(thread);
+    return NULL;
+  }
+  atomic_init(&cap->head, 0);
+  atomic_init(&cap->tail, 0);
+  atomic_init(&cap->stop, 0);
+  if (pthread_create(thread, NULL, encode_main, cap) != 0) {
+    fclose(cap->file);
+    free(cap->ring);
+    free(e->planes);
+    free(e);
+    free(cap);
+    free(thread);
+    return NULL;
+  }
+  cap->thread = thread;
+  return cap;
+}
+
+void chip8_capture_push(Chip8Capture* cap, const Chip8* c, uint64_t frame) {
+  size_t head = atomic_load_explicit(&cap->head, memory_order_relaxed);
+  if (head - cap->cached_tail >= CHIP8_CAPTURE_RING) {
+    cap->cached_tail = atomic_load_explicit(&cap->tail, memory_order_acquire);
+    if (head - cap->cached_tail >= CHIP8_CAPTURE_RING) {
+      cap->dropped++; // Ring cheio: descarta sem esperar; o próximo frame traz o display atual
+      return;
+    }
+  }
+
+  Chip8CaptureFrame* f = &cap->ring[head & (CHIP8_CAPTURE_RING - 1)];
+  f->frame = frame;
+  f->hires = c->hires;
+  if (c->machine == CHIP8_MACHINE_CHIP8) {
+    for (int y = 0; y < CHIP8_HEIGHT; y++) {
+      f->rows[0][y][0] = c->display[y];
+    }
+  } else {
+    memcpy(f->rows, c->ext->screen, sizeof(f->rows));
+  }
+  cap->pushed++;
+  // release: a thread de codificação vê o frame completo antes do novo head
+  atomic_store_explicit(&cap->head, head + 1, memory_order_release);
+}
+
+void chip8_capture_wait(Chip8Capture* cap) {
+  size_t head = atomic_load_explicit(&cap->head, memory_order_relaxed);
+  while (head - atomic_load_explicit(&cap->tail, memory_order_acquire) >= CHIP8_CAPTURE_RING) {
+    struct timespec idle = {0, ENCODE_IDLE_NS};
+    nanosleep(&idle, NULL);
+  }
+}
+
+int chip8_capture_close(Chip8Capture* cap, uint64_t end_frame) {
+  if (!cap) {
+    return -1;
+  }
+  atomic_store_explicit(&cap->stop, 1, memory_order_release);
+  pthread_join(*(pthread_t*)cap->thread, NULL);
+
+  // O último frame dura até end_frame; o GIF termina com o trailer
+  Encoder* e = cap->encoder;
+  if (e->has_pending) {
+    if (end_frame < e->pending_frame) {
+      end_frame = e->pending_frame;
+    }
+    if (cap->gif) {
+      gif_emit(cap, e, end_frame);
+    } else {
+      y4m_emit(cap, e, end_frame);
+    }
+  }
+  if (cap->gif) {
+    fputc(0x3B, cap->file);
+  }
+  int status = ferror(cap->file) ? -1 : 0;
+  if (fclose(cap->file) != 0) {
+    status = -1;
+  }
+  free(cap->thread);
+  free(cap->ring);
+  free(e->planes);
+  free(e);
+  free(cap);
+  return status;
+}
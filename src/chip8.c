@@ -1,6 +1,11 @@
 #include "chip8.h"
 #include "instructions.h"
+#include "machine.h"
+#include "profile.h"
+#include "quirks.h"
+#include "trace.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 // Fonte CHIP-8: cada caractere (0-F) tem 5 bytes, total de 80 bytes
@@ -34,10 +39,25 @@ void chip8_init(Chip8* chip8) {
   chip8->I = 0;              // Registrador de índice
   chip8->pc = 0x200;         // Contador de programa começa em 0x200 (onde os programas são carregados)
   chip8->sp = 0;             // Ponteiro de pilha
+  chip8->oob_accesses = 0;   // Acessos fora da memória
+  chip8->idle_cycles = 0;    // Ciclos pulados em laços ociosos
+  chip8->quirks = CHIP8_QUIRKS_MODERN; // chip8_load_rom escolhe as da ROM
+
+  // CHIP-8 original: sem resolução alta, planos nem registradores extras (chip8_set_machine troca)
+  chip8->machine = CHIP8_MACHINE_CHIP8;
+  chip8->hires = 0;
+  chip8->planes = 0;
+  chip8->pitch = 0;
+  memset(chip8->flags, 0, sizeof(chip8->flags));
+  memset(chip8->audio_pattern, 0, sizeof(chip8->audio_pattern));
+  chip8->ext = NULL;
+  chip8->decoded = NULL; // Alocada na carga da ROM
 
   // Zera pilha, display e teclado
   memset(chip8->stack, 0, sizeof(chip8->stack));
   memset(chip8->display, 0, sizeof(chip8->display));
+  chip8->display_gen = 0;
+  chip8->dirty_rows = 0xFFFFFFFFu; // Primeiro frame: tudo precisa ser enviado
   memset(chip8->keypad, 0, sizeof(chip8->keypad));
 
   // Zera temporizadores
@@ -51,6 +71,22 @@ void chip8_init(Chip8* chip8) {
   }
 }
 
+// Aloca a cache de instruções vazia (tudo será decodificado sob demanda); 0 ou -1
+static int alloc_decoded(Chip8* chip8) {
+  if (!chip8->decoded) {
+    chip8->decoded = calloc(4096, sizeof(Chip8Decoded));
+  }
+  return chip8->decoded ? 0 : -1;
+}
+
+// Pré-decodifica toda a memória (fonte + ROM) de uma vez
+static void predecode_all(Chip8* chip8) {
+  for (int addr = 0; addr < 4096 - 1; addr++) {
+    uint16_t opcode = (chip8->memory[addr] << 8) | chip8->memory[addr + 1];
+    chip8->decoded[addr] = chip8_decode(opcode);
+  }
+}
+
 int chip8_load_rom(Chip8* chip8, const char* path) {
   FILE* file = fopen(path, "rb");
   if (!file) {
@@ -64,34 +100,341 @@ int chip8_load_rom(Chip8* chip8, const char* path) {
 
   // Verifica se o arquivo não excede o tamanho máximo disponível
   // Memória total: 4096 bytes, programas começam em 0x200 (512 bytes)
-  // Espaço disponível: 4096 - 512 = 3584 bytes
-  if (size > (4096 - 0x200)) {
+  // Espaço disponível: 4096 - 512 = 3584 bytes (65024 no XO-CHIP)
+  if (size < 0 || size > (long)chip8_memory_size(chip8) - 0x200) {
     fclose(file);
     return -2; // ROM muito grande
   }
 
-  // Lê o arquivo binário diretamente na memória começando em 0x200
-  size_t bytes_read = fread(&chip8->memory[0x200], 1, size, file);
+  // Lê o arquivo inteiro (no XO-CHIP ele passa dos 4 KB de Chip8.memory)
+  uint8_t* data = malloc(size > 0 ? (size_t)size : 1);
+  if (!data) {
+    fclose(file);
+    return -4; // Sem memória
+  }
+  size_t bytes_read = fread(data, 1, size, file);
   fclose(file);
 
   if (bytes_read != (size_t)size) {
+    free(data);
     return -3; // Erro ao ler o arquivo
   }
 
-  return 0; // Sucesso
+  int result = chip8_load_rom_image(chip8, data, (size_t)size);
+  free(data);
+  return result;
+}
+
+int chip8_load_rom_image(Chip8* chip8, const uint8_t* data, size_t size) {
+  if (size > chip8_memory_size(chip8) - 0x200) {
+    return -2; // ROM muito grande
+  }
+  // O que passa dos 4 KB (só no XO-CHIP) vai para a extensão
+  size_t low = size < 4096 - 0x200 ? size : 4096 - 0x200;
+  memcpy(&chip8->memory[0x200], data, low);
+  if (size > low) {
+    memcpy(chip8->ext->memory, data + low, size - low);
+  }
+  chip8->quirks = chip8_quirks_for_rom(data, size, chip8_machine_quirks(chip8->machine));
+  // As máquinas estendidas não usam a tabela (machine.c tem o próprio interpretador)
+  if (chip8->machine == CHIP8_MACHINE_CHIP8) {
+    if (alloc_decoded(chip8) != 0) {
+      return -4; // Sem memória
+    }
+    predecode_all(chip8);
+  }
+  return 0;
+}
+
+const char* chip8_load_error(int code) {
+  switch (code) {
+    case 0:  return "Sucesso";
+    case -1: return "Arquivo não encontrado";
+    case -2: return "ROM muito grande (máximo 3584 bytes; 65024 com --machine xochip)";
+    case -3: return "Falha ao ler o arquivo";
+    case -4: return "Sem memória para a ROM";
+    default: return "Erro desconhecido ao carregar ROM";
+  }
+}
+
+Chip8Decoded chip8_decode(uint16_t opcode) {
+  Chip8Decoded d;
+  d.opcode = opcode;
+  d.nnn = opcode & 0x0FFF;
+  d.x = (opcode & 0x0F00) >> 8;
+  d.y = (opcode & 0x00F0) >> 4;
+  d.kk = opcode & 0x00FF;
+  d.op = CHIP8_OP_NOP;
+
+  // Mesma árvore de decisão do chip8_cycle, executada uma única vez por endereço
+  switch (opcode & 0xF000) {
+    case 0x0000:
+      if (opcode == 0x00E0) d.op = CHIP8_OP_00E0;
+      else if (opcode == 0x00EE) d.op = CHIP8_OP_00EE;
+      break;
+    case 0x1000: d.op = CHIP8_OP_1NNN; break;
+    case 0x2000: d.op = CHIP8_OP_2NNN; break;
+    case 0x3000: d.op = CHIP8_OP_3XKK; break;
+    case 0x4000: d.op = CHIP8_OP_4XKK; break;
+    case 0x5000: d.op = CHIP8_OP_5XY0; break;
+    case 0x6000: d.op = CHIP8_OP_6XKK; break;
+    case 0x7000: d.op = CHIP8_OP_7XKK; break;
+    case 0x8000:
+      switch (opcode & 0x000F) {
+        case 0x0: d.op = CHIP8_OP_8XY0; break;
+        case 0x1: d.op = CHIP8_OP_8XY1; break;
+        case 0x2: d.op = CHIP8_OP_8XY2; break;
+        case 0x3: d.op = CHIP8_OP_8XY3; break;
+        case 0x4: d.op = CHIP8_OP_8XY4; break;
+        case 0x5: d.op = CHIP8_OP_8XY5; break;
+        case 0x6: d.op = CHIP8_OP_8XY6; break;
+        case 0x7: d.op = CHIP8_OP_8XY7; break;
+        case 0xE: d.op = CHIP8_OP_8XYE; break;
+      }
+      break;
+    case 0x9000: d.op = CHIP8_OP_9XY0; break;
+    case 0xA000: d.op = CHIP8_OP_ANNN; break;
+    case 0xB000: d.op = CHIP8_OP_BNNN; break;
+    case 0xD000: d.op = CHIP8_OP_DXYN; break;
+    case 0xE000:
+      switch (opcode & 0x00FF) {
+        case 0x9E: d.op = CHIP8_OP_EX9E; break;
+        case 0xA1: d.op = CHIP8_OP_EXA1; break;
+      }
+      break;
+    case 0xF000:
+      switch (opcode & 0x00FF) {
+        case 0x07: d.op = CHIP8_OP_FX07; break;
+        case 0x0A: d.op = CHIP8_OP_FX0A; break;
+        case 0x15: d.op = CHIP8_OP_FX15; break;
+        case 0x18: d.op = CHIP8_OP_FX18; break;
+        case 0x1E: d.op = CHIP8_OP_FX1E; break;
+        case 0x29: d.op = CHIP8_OP_FX29; break;
+        case 0x33: d.op = CHIP8_OP_FX33; break;
+        case 0x55: d.op = CHIP8_OP_FX55; break;
+        case 0x65: d.op = CHIP8_OP_FX65; break;
+      }
+      break;
+  }
+  return d;
+}
+
+void chip8_invalidate(Chip8* chip8, uint16_t addr, uint16_t len) {
+  // A entrada do endereço a cobre os bytes a e a+1: uma escrita em a afeta as entradas a-1 e a
+  uint32_t start = addr > 0 ? addr - 1u : 0u;
+  uint32_t end = (uint32_t)addr + len;
+  if (!chip8->decoded) {
+    return; // Nada decodificado ainda
+  }
+  for (uint32_t a = start; a < end && a < 4096; a++) {
+    chip8->decoded[a].op = CHIP8_OP_UNDECODED;
+  }
+}
+
+// Busca a próxima instrução na cache e avança o PC
+// PCs fora da memória (ou no último byte) não têm entrada: decodifica na hora
+static inline Chip8Decoded* fetch(Chip8* chip8, Chip8Decoded* decoded, Chip8Decoded* scratch) {
+  uint16_t pc = chip8->pc;
+  chip8->pc += 2;
+  if (pc < 4096 - 1) {
+    return &decoded[pc];
+  }
+  chip8->oob_accesses++;
+  *scratch = chip8_decode((chip8->memory[pc & 0x0FFF] << 8) | chip8->memory[(pc + 1) & 0x0FFF]);
+  return scratch;
+}
+
+// Desfaz o fetch da instrução atual (que não chegou a executar)
+static inline void unfetch(Chip8* chip8) {
+  chip8->pc -= 2;
+  if (chip8->pc >= 4096 - 1) {
+    chip8->oob_accesses--; // Será contado de novo quando ela executar
+  }
+}
+
+// Um núcleo chip8_run por combinação de quirks (corpo em chip8_run.inc)
+#define CORE_NAME run_q0
+#define CORE_QUIRKS 0
+#include "chip8_run.inc"
+#define CORE_NAME run_q1
+#define CORE_QUIRKS 1
+#include "chip8_run.inc"
+#define CORE_NAME run_q2
+#define CORE_QUIRKS 2
+#include "chip8_run.inc"
+#define CORE_NAME run_q3
+#define CORE_QUIRKS 3
+#include "chip8_run.inc"
+#define CORE_NAME run_q4
+#define CORE_QUIRKS 4
+#include "chip8_run.inc"
+#define CORE_NAME run_q5
+#define CORE_QUIRKS 5
+#include "chip8_run.inc"
+#define CORE_NAME run_q6
+#define CORE_QUIRKS 6
+#include "chip8_run.inc"
+#define CORE_NAME run_q7
+#define CORE_QUIRKS 7
+#include "chip8_run.inc"
+#define CORE_NAME run_q8
+#define CORE_QUIRKS 8
+#include "chip8_run.inc"
+#define CORE_NAME run_q9
+#define CORE_QUIRKS 9
+#include "chip8_run.inc"
+#define CORE_NAME run_q10
+#define CORE_QUIRKS 10
+#include "chip8_run.inc"
+#define CORE_NAME run_q11
+#define CORE_QUIRKS 11
+#include "chip8_run.inc"
+#define CORE_NAME run_q12
+#define CORE_QUIRKS 12
+#include "chip8_run.inc"
+#define CORE_NAME run_q13
+#define CORE_QUIRKS 13
+#include "chip8_run.inc"
+#define CORE_NAME run_q14
+#define CORE_QUIRKS 14
+#include "chip8_run.inc"
+#define CORE_NAME run_q15
+#define CORE_QUIRKS 15
+#include "chip8_run.inc"
+// Os mesmos núcleos, parando antes de um FX15/FX18 que ligaria um temporizador
+#define CORE_NAME run_timer_q0
+#define CORE_QUIRKS 0
+#define CORE_UNTIL_TIMER 1
+#include "chip8_run.inc"
+#define CORE_NAME run_timer_q1
+#define CORE_QUIRKS 1
+#define CORE_UNTIL_TIMER 1
+#include "chip8_run.inc"
+#define CORE_NAME run_timer_q2
+#define CORE_QUIRKS 2
+#define CORE_UNTIL_TIMER 1
+#include "chip8_run.inc"
+#define CORE_NAME run_timer_q3
+#define CORE_QUIRKS 3
+#define CORE_UNTIL_TIMER 1
+#include "chip8_run.inc"
+#define CORE_NAME run_timer_q4
+#define CORE_QUIRKS 4
+#define CORE_UNTIL_TIMER 1
+#include "chip8_run.inc"
+#define CORE_NAME run_timer_q5
+#define CORE_QUIRKS 5
+#define CORE_UNTIL_TIMER 1
+#include "chip8_run.inc"
+#define CORE_NAME run_timer_q6
+#define CORE_QUIRKS 6
+#define CORE_UNTIL_TIMER 1
+#include "chip8_run.inc"
+#define CORE_NAME run_timer_q7
+#define CORE_QUIRKS 7
+#define CORE_UNTIL_TIMER 1
+#include "chip8_run.inc"
+#define CORE_NAME run_timer_q8
+#define CORE_QUIRKS 8
+#define CORE_UNTIL_TIMER 1
+#include "chip8_run.inc"
+#define CORE_NAME run_timer_q9
+#define CORE_QUIRKS 9
+#define CORE_UNTIL_TIMER 1
+#include "chip8_run.inc"
+#define CORE_NAME run_timer_q10
+#define CORE_QUIRKS 10
+#define CORE_UNTIL_TIMER 1
+#include "chip8_run.inc"
+#define CORE_NAME run_timer_q11
+#define CORE_QUIRKS 11
+#define CORE_UNTIL_TIMER 1
+#include "chip8_run.inc"
+#define CORE_NAME run_timer_q12
+#define CORE_QUIRKS 12
+#define CORE_UNTIL_TIMER 1
+#include "chip8_run.inc"
+#define CORE_NAME run_timer_q13
+#define CORE_QUIRKS 13
+#define CORE_UNTIL_TIMER 1
+#include "chip8_run.inc"
+#define CORE_NAME run_timer_q14
+#define CORE_QUIRKS 14
+#define CORE_UNTIL_TIMER 1
+#include "chip8_run.inc"
+#define CORE_NAME run_timer_q15
+#define CORE_QUIRKS 15
+#define CORE_UNTIL_TIMER 1
+#include "chip8_run.inc"
+
+static uint32_t (* const run_cores[CHIP8_QUIRK_COUNT])(Chip8* chip8, uint32_t cycles) = {
+  run_q0, run_q1, run_q2, run_q3, run_q4, run_q5, run_q6, run_q7,
+  run_q8, run_q9, run_q10, run_q11, run_q12, run_q13, run_q14, run_q15,
+};
+
+static uint32_t (* const run_timer_cores[CHIP8_QUIRK_COUNT])(Chip8* chip8, uint32_t cycles) = {
+  run_timer_q0, run_timer_q1, run_timer_q2, run_timer_q3, run_timer_q4, run_timer_q5, run_timer_q6, run_timer_q7,
+  run_timer_q8, run_timer_q9, run_timer_q10, run_timer_q11, run_timer_q12, run_timer_q13, run_timer_q14, run_timer_q15,
+};
+
+// A escolha do núcleo acontece uma vez por chamada, não por instrução
+void chip8_run(Chip8* chip8, uint32_t cycles) {
+  if (chip8->machine != CHIP8_MACHINE_CHIP8) {
+    chip8_machine_run(chip8, cycles); // SUPER-CHIP / XO-CHIP: sem tabela pré-decodificada
+    return;
+  }
+  if (alloc_decoded(chip8) != 0) {
+    for (uint32_t i = 0; i < cycles; i++) {
+      chip8_cycle(chip8); // Sem memória para a tabela: mesmo resultado, sem a cache
+    }
+    return;
+  }
+  run_cores[chip8->quirks & (CHIP8_QUIRK_COUNT - 1)](chip8, cycles);
+}
+
+uint32_t chip8_run_until_timer(Chip8* chip8, uint32_t cycles) {
+  if (chip8->machine != CHIP8_MACHINE_CHIP8 || alloc_decoded(chip8) != 0) {
+    return 0; // Sem a parada nas máquinas estendidas (ou sem a tabela): quem chama segue tick a tick
+  }
+  return cycles - run_timer_cores[chip8->quirks & (CHIP8_QUIRK_COUNT - 1)](chip8, cycles);
 }
 
 void chip8_cycle(Chip8* chip8) {
+#ifdef CHIP8_PROFILE
+  // Perfilador (make PROFILE=1): conta a instrução e, amostrada, cronometra a execução
+  Chip8Profile* profile = chip8_profile_active;
+  uint64_t profile_start = profile ? chip8_profile_begin(profile, chip8) : 0;
+#endif
+#ifdef CHIP8_TRACE
+  // Trace (make TRACE=1): registradores antes da instrução, para achar o que ela mudou
+  Chip8Trace* trace = chip8_trace_active;
+  uint16_t trace_pc = chip8->pc;
+  uint8_t trace_v[16];
+  if (trace) {
+    memcpy(trace_v, chip8->V, sizeof(trace_v));
+  }
+#endif
+
   // FETCH: Lê o opcode de 16 bits da memória no endereço PC
   // CHIP-8 usa big-endian: byte alto primeiro, depois byte baixo
-  uint16_t opcode = (chip8->memory[chip8->pc] << 8) | chip8->memory[chip8->pc + 1];
+  // PCs fora da memória (ou no último byte) fazem wrap-around em 4 KB (64 KB no XO-CHIP)
+  uint16_t mask = chip8->machine == CHIP8_MACHINE_XOCHIP ? 0xFFFF : 0x0FFF;
+  if (chip8->pc >= mask) {
+    chip8->oob_accesses++;
+  }
+  uint16_t opcode = mask == 0x0FFF
+                        ? (chip8->memory[chip8->pc & mask] << 8) | chip8->memory[(chip8->pc + 1) & mask]
+                        : (chip8_peek(chip8, chip8->pc) << 8) | chip8_peek(chip8, chip8->pc + 1u);
   chip8->pc += 2; // Incrementa PC em 2 (cada instrução tem 2 bytes)
 
   // DECODE: Extrai o nibble superior (primeiros 4 bits) para identificar a instrução
   // EXECUTE: Chama a função correspondente à instrução
+  // As quirks são testadas aqui a cada instrução; chip8_run tem um núcleo compilado por combinação
   uint16_t instruction = opcode & 0xF000;
 
-  switch (instruction) {
+  if (chip8->machine != CHIP8_MACHINE_CHIP8) {
+    chip8_machine_execute(chip8, opcode); // SUPER-CHIP / XO-CHIP (machine.c)
+  } else switch (instruction) {
     case 0x0000:
       // Instruções 0xxx - precisa verificar os últimos bits
       if (opcode == 0x00E0) {
@@ -139,9 +482,15 @@ void chip8_cycle(Chip8* chip8) {
         case 0x3: inst_8XY3(chip8, opcode); break; // XOR Vx, Vy
         case 0x4: inst_8XY4(chip8, opcode); break; // ADD Vx, Vy
         case 0x5: inst_8XY5(chip8, opcode); break; // SUB Vx, Vy
-        case 0x6: inst_8XY6(chip8, opcode); break; // SHR Vx
+        case 0x6: // SHR Vx
+          if (chip8->quirks & CHIP8_QUIRK_SHIFT_VY) inst_8XY6_vy(chip8, opcode);
+          else inst_8XY6(chip8, opcode);
+          break;
         case 0x7: inst_8XY7(chip8, opcode); break; // SUBN Vx, Vy
-        case 0xE: inst_8XYE(chip8, opcode); break; // SHL Vx
+        case 0xE: // SHL Vx
+          if (chip8->quirks & CHIP8_QUIRK_SHIFT_VY) inst_8XYE_vy(chip8, opcode);
+          else inst_8XYE(chip8, opcode);
+          break;
       }
       break;
     }
@@ -155,11 +504,13 @@ void chip8_cycle(Chip8* chip8) {
       break;
 
     case 0xB000:
-      inst_BNNN(chip8, opcode); // JP V0, addr
+      if (chip8->quirks & CHIP8_QUIRK_JUMP_VX) inst_BNNN_vx(chip8, opcode); // JP VX, addr
+      else inst_BNNN(chip8, opcode); // JP V0, addr
       break;
 
     case 0xD000:
-      inst_DXYN(chip8, opcode); // DRW Vx, Vy, nibble
+      if (chip8->quirks & CHIP8_QUIRK_CLIP) inst_DXYN_clip(chip8, opcode); // DRW Vx, Vy, nibble
+      else inst_DXYN(chip8, opcode);
       break;
 
     case 0xE000: {
@@ -183,8 +534,14 @@ void chip8_cycle(Chip8* chip8) {
         case 0x1E: inst_FX1E(chip8, opcode); break; // ADD I, Vx
         case 0x29: inst_FX29(chip8, opcode); break; // LD F, Vx
         case 0x33: inst_FX33(chip8, opcode); break; // LD B, Vx
-        case 0x55: inst_FX55(chip8, opcode); break; // LD [I], Vx
-        case 0x65: inst_FX65(chip8, opcode); break; // LD Vx, [I]
+        case 0x55: // LD [I], Vx
+          if (chip8->quirks & CHIP8_QUIRK_LOAD_STORE_I) inst_FX55_inc(chip8, opcode);
+          else inst_FX55(chip8, opcode);
+          break;
+        case 0x65: // LD Vx, [I]
+          if (chip8->quirks & CHIP8_QUIRK_LOAD_STORE_I) inst_FX65_inc(chip8, opcode);
+          else inst_FX65(chip8, opcode);
+          break;
       }
       break;
     }
@@ -193,4 +550,150 @@ void chip8_cycle(Chip8* chip8) {
       // Opcode desconhecido - ignora (alguns programas podem ter instruções não implementadas)
       break;
   }
-}
\ No newline at end of file
+
+#ifdef CHIP8_PROFILE
+  if (profile) {
+    chip8_profile_end(profile, chip8, profile_start);
+  }
+#endif
+#ifdef CHIP8_TRACE
+  if (trace) {
+    chip8_trace_record(trace, chip8, trace_pc, opcode, trace_v);
+  }
+#endif
+}
+
+void chip8_tick_timers(Chip8* chip8) {
+#ifdef CHIP8_TRACE
+  if (chip8_trace_active) {
+    chip8_trace_active->pending |= CHIP8_TRACE_TICK; // Marcado no próximo registro
+  }
+#endif
+  if (chip8->delay_timer > 0) {
+    chip8->delay_timer--;
+  }
+  if (chip8->sound_timer > 0) {
+    chip8->sound_timer--;
+  }
+}
+
+uint64_t chip8_display_hash(const Chip8* chip8) {
+  if (chip8->machine != CHIP8_MACHINE_CHIP8) {
+    return chip8_screen_hash(chip8);
+  }
+  // FNV-1a 64 bits aplicado a cada linha empacotada (uma palavra por passo)
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (int y = 0; y < CHIP8_HEIGHT; y++) {
+    hash ^= chip8->display[y];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+uint8_t chip8_get_pixel(const Chip8* chip8, int x, int y) {
+  x &= CHIP8_WIDTH - 1;
+  y &= CHIP8_HEIGHT - 1;
+  return (chip8->display[y] >> (63 - x)) & 1;
+}
+
+uint32_t chip8_take_dirty_rows(Chip8* chip8) {
+  uint32_t dirty = chip8->dirty_rows;
+  chip8->dirty_rows = 0;
+  return dirty;
+}
+
+void chip8_display_to_bytes(const Chip8* chip8, uint8_t out[CHIP8_WIDTH * CHIP8_HEIGHT]) {
+  for (int y = 0; y < CHIP8_HEIGHT; y++) {
+    uint64_t row = chip8->display[y];
+    for (int x = 0; x < CHIP8_WIDTH; x++) {
+      out[y * CHIP8_WIDTH + x] = (row >> (63 - x)) & 1;
+    }
+  }
+}
+
+void chip8_set_keys(Chip8* chip8, uint16_t keys) {
+  for (int i = 0; i < 16; i++) {
+    chip8->keypad[i] = (keys >> i) & 1;
+  }
+}
+
+uint16_t chip8_get_keys(const Chip8* chip8) {
+  uint16_t keys = 0;
+  for (int i = 0; i < 16; i++) {
+    keys |= (uint16_t)((chip8->keypad[i] ? 1 : 0) << i);
+  }
+  return keys;
+}
+
+static inline uint16_t opcode_at(const Chip8* chip8, uint16_t addr) {
+  return (uint16_t)((chip8->memory[addr] << 8) | chip8->memory[addr + 1]);
+}
+
+// Início do laço de espera do delay_timer que contém o PC, ou -1:
+//   L:   FX07       Vx = DT
+//   L+2: 3X00       pula se Vx == 0
+//   L+4: 1NNN (L)   volta
+// Com DT > 0 o laço só sai depois de um tick dos temporizadores
+static int timer_wait_loop(const Chip8* chip8) {
+  if (chip8->delay_timer == 0) {
+    return -1;
+  }
+  for (int phase = 0; phase < 3; phase++) {
+    int start = (int)chip8->pc - 2 * phase;
+    if (start < 0 || start > 4096 - 6) {
+      continue;
+    }
+    uint16_t read = opcode_at(chip8, (uint16_t)start);
+    uint16_t x = read & 0x0F00;
+    if ((read & 0xF0FF) == 0xF007 &&
+        opcode_at(chip8, (uint16_t)(start + 2)) == (0x3000 | x) &&
+        opcode_at(chip8, (uint16_t)(start + 4)) == (0x1000 | start)) {
+      // Parado no 3X00 com Vx == 0 (lido antes do último tick): o laço termina
+      if (phase == 1 && chip8->V[x >> 8] == 0) {
+        return -1;
+      }
+      return start;
+    }
+  }
+  return -1;
+}
+
+Chip8Idle chip8_idle(const Chip8* chip8) {
+  uint16_t pc = chip8->pc;
+  if (pc >= 4096 - 1) {
+    return CHIP8_IDLE_NONE;
+  }
+  uint16_t opcode = opcode_at(chip8, pc);
+  if (opcode == (0x1000 | pc) || (opcode == 0x00FD && chip8->machine != CHIP8_MACHINE_CHIP8)) {
+    return CHIP8_IDLE_HALT; // Salto para si mesmo ou EXIT do SUPER-CHIP
+  }
+  if ((opcode & 0xF0FF) == 0xF00A && chip8_get_keys(chip8) == 0) {
+    return CHIP8_IDLE_KEY_WAIT;
+  }
+  if (timer_wait_loop(chip8) >= 0) {
+    return CHIP8_IDLE_TIMER_WAIT;
+  }
+  return CHIP8_IDLE_NONE;
+}
+
+uint32_t chip8_skip_idle(Chip8* chip8, uint32_t cycles) {
+  switch (chip8_idle(chip8)) {
+    case CHIP8_IDLE_NONE:
+      return 0;
+    case CHIP8_IDLE_HALT:
+    case CHIP8_IDLE_KEY_WAIT:
+      break; // Cada ciclo deixa o estado como estava
+    case CHIP8_IDLE_TIMER_WAIT: {
+      // Período de 3 ciclos: só a posição no laço e Vx (= DT, após o primeiro FX07) mudam
+      int start = timer_wait_loop(chip8);
+      uint32_t phase = (uint32_t)(chip8->pc - start) / 2;
+      if (cycles >= (phase == 0 ? 1u : 4u - phase)) {
+        chip8->V[chip8->memory[start] & 0x0F] = chip8->delay_timer;
+      }
+      chip8->pc = (uint16_t)(start + 2 * ((phase + cycles) % 3));
+      break;
+    }
+  }
+  chip8->idle_cycles += cycles;
+  return cycles;
+}
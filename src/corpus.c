@@ -0,0 +1,433 @@
+#define _POSIX_C_SOURCE 200809L // clock_gettime, opendir, sysconf
+
+#include <dirent.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include "chip8.h"
+#include "machine.h"
+
+// Executa todas as ROMs .ch8 de um diretório em paralelo (sem SDL) e gera
+// um relatório JSON ou CSV com velocidade, hash final do framebuffer, estado
+// de término e acessos fora da memória de cada ROM.
+//
+// Cada thread tem a própria fila de ROMs; quando a sua acaba, rouba trabalho
+// do fim da fila de outra thread (ROMs que param cedo liberam a thread para
+// ajudar nas demais).
+
+#define CYCLES_PER_FRAME 10   // Mesmo valor do main.c: temporizadores a cada 10 ciclos
+#define DEFAULT_FRAMES   3600 // 1 minuto emulado a 60 FPS
+#define MAX_THREADS      256
+
+typedef enum {
+  STATUS_OK,        // Executou todos os frames
+  STATUS_HALT,      // Parou em um salto para si mesmo (1NNN para o próprio endereço)
+  STATUS_KEY_WAIT,  // Parado em FX0A esperando tecla (nenhuma tecla é pressionada)
+  STATUS_LOOP,      // Estado completo idêntico entre frames: laço infinito sem efeito
+  STATUS_LOAD_ERROR // Não foi possível carregar a ROM
+} RomStatus;
+
+static const char* const status_names[] = {"ok", "halt", "key_wait", "loop", "load_error"};
+
+typedef struct {
+  char* path;
+  RomStatus status;
+  const char* error;          // Mensagem de chip8_load_error (apenas STATUS_LOAD_ERROR)
+  unsigned long long frames;  // Frames executados (menos que o pedido se parou antes)
+  unsigned long long cycles;
+  double seconds;
+  uint64_t hash;
+  uint32_t oob_accesses;
+} RomResult;
+
+typedef struct { // Fila de uma thread: a dona consome do início, ladrões do fim
+  pthread_mutex_t lock;
+  int head;
+  int tail;                   // exclusivo
+} WorkQueue;
+
+typedef struct {
+  RomResult* results;
+  int count;
+  unsigned long long frames;
+  int nthreads;
+  WorkQueue queues[MAX_THREADS];
+} Corpus;
+
+typedef struct {
+  Corpus* corpus;
+  int id;
+} WorkerArg;
+
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Estado observável entre frames (sem a memória, comparada à parte só quando isto coincide)
+typedef struct {
+  uint8_t V[16];
+  uint16_t I, pc;
+  uint16_t stack[16];
+  uint8_t sp, delay_timer, sound_timer;
+  uint64_t display[CHIP8_HEIGHT];
+} Snapshot;
+
+static void take_snapshot(const Chip8* c, Snapshot* s) {
+  memset(s, 0, sizeof(*s)); // Zera o padding para o memcmp
+  memcpy(s->V, c->V, sizeof(s->V));
+  s->I = c->I;
+  s->pc = c->pc;
+  memcpy(s->stack, c->stack, sizeof(s->stack));
+  s->sp = c->sp;
+  s->delay_timer = c->delay_timer;
+  s->sound_timer = c->sound_timer;
+  memcpy(s->display, c->display, sizeof(s->display));
+}
+
+static void run_rom(RomResult* r, unsigned long long frames) {
+  Chip8 chip8;
+  static _Thread_local uint8_t memory[4096]; // Memória do frame anterior (detecção de laço)
+  Snapshot prev, cur;
+  int have_prev = 0, have_memory = 0;
+
+  chip8_init(&chip8);
+  int rom_result = chip8_load_rom(&chip8, r->path);
+  if (rom_result != 0) {
+    r->status = STATUS_LOAD_ERROR;
+    r->error = chip8_load_error(rom_result);
+    chip8_release(&chip8);
+    return;
+  }
+
+  r->status = STATUS_OK;
+  double start = now_seconds();
+  unsigned long long f;
+  for (f = 0; f < frames; f++) {
+    chip8_run(&chip8, CYCLES_PER_FRAME);
+    chip8_tick_timers(&chip8);
+
+    // Sem entradas, estado completo igual ao do frame anterior = ponto fixo: nada mais muda
+    take_snapshot(&chip8, &cur);
+    if (have_prev && memcmp(&cur, &prev, sizeof(cur)) == 0) {
+      if (have_memory && memcmp(memory, chip8.memory, sizeof(memory)) == 0) {
+        Chip8Idle idle = chip8_idle(&chip8);
+        if (idle == CHIP8_IDLE_HALT) {
+          r->status = STATUS_HALT;
+        } else if (idle == CHIP8_IDLE_KEY_WAIT) {
+          r->status = STATUS_KEY_WAIT;
+        } else {
+          r->status = STATUS_LOOP;
+        }
+        f++;
+        break;
+      }
+      memcpy(memory, chip8.memory, sizeof(memory));
+      have_memory = 1;
+    } else {
+      have_memory = 0;
+    }
+    prev = cur;
+    have_prev = 1;
+  }
+  r->seconds = now_seconds() - start;
+  r->frames = f;
+  r->cycles = f * CYCLES_PER_FRAME;
+  r->hash = chip8_display_hash(&chip8);
+  r->oob_accesses = chip8.oob_accesses;
+  chip8_release(&chip8);
+}
+
+// Próxima ROM da própria fila ou, se vazia, roubada do fim de outra fila
+static int next_job(Corpus* c, int id) {
+  WorkQueue* own = &c->queues[id];
+  pthread_mutex_lock(&own->lock);
+  if (own->head < own->tail) {
+    int job = own->head++;
+    pthread_mutex_unlock(&own->lock);
+    return job;
+  }
+  pthread_mutex_unlock(&own->lock);
+
+  for (int k = 1; k < c->nthreads; k++) {
+    WorkQueue* victim = &c->queues[(id + k) % c->nthreads];
+    pthread_mutex_lock(&victim->lock);
+    if (victim->head < victim->tail) {
+      int job = --victim->tail;
+      pthread_mutex_unlock(&victim->lock);
+      return job;
+    }
+    pthread_mutex_unlock(&victim->lock);
+  }
+  return -1;
+}
+
+static void* worker_main(void* p) {
+  WorkerArg* arg = p;
+  int job;
+  while ((job = next_job(arg->corpus, arg->id)) >= 0) {
+    run_rom(&arg->corpus->results[job], arg->corpus->frames);
+  }
+  return NULL;
+}
+
+static int has_ch8_suffix(const char* name) {
+  size_t len = strlen(name);
+  return len > 4 && strcasecmp(name + len - 4, ".ch8") == 0;
+}
+
+static int compare_results(const void* a, const void* b) {
+  return strcmp(((const RomResult*)a)->path, ((const RomResult*)b)->path);
+}
+
+// Lista as ROMs do diretório (em ordem alfabética, para relatórios estáveis)
+static RomResult* find_roms(const char* dir, int* count) {
+  DIR* d = opendir(dir);
+  if (!d) {
+    return NULL;
+  }
+
+  RomResult* results = NULL;
+  int n = 0, cap = 0;
+  struct dirent* ent;
+  while ((ent = readdir(d)) != NULL) {
+    if (!has_ch8_suffix(ent->d_name)) {
+      continue;
+    }
+    if (n == cap) {
+      cap = cap ? cap * 2 : 64;
+      RomResult* grown = realloc(results, sizeof(RomResult) * (size_t)cap);
+      if (!grown) {
+        break;
+      }
+      results = grown;
+    }
+    size_t len = strlen(dir) + strlen(ent->d_name) + 2;
+    char* path = malloc(len);
+    if (!path) {
+      break;
+    }
+    snprintf(path, len, "%s/%s", dir, ent->d_name);
+    memset(&results[n], 0, sizeof(RomResult));
+    results[n++].path = path;
+  }
+  closedir(d);
+
+  if (n > 1) {
+    qsort(results, (size_t)n, sizeof(RomResult), compare_results);
+  }
+  *count = n;
+  return results ? results : calloc(1, sizeof(RomResult));
+}
+
+static void json_string(FILE* out, const char* s) {
+  fputc('"', out);
+  for (; *s; s++) {
+    unsigned char ch = (unsigned char)*s;
+    if (ch == '"' || ch == '\\') {
+      fprintf(out, "\\%c", ch);
+    } else if (ch < 0x20) {
+      fprintf(out, "\\u%04x", ch);
+    } else {
+      fputc(ch, out);
+    }
+  }
+  fputc('"', out);
+}
+
+static void csv_string(FILE* out, const char* s) {
+  fputc('"', out);
+  for (; *s; s++) {
+    if (*s == '"') {
+      fputc('"', out);
+    }
+    fputc(*s, out);
+  }
+  fputc('"', out);
+}
+
+static double cycles_per_sec(const RomResult* r) {
+  return r->seconds > 0 ? (double)r->cycles / r->seconds : 0.0;
+}
+
+static void write_json(FILE* out, const RomResult* results, int count, unsigned long long frames,
+                       int threads, double wall) {
+  fprintf(out, "{\n  \"frames\": %llu,\n  \"cycles_per_frame\": %d,\n  \"threads\": %d,\n"
+               "  \"wall_seconds\": %.6f,\n  \"roms\": [\n",
+          frames, CYCLES_PER_FRAME, threads, wall);
+  for (int i = 0; i < count; i++) {
+    const RomResult* r = &results[i];
+    fprintf(out, "    {\"rom\": ");
+    json_string(out, r->path);
+    fprintf(out, ", \"status\": \"%s\"", status_names[r->status]);
+    if (r->status == STATUS_LOAD_ERROR) {
+      fprintf(out, ", \"error\": ");
+      json_string(out, r->error);
+    } else {
+      fprintf(out, ", \"frames\": %llu, \"cycles\": %llu, \"seconds\": %.6f, \"cycles_per_sec\": %.0f"
+                   ", \"hash\": \"0x%016llx\", \"oob_accesses\": %u",
+              r->frames, r->cycles, r->seconds, cycles_per_sec(r),
+              (unsigned long long)r->hash, r->oob_accesses);
+    }
+    fprintf(out, "}%s\n", i + 1 < count ? "," : "");
+  }
+  fprintf(out, "  ]\n}\n");
+}
+
+static void write_csv(FILE* out, const RomResult* results, int count) {
+  fprintf(out, "rom,status,frames,cycles,seconds,cycles_per_sec,hash,oob_accesses,error\n");
+  for (int i = 0; i < count; i++) {
+    const RomResult* r = &results[i];
+    csv_string(out, r->path);
+    fprintf(out, ",%s,%llu,%llu,%.6f,%.0f,0x%016llx,%u,", status_names[r->status],
+            r->frames, r->cycles, r->seconds, cycles_per_sec(r),
+            (unsigned long long)r->hash, r->oob_accesses);
+    if (r->error) {
+      csv_string(out, r->error);
+    }
+    fputc('\n', out);
+  }
+}
+
+static void usage(const char* prog) {
+  printf("Uso: %s [diretorio] [-f frames] [-t threads] [-o arquivo] [--csv]\n", prog);
+  printf("  diretorio  onde procurar arquivos .ch8 (padrão: games)\n");
+  printf("  -f N       frames de %d ciclos por ROM (padrão: %d)\n", CYCLES_PER_FRAME, DEFAULT_FRAMES);
+  printf("  -t N       threads (padrão: processadores online)\n");
+  printf("  -o ARQ     grava o relatório em ARQ (padrão: saída padrão); .csv implica --csv\n");
+  printf("  --csv      relatório em CSV em vez de JSON\n");
+}
+
+int main(int argc, char* argv[]) {
+  const char* dir = NULL;
+  const char* out_path = NULL;
+  unsigned long long frames = DEFAULT_FRAMES;
+  int threads = 0;
+  int csv = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+      frames = strtoull(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      threads = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      out_path = argv[++i];
+    } else if (strcmp(argv[i], "--csv") == 0) {
+      csv = 1;
+    } else if (argv[i][0] != '-' && !dir) {
+      dir = argv[i];
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (!dir) {
+    dir = "games";
+  }
+  if (out_path) {
+    size_t len = strlen(out_path);
+    if (len > 4 && strcasecmp(out_path + len - 4, ".csv") == 0) {
+      csv = 1;
+    }
+  }
+
+  int count = 0;
+  RomResult* results = find_roms(dir, &count);
+  if (!results) {
+    printf("Erro: não foi possível abrir o diretório: %s\n", dir);
+    return 1;
+  }
+
+  if (threads <= 0) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = online > 0 ? (int)online : 1;
+  }
+  if (threads > MAX_THREADS) {
+    threads = MAX_THREADS;
+  }
+  if (count > 0 && threads > count) {
+    threads = count;
+  }
+
+  Corpus* corpus = calloc(1, sizeof(Corpus));
+  if (!corpus) {
+    printf("Erro: sem memória\n");
+    return 1;
+  }
+  corpus->results = results;
+  corpus->count = count;
+  corpus->frames = frames;
+  corpus->nthreads = threads;
+
+  // Distribuição inicial: faixas contíguas, uma por thread
+  for (int t = 0; t < threads; t++) {
+    pthread_mutex_init(&corpus->queues[t].lock, NULL);
+    corpus->queues[t].head = (int)((long long)count * t / threads);
+    corpus->queues[t].tail = (int)((long long)count * (t + 1) / threads);
+  }
+
+  pthread_t tids[MAX_THREADS];
+  WorkerArg args[MAX_THREADS];
+  int started = 1;
+  double start = now_seconds();
+  for (int t = 1; t < threads; t++) {
+    args[t].corpus = corpus;
+    args[t].id = t;
+    if (pthread_create(&tids[t], NULL, worker_main, &args[t]) != 0) {
+      break; // A fila dessa thread é roubada pelas que existem
+    }
+    started++;
+  }
+  args[0].corpus = corpus;
+  args[0].id = 0;
+  worker_main(&args[0]);
+  for (int t = 1; t < started; t++) {
+    pthread_join(tids[t], NULL);
+  }
+  double wall = now_seconds() - start;
+
+  FILE* out = stdout;
+  if (out_path) {
+    out = fopen(out_path, "w");
+    if (!out) {
+      printf("Erro: não foi possível criar o relatório: %s\n", out_path);
+      return 1;
+    }
+  }
+  if (csv) {
+    write_csv(out, results, count);
+  } else {
+    write_json(out, results, count, frames, threads, wall);
+  }
+  if (out != stdout) {
+    fclose(out);
+  }
+
+  // Resumo no stderr (não mistura com o relatório na saída padrão)
+  unsigned long long total_cycles = 0;
+  int by_status[STATUS_LOAD_ERROR + 1] = {0};
+  for (int i = 0; i < count; i++) {
+    total_cycles += results[i].cycles;
+    by_status[results[i].status]++;
+  }
+  fprintf(stderr, "%d ROMs em %.3f s com %d threads (%llu ciclos):", count, wall, threads, total_cycles);
+  for (int s = 0; s <= STATUS_LOAD_ERROR; s++) {
+    fprintf(stderr, " %s=%d", status_names[s], by_status[s]);
+  }
+  fputc('\n', stderr);
+
+  for (int t = 0; t < threads; t++) {
+    pthread_mutex_destroy(&corpus->queues[t].lock);
+  }
+  for (int i = 0; i < count; i++) {
+    free(results[i].path);
+  }
+  free(results);
+  free(corpus);
+  return 0;
+}
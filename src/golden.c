@@ -0,0 +1,538 @@
+#define _POSIX_C_SOURCE 200809L // clock_gettime, opendir
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "capture.h"
+#include "chip8.h"
+#include "jit.h"
+#include "machine.h"
+#include "movie.h"
+#include "sched.h"
+
+// Regressão por hashes de frame: cada ROM de um diretório é reproduzida com um
+// roteiro de entradas gravado (um movie, golden/<rom>.c8m) e o hash do
+// framebuffer de cada frame emulado é comparado com a sequência guardada em
+// golden/<rom>.golden. Sem janela nem capturas de tela: milhares de frames por
+// ROM em milissegundos.
+//
+// O hash é o de chip8_display_hash (FNV-1a sobre as linhas empacotadas, uma
+// palavra por passo), recalculado só nos frames em que display_gen mudou.
+// O arquivo .golden é texto: um cabeçalho e a sequência em runs ("hash
+// repetições"), já que a tela fica parada na maior parte dos frames.
+//
+// Com --update, as sequências são regravadas; ROMs sem movie ganham um, com
+// teclas pseudoaleatórias (uma tecla ou nenhuma a cada 8 frames). Um movie
+// gravado à mão no chip8 (--record) pode ser colocado no lugar antes.
+//
+// Com --gif, cada replay também é capturado em GIF (chip8_capture, escala 1) e
+// o arquivo é decodificado de volta com um LZW estrito: todo quadro precisa
+// terminar no código END com exatamente os pixels do retângulo, e a tela
+// montada no fim precisa ser o display final da ROM.
+
+#define GOLDEN_MAGIC    "chip8-golden 1"
+#define DEFAULT_FRAMES  3600 // 1 minuto emulado por ROM nos movies gerados
+#define MAX_ROMS        1024
+#define LZW_MAX_CODES   4096
+
+typedef enum {
+  CORE_RUN,       // chip8_run (pré-decodificado)
+  CORE_REFERENCE, // chip8_cycle
+  CORE_JIT        // chip8_jit_run
+} Core;
+
+typedef struct {
+  uint64_t* hashes;           // Um por frame
+  uint32_t frames;
+  uint64_t digest;            // Hash da sequência inteira (FNV-1a dos hashes)
+} FrameHashes;
+
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Teclas dos movies gerados: uma tecla (ou nenhuma) por 8 frames, escolhida por um hash (splitmix64) do frame
+static uint16_t seeded_keys(uint64_t frame) {
+  uint64_t h = (frame / 8) + 0x9E3779B97F4A7C15ULL;
+  h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+  h ^= h >> 31;
+  uint32_t key = (uint32_t)(h % 20);
+  return key < 16 ? (uint16_t)(1u << key) : 0;
+}
+
+static int has_ch8_suffix(const char* name) {
+  size_t len = strlen(name);
+  return len > 4 && strcasecmp(name + len - 4, ".ch8") == 0;
+}
+
+static int compare_names(const void* a, const void* b) {
+  return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+// Decodifica um quadro LZW do GIF em out; 0, ou -1 se os dados acabam antes do END,
+// aparece um código que o dicionário não tem ou o total de pixels não é `pixels`
+static int lzw_decode(const uint8_t* data, size_t len, int min_size, uint8_t* out, size_t pixels) {
+  static uint16_t prefix[LZW_MAX_CODES], length[LZW_MAX_CODES];
+  static uint8_t suffix[LZW_MAX_CODES], first[LZW_MAX_CODES];
+  unsigned clear = 1u << min_size, end = clear + 1;
+  for (unsigned c = 0; c < clear; c++) {
+    suffix[c] = first[c] = (uint8_t)c;
+    length[c] = 1;
+  }
+  unsigned next = end + 1, size = (unsigned)min_size + 1, prev = LZW_MAX_CODES;
+  size_t bit = 0, n = 0;
+  for (;;) {
+    if (bit + size > len * 8) {
+      return -1;
+    }
+    unsigned code = 0;
+    for (unsigned i = 0; i < size; i++, bit++) {
+      code |= (unsigned)(data[bit >> 3] >> (bit & 7) & 1) << i;
+    }
+    if (code == clear) {
+      next = end + 1;
+      size = (unsigned)min_size + 1;
+      prev = LZW_MAX_CODES;
+      continue;
+    }
+    if (code == end) {
+      return n == pixels ? 0 : -1;
+    }
+    if (prev == LZW_MAX_CODES) {
+      if (code >= clear) {
+        return -1;
+      }
+    } else {
+      if (code > next || (code == next && next == LZW_MAX_CODES)) {
+        return -1;
+      }
+      // Entrada nova: a sequência anterior mais o primeiro pixel da atual
+      if (next < LZW_MAX_CODES) {
+        prefix[next] = (uint16_t)prev;
+        first[next] = first[prev];
+        suffix[next] = code < next ? first[code] : first[prev];
+        length[next] = (uint16_t)(length[prev] + 1);
+        next++;
+        if (next == 1u << size && size < 12) {
+          size++;
+        }
+      }
+    }
+    if (n + length[code] > pixels) {
+      return -1;
+    }
+    unsigned k = code;
+    for (size_t i = length[code]; i-- > 0; k = prefix[k]) {
+      out[n + i] = suffix[k];
+    }
+    n += length[code];
+    prev = code;
+  }
+}
+
+// Lê o GIF de chip8_capture (escala 1), monta os quadros na tela e compara com o
+// display de c; 0 se tudo decodifica e confere, -1 caso contrário
+static int gif_check(const char* path, const Chip8* c) {
+  FILE* in = fopen(path, "rb");
+  if (!in) {
+    return -1;
+  }
+  uint8_t* gif = NULL;
+  long size = fseek(in, 0, SEEK_END) == 0 ? ftell(in) : -1;
+  if (size > 0 && fseek(in, 0, SEEK_SET) == 0 && (gif = malloc((size_t)size)) != NULL &&
+      fread(gif, 1, (size_t)size, in) != (size_t)size) {
+    free(gif);
+    gif = NULL;
+  }
+  fclose(in);
+  if (!gif) {
+    return -1;
+  }
+
+  static uint8_t canvas[CHIP8_HIRES_WIDTH * CHIP8_HIRES_HEIGHT], image[CHIP8_HIRES_WIDTH * CHIP8_HIRES_HEIGHT];
+  uint8_t* data = malloc((size_t)size);
+  size_t n = (size_t)size, p = 13;
+  int w = n > 10 ? gif[6] | gif[7] << 8 : 0, h = n > 10 ? gif[8] | gif[9] << 8 : 0;
+  int ok = data && n > 13 && memcmp(gif, "GIF89a", 6) == 0 && w * h <= (int)sizeof(canvas) && w > 0 && h > 0;
+  if (ok && (gif[10] & 0x80)) {
+    p += 3u << ((gif[10] & 7) + 1);
+  }
+  memset(canvas, 0, sizeof(canvas));
+  while (ok && p < n && gif[p] != 0x3B) {
+    if (gif[p] == 0x21) { // Extensão: só os sub-blocos são pulados
+      for (p += 2; p < n && gif[p]; p += gif[p] + 1u) {
+      }
+      p++;
+      continue;
+    }
+    if (gif[p] != 0x2C || p + 11 > n || (gif[p + 9] & 0x80)) {
+      ok = 0;
+      break;
+    }
+    int x0 = gif[p + 1] | gif[p + 2] << 8, y0 = gif[p + 3] | gif[p + 4] << 8;
+    int fw = gif[p + 5] | gif[p + 6] << 8, fh = gif[p + 7] | gif[p + 8] << 8;
+    int min_size = gif[p + 10];
+    size_t len = 0;
+    for (p += 11; p < n && gif[p]; p += gif[p] + 1u) {
+      if (p + 1 + gif[p] > n) {
+        break;
+      }
+      memcpy(data + len, gif + p + 1, gif[p]);
+      len += gif[p];
+    }
+    p++;
+    ok = p <= n && x0 + fw <= w && y0 + fh <= h && min_size >= 2 && min_size < 12 &&
+         lzw_decode(data, len, min_size, image, (size_t)fw * fh) == 0;
+    for (int y = 0; ok && y < fh; y++) {
+      memcpy(&canvas[(y0 + y) * w + x0], &image[y * fw], (size_t)fw);
+    }
+  }
+  ok = ok && p < n;
+
+  // Nas máquinas estendidas o vídeo tem sempre 128x64: o lores ocupa 2x2
+  int shift = c->machine != CHIP8_MACHINE_CHIP8 && !c->hires ? 1 : 0;
+  int extended = c->machine != CHIP8_MACHINE_CHIP8;
+  ok = ok && w == (extended ? CHIP8_HIRES_WIDTH : CHIP8_WIDTH) && h == (extended ? CHIP8_HIRES_HEIGHT : CHIP8_HEIGHT);
+  for (int y = 0; ok && y < h; y++) {
+    for (int x = 0; ok && x < w; x++) {
+      ok = canvas[y * w + x] == chip8_screen_pixel(c, x >> shift, y >> shift);
+    }
+  }
+  free(data);
+  free(gif);
+  return ok ? 0 : -1;
+}
+
+// Reproduz o movie e guarda o hash do framebuffer após cada frame (tick de 60 Hz).
+// Retorna 0, ou -1 com a mensagem em error
+static int replay(const char* rom_path, const Chip8Movie* movie, Core core, Chip8Jit* jit, const char* gif_path,
+                  FrameHashes* out, const char** error) {
+  static Chip8 chip8; // Reaproveitado entre os movies
+  chip8_release(&chip8); // Extensão e cache do movie anterior
+  chip8_init(&chip8);
+  int load = chip8_set_machine(&chip8, (Chip8Machine)movie->machine) != 0 ? -4 : chip8_load_rom(&chip8, rom_path);
+  if (load != 0) {
+    *error = chip8_load_error(load);
+    return -1;
+  }
+  chip8.quirks = movie->quirks;
+  if (movie->vip_costs && core != CORE_RUN) {
+    *error = "o movie usa custos do VIP, que exigem o núcleo pré-decodificado";
+    return -1;
+  }
+  out->hashes = malloc(sizeof(uint64_t) * (movie->frames ? movie->frames : 1));
+  if (!out->hashes) {
+    *error = "sem memória para os hashes";
+    return -1;
+  }
+  out->frames = movie->frames;
+  out->digest = 0xcbf29ce484222325ULL;
+  if (jit) {
+    chip8_jit_flush(jit);
+  }
+  Chip8Capture* capture = NULL;
+  if (gif_path) {
+    static const Chip8CapturePalette colors = {{0, 0, 0}, {255, 255, 255}, {255, 0, 0}, {0, 0, 255}};
+    capture = chip8_capture_open(gif_path, (Chip8Machine)movie->machine, 1, colors);
+    if (!capture) {
+      *error = "não foi possível criar o GIF";
+      return -1;
+    }
+    chip8_capture_push(capture, &chip8, 0);
+  }
+
+  Chip8Sched sched;
+  chip8_sched_init(&sched, movie->clock_hz, movie->vip_costs);
+  uint32_t gen = chip8.display_gen - 1; // Força o primeiro hash
+  uint64_t hash = 0;
+  for (uint32_t f = 0; f < movie->frames; f++) {
+    chip8_set_keys(&chip8, movie->keys[f]);
+    uint64_t n = chip8_sched_until_tick(&sched);
+    if (core == CORE_RUN) {
+      chip8_sched_run(&sched, &chip8, n);
+    } else {
+      if (core == CORE_JIT) {
+        chip8_jit_run(jit, &chip8, (uint32_t)n);
+      } else {
+        for (uint64_t i = 0; i < n; i++) {
+          chip8_cycle(&chip8);
+        }
+      }
+      chip8_sched_step(&sched, &chip8, n);
+    }
+    // Frames sem mudança no display (a maioria) reaproveitam o hash anterior
+    if (chip8.display_gen != gen) {
+      gen = chip8.display_gen;
+      hash = chip8_display_hash(&chip8);
+      if (capture) {
+        chip8_capture_wait(capture);
+        chip8_capture_push(capture, &chip8, f + 1);
+      }
+    }
+    out->hashes[f] = hash;
+    out->digest = (out->digest ^ hash) * 0x100000001b3ULL;
+  }
+  if (capture) {
+    if (chip8_capture_close(capture, movie->frames) != 0) {
+      *error = "falha ao gravar o GIF";
+      return -1;
+    }
+    if (gif_check(gif_path, &chip8) != 0) {
+      *error = "o GIF capturado não decodifica de volta no display final";
+      return -1;
+    }
+  }
+  return 0;
+}
+
+static int write_golden(const char* path, const Chip8Movie* movie, const FrameHashes* h) {
+  FILE* out = fopen(path, "w");
+  if (!out) {
+    return -1;
+  }
+  fprintf(out, "%s\n", GOLDEN_MAGIC);
+  fprintf(out, "rom 0x%016llx\n", (unsigned long long)movie->rom_hash);
+  fprintf(out, "frames %u\n", h->frames);
+  fprintf(out, "digest 0x%016llx\n", (unsigned long long)h->digest);
+  for (uint32_t f = 0; f < h->frames;) {
+    uint32_t run = 1;
+    while (f + run < h->frames && h->hashes[f + run] == h->hashes[f]) run++;
+    fprintf(out, "%016llx %u\n", (unsigned long long)h->hashes[f], run);
+    f += run;
+  }
+  return fclose(out) == 0 ? 0 : -1;
+}
+
+// Lê a sequência guardada; retorna 0, ou -1 se o arquivo não existe ou é inválido
+static int read_golden(const char* path, uint64_t rom_hash, FrameHashes* h) {
+  FILE* in = fopen(path, "r");
+  if (!in) {
+    return -1;
+  }
+  char line[128];
+  unsigned long long rom = 0, digest = 0;
+  unsigned frames = 0;
+  int ok = fgets(line, sizeof(line), in) && strncmp(line, GOLDEN_MAGIC, strlen(GOLDEN_MAGIC)) == 0 &&
+           fscanf(in, " rom %llx", &rom) == 1 && fscanf(in, " frames %u", &frames) == 1 &&
+           fscanf(in, " digest %llx", &digest) == 1 && rom == rom_hash;
+  h->hashes = ok ? malloc(sizeof(uint64_t) * (frames ? frames : 1)) : NULL;
+  h->frames = 0;
+  h->digest = digest;
+  if (h->hashes) {
+    unsigned long long hash;
+    unsigned run;
+    while (h->frames < frames && fscanf(in, " %llx %u", &hash, &run) == 2 && run <= frames - h->frames) {
+      for (; run > 0; run--) h->hashes[h->frames++] = hash;
+    }
+  }
+  fclose(in);
+  if (!h->hashes || h->frames != frames) {
+    free(h->hashes);
+    h->hashes = NULL;
+    return -1;
+  }
+  return 0;
+}
+
+// Movie da ROM: o gravado, ou (com update) um novo com teclas pseudoaleatórias.
+// Retorna 0, 1 se não há movie (sem update) ou -1 em erro
+static int rom_movie(const char* rom_path, const char* movie_path, int update, uint32_t frames, uint64_t rom_hash,
+                     Chip8Movie* movie, const char** error) {
+  int result = chip8_movie_load(movie, movie_path);
+  if (result == 0) {
+    if (movie->rom_hash != rom_hash) {
+      chip8_movie_free(movie);
+      *error = "o movie foi gravado com outra ROM";
+      return -1;
+    }
+    return 0;
+  }
+  if (result != -1) {
+    *error = chip8_movie_error(result);
+    return -1;
+  }
+  if (!update) {
+    return 1;
+  }
+
+  static Chip8 probe; // Quirks da ROM pelo banco de dados
+  chip8_release(&probe);
+  chip8_init(&probe);
+  if (chip8_load_rom(&probe, rom_path) != 0) {
+    *error = "não foi possível carregar a ROM";
+    return -1;
+  }
+  chip8_movie_init(movie, rom_hash, CHIP8_DEFAULT_CLOCK_HZ, 0);
+  movie->quirks = probe.quirks;
+  for (uint32_t f = 0; f < frames; f++) {
+    if (chip8_movie_append(movie, seeded_keys(f)) != 0) {
+      chip8_movie_free(movie);
+      *error = "sem memória para o movie";
+      return -1;
+    }
+  }
+  result = chip8_movie_save(movie, movie_path);
+  if (result != 0) {
+    chip8_movie_free(movie);
+    *error = chip8_movie_error(result);
+    return -1;
+  }
+  return 0;
+}
+
+static void usage(const char* prog) {
+  printf("Uso: %s [diretorio] [--golden dir] [--update] [-f frames] [-r | -j] [--gif F]\n", prog);
+  printf("  diretorio     ROMs .ch8 (padrão: games)\n");
+  printf("  --golden DIR  movies (.c8m) e sequências de hashes (.golden) (padrão: golden)\n");
+  printf("  --update      regrava as sequências; ROMs sem movie ganham um com teclas pseudoaleatórias\n");
+  printf("  -f N          frames dos movies gerados por --update (padrão: %d)\n", DEFAULT_FRAMES);
+  printf("  -r            usa o interpretador de referência (chip8_cycle)\n");
+  printf("  -j            usa o recompilador dinâmico (x86-64)\n");
+  printf("  --gif F       captura cada replay em F e confere se o GIF decodifica de volta no display final\n");
+  printf("Código de saída: 0 se todas as sequências conferem, 2 se alguma divergir ou faltar, 1 em erro\n");
+}
+
+int main(int argc, char* argv[]) {
+  const char* dir = "games";
+  const char* golden_dir = "golden";
+  const char* gif_path = NULL;
+  int update = 0;
+  long frames = DEFAULT_FRAMES;
+  Core core = CORE_RUN;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+      golden_dir = argv[++i];
+    } else if (strcmp(argv[i], "--gif") == 0 && i + 1 < argc) {
+      gif_path = argv[++i];
+    } else if (strcmp(argv[i], "--update") == 0) {
+      update = 1;
+    } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+      frames = atol(argv[++i]);
+      if (frames <= 0) {
+        usage(argv[0]);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "-r") == 0) {
+      core = CORE_REFERENCE;
+    } else if (strcmp(argv[i], "-j") == 0) {
+      core = CORE_JIT;
+    } else if (argv[i][0] != '-') {
+      dir = argv[i];
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  DIR* d = opendir(dir);
+  if (!d) {
+    printf("Erro: diretório de ROMs não encontrado: %s\n", dir);
+    return 1;
+  }
+  char* names[MAX_ROMS];
+  int n = 0;
+  struct dirent* ent;
+  while ((ent = readdir(d)) != NULL && n < MAX_ROMS) {
+    if (has_ch8_suffix(ent->d_name) && (names[n] = strdup(ent->d_name)) != NULL) {
+      n++;
+    }
+  }
+  closedir(d);
+  qsort(names, (size_t)n, sizeof(char*), compare_names);
+
+  struct stat st;
+  if (update && mkdir(golden_dir, 0755) != 0 && (stat(golden_dir, &st) != 0 || !S_ISDIR(st.st_mode))) {
+    printf("Erro: não foi possível criar %s\n", golden_dir);
+    return 1;
+  }
+
+  Chip8Jit* jit = NULL;
+  if (core == CORE_JIT && !(jit = chip8_jit_create())) {
+    printf("Erro: sem memória para o JIT\n");
+    return 1;
+  }
+
+  int passed = 0, failed = 0, missing = 0, errors = 0;
+  unsigned long long total_frames = 0;
+  double start = now_seconds();
+  for (int i = 0; i < n; i++) {
+    char rom_path[4096], movie_path[4096], golden_path[4096];
+    size_t base = strlen(names[i]) - 4; // Sem o .ch8
+    snprintf(rom_path, sizeof(rom_path), "%s/%s", dir, names[i]);
+    snprintf(movie_path, sizeof(movie_path), "%s/%.*s.c8m", golden_dir, (int)base, names[i]);
+    snprintf(golden_path, sizeof(golden_path), "%s/%.*s.golden", golden_dir, (int)base, names[i]);
+
+    const char* error = NULL;
+    uint64_t rom_hash;
+    Chip8Movie movie;
+    FrameHashes got = {NULL, 0, 0}, want = {NULL, 0, 0};
+    int result = chip8_rom_file_hash(rom_path, &rom_hash) == 0 ? 0 : -1;
+    if (result != 0) {
+      error = "não foi possível ler a ROM";
+    } else {
+      result = rom_movie(rom_path, movie_path, update, (uint32_t)frames, rom_hash, &movie, &error);
+    }
+    if (result == 1) {
+      printf("sem golden  %s\n", names[i]);
+      missing++;
+    } else if (result == 0) {
+      result = replay(rom_path, &movie, core, jit, gif_path, &got, &error);
+      chip8_movie_free(&movie);
+    }
+
+    if (result < 0) {
+      printf("ERRO        %s: %s\n", names[i], error);
+      errors++;
+    } else if (result == 0 && update) {
+      if (write_golden(golden_path, &movie, &got) != 0) {
+        printf("ERRO        %s: não foi possível gravar %s\n", names[i], golden_path);
+        errors++;
+      } else {
+        printf("gravado     %s (%u frames, 0x%016llx)\n", names[i], got.frames, (unsigned long long)got.digest);
+        passed++;
+      }
+    } else if (result == 0 && read_golden(golden_path, rom_hash, &want) != 0) {
+      printf("sem golden  %s (movie sem %s válido para esta ROM)\n", names[i], golden_path);
+      missing++;
+    } else if (result == 0) {
+      uint32_t f = 0;
+      while (f < got.frames && f < want.frames && got.hashes[f] == want.hashes[f]) f++;
+      if (f < got.frames || got.frames != want.frames) {
+        if (f < got.frames && f < want.frames) {
+          printf("DIVERGE     %s: frame %u (esperado 0x%016llx, obtido 0x%016llx)\n", names[i], f,
+                 (unsigned long long)want.hashes[f], (unsigned long long)got.hashes[f]);
+        } else {
+          printf("DIVERGE     %s: %u frames (esperados %u)\n", names[i], got.frames, want.frames);
+        }
+        failed++;
+      } else {
+        printf("ok          %s (%u frames, 0x%016llx)\n", names[i], got.frames, (unsigned long long)got.digest);
+        passed++;
+      }
+    }
+    total_frames += got.frames;
+    free(got.hashes);
+    free(want.hashes);
+    free(names[i]);
+  }
+  double elapsed = now_seconds() - start;
+  chip8_jit_destroy(jit);
+
+  printf("\n%s: %d ROMs, %llu frames em %.3f s\n", update ? "Atualizadas" : "Conferidas", passed + failed,
+         total_frames, elapsed);
+  if (failed || missing || errors) {
+    printf("Divergências: %d, sem golden: %d, erros: %d\n", failed, missing, errors);
+  }
+  if (errors) {
+    return 1;
+  }
+  return failed || missing ? 2 : 0; // ROM sem golden também reprova: grave com --update
+}
@@ -0,0 +1,720 @@
+#define _POSIX_C_SOURCE 200809L // clock_gettime / CLOCK_MONOTONIC
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "chip8.h"
+#include "jit.h"
+#include "batch.h"
+#include "movie.h"
+#include "sched.h"
+#include "profile.h"
+#include "trace.h"
+#include "library.h"
+#include "quirks.h"
+#include "machine.h"
+#include "capture.h"
+#include "render.h"
+
+// Runner sem janela: executa o núcleo na velocidade máxima, sem SDL,
+// sem SDL_Delay e sem conversão de textura. Útil para medir o throughput
+// real do interpretador em máquinas de CI sem display.
+
+#define DEFAULT_CYCLES   10000000ULL  // Ciclos executados se nada for informado
+#define WAV_SAMPLE_RATE  48000
+#define LIBRARY_DIR      "games"      // Biblioteca usada por "@hash" sem --library
+#define CAPTURE_SCALE    4            // Escala padrão do vídeo de --capture
+
+static void usage(const char* prog) {
+  printf("Uso: %s <arquivo_rom | @sha1> [-c ciclos | -f frames] [-r | -j | -b instancias [-t threads]]\n"
+         "       [--hz clock] [--vip] [--record movie | --replay movie] [--wav arquivo]\n"
+         "       [--profile arquivo] [--trace arquivo] [--library dir] [--quirks perfil] [--machine modelo]\n"
+         "       [--capture video [--capture-scale N] [-p paleta]]\n", prog);
+  printf("       %s --library dir   (lista as ROMs do diretório)\n", prog);
+  printf("  -c N  executa N ciclos (padrão: %llu; com --vip, N µs emulados)\n", DEFAULT_CYCLES);
+  printf("  -f N  executa N frames (ticks de %d Hz dos temporizadores)\n", CHIP8_TIMER_HZ);
+  printf("  -r    usa o interpretador de referência (chip8_cycle)\n");
+  printf("  -j    usa o recompilador dinâmico (x86-64)\n");
+  printf("  -b N  executa N instâncias em lote (SoA), cada uma com teclas pseudoaleatórias próprias\n");
+  printf("  -t N  threads do modo em lote (padrão: processadores online)\n");
+  printf("  --hz N      clock da CPU em instruções/s (padrão: %d; %d a %d)\n",
+         CHIP8_DEFAULT_CLOCK_HZ, CHIP8_CLOCK_MIN_HZ, CHIP8_CLOCK_MAX_HZ);
+  printf("  --vip       custo de cada opcode como no COSMAC VIP (clock em µs/s, padrão: %d)\n", CHIP8_VIP_CLOCK_HZ);
+  printf("  --record F  grava em F as teclas pseudoaleatórias da instância 0 do modo em lote\n");
+  printf("  --replay F  reproduz o movie F e confere o framebuffer final (código 2 se divergir)\n");
+  printf("  --wav F     grava o bipe do sound timer em F (WAV PCM 16 bits, mono, %d Hz)\n", WAV_SAMPLE_RATE);
+  printf("  --profile F perfila chip8_cycle (implica -r): relatório na saída e pilhas colapsadas em F\n"
+         "              (requer build com make PROFILE=1)\n");
+  printf("  --trace F   grava cada instrução de chip8_cycle em F (implica -r; ver chip8_tracedump)\n"
+         "              (requer build com make TRACE=1)\n");
+  printf("  --library D biblioteca de ROMs indexada em D (padrão: %s); @sha1 carrega a ROM pelo hash\n", LIBRARY_DIR);
+  printf("  --quirks Q  perfil ou quirks separadas por vírgula, no lugar das do banco de ROMs:\n");
+  for (int i = 0; chip8_quirk_profiles[i].name; i++) {
+    printf("              %-7s %s\n", chip8_quirk_profiles[i].name, chip8_quirk_profiles[i].description);
+  }
+  printf("              quirks: shift_vy, load_store_i, jump_vx, clip\n");
+  printf("  --machine M chip8 (padrão), schip (SUPER-CHIP 1.1, 128x64) ou xochip (XO-CHIP, 64 KB e dois planos)\n");
+  printf("  --capture F grava o display em F: GIF animado ou, com extensão .y4m, vídeo YUV4MPEG2 a 60 quadros/s\n");
+  printf("  --capture-scale N  escala inteira do vídeo (1 a %d, padrão: %d)\n", CHIP8_CAPTURE_MAX_SCALE, CAPTURE_SCALE);
+  printf("  -p paleta   cores do vídeo: classico, invertido, fosforo, ambar, lcd ou RRGGBB:RRGGBB\n");
+}
+
+// Lista a biblioteca (o índice é criado ou atualizado na abertura)
+static int list_library(const char* dir) {
+  Chip8Library library;
+  int result = chip8_library_open(&library, dir);
+  if (result != 0) {
+    printf("Erro: %s: %s\n", chip8_library_error(result), dir);
+    return 1;
+  }
+  chip8_library_print(&library, stdout);
+  printf("%u ROMs, %u lidas e hasheadas agora%s\n", library.count, library.hashed,
+         library.index_written ? " (índice regravado)" : "");
+  chip8_library_close(&library);
+  return 0;
+}
+
+// "@prefixo": acha a ROM pelo SHA-1 e copia a imagem mapeada; `path` recebe o caminho
+// do arquivo (usado pelo movie e pelo relatório)
+static int library_rom(const char* dir, const char* hex, char* path, size_t path_size,
+                       uint8_t image[CHIP8_ROM_MAX_XO], uint32_t* size) {
+  Chip8Library library;
+  int result = chip8_library_open(&library, dir);
+  if (result != 0) {
+    printf("Erro: %s: %s\n", chip8_library_error(result), dir);
+    return -1;
+  }
+  const Chip8RomEntry* entry = chip8_library_find(&library, hex);
+  const uint8_t* mapped = entry ? chip8_library_image(&library, entry, &result) : NULL;
+  if (!mapped) {
+    printf("Erro: %s\n", entry ? chip8_library_error(result) : "nenhuma ROM (ou mais de uma) com esse hash na biblioteca");
+    chip8_library_close(&library);
+    return -1;
+  }
+  memcpy(image, mapped, entry->size);
+  *size = entry->size;
+  chip8_library_path(&library, entry, path, path_size);
+  chip8_library_close(&library);
+  return 0;
+}
+
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Teclas do modo em lote: cada instância segura uma tecla (ou nenhuma) por 8 frames,
+// escolhida por um hash (splitmix64) da instância e do frame
+static uint16_t seeded_keys(uint32_t instance, uint64_t frame, void* user) {
+  (void)user;
+  uint64_t h = ((uint64_t)instance << 32) ^ (frame / 8);
+  h += 0x9E3779B97F4A7C15ULL;
+  h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+  h ^= h >> 31;
+  uint32_t key = (uint32_t)(h % 20);
+  return key < 16 ? (uint16_t)(1u << key) : 0; // 4 em 20: nenhuma tecla
+}
+
+// WAV: cabeçalho RIFF de 44 bytes; os tamanhos são preenchidos em wav_close
+static void wav_header(uint8_t h[44], uint32_t samples) {
+  uint32_t data = samples * 2;
+  uint32_t fields[] = {36 + data, 16, 0x00010001u, WAV_SAMPLE_RATE, WAV_SAMPLE_RATE * 2, 0x00100002u, data};
+  memcpy(h, "RIFF", 4);
+  memcpy(h + 8, "WAVEfmt ", 8);
+  memcpy(h + 36, "data", 4);
+  static const int offsets[] = {4, 16, 20, 24, 28, 32, 40};
+  for (int i = 0; i < 7; i++) {
+    for (int b = 0; b < 4; b++) h[offsets[i] + b] = (uint8_t)(fields[i] >> (8 * b));
+  }
+}
+
+// Escreve no WAV todas as amostras que o tempo emulado já cobre
+static int wav_drain(FILE* wav, Chip8Beeper* beeper, Chip8AudioRing* ring, uint64_t* samples) {
+  int16_t buf[4096];
+  uint8_t bytes[sizeof(buf)];
+  uint64_t pending;
+  while ((pending = chip8_beeper_pending(beeper, ring)) > 0) {
+    uint32_t n = pending < 4096 ? (uint32_t)pending : 4096;
+    chip8_beeper_render(beeper, ring, buf, n);
+    for (uint32_t i = 0; i < n; i++) {
+      bytes[2 * i] = (uint8_t)buf[i];
+      bytes[2 * i + 1] = (uint8_t)((uint16_t)buf[i] >> 8);
+    }
+    if (fwrite(bytes, 2, n, wav) != n) {
+      return -1;
+    }
+    *samples += n;
+  }
+  return 0;
+}
+
+static int compare_u64(const void* a, const void* b) {
+  uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+  return (x > y) - (x < y);
+}
+
+// Modo em lote: N instâncias da ROM em lockstep, divididas entre as threads
+static int run_batch(const Chip8* proto, const char* rom_path, unsigned long long total_cycles,
+                     uint32_t cycles_per_frame, uint32_t instances, int threads) {
+  Chip8Batch* batch = chip8_batch_create(proto, instances, threads);
+  if (!batch) {
+    printf("Erro: sem memória para %u instâncias\n", instances);
+    return 1;
+  }
+
+  uint32_t frames = (uint32_t)(total_cycles / cycles_per_frame);
+  double start = now_seconds();
+  int result = chip8_batch_run_frames(batch, frames, cycles_per_frame, seeded_keys, NULL);
+  double elapsed = now_seconds() - start;
+  if (result != 0) {
+    printf("Erro: sem memória para as cópias privadas das instâncias\n");
+    chip8_batch_destroy(batch);
+    return 1;
+  }
+
+  // Quantos framebuffers finais diferentes as entradas produziram
+  uint64_t* hashes = malloc(sizeof(uint64_t) * instances);
+  uint32_t distinct = 0;
+  if (hashes) {
+    for (uint32_t i = 0; i < instances; i++) {
+      hashes[i] = chip8_batch_display_hash(batch, i);
+    }
+    qsort(hashes, instances, sizeof(uint64_t), compare_u64);
+    for (uint32_t i = 0; i < instances; i++) {
+      distinct += (i == 0 || hashes[i] != hashes[i - 1]);
+    }
+  }
+
+  Chip8BatchStats stats = chip8_batch_stats(batch);
+  double lane_cycles = (double)instances * (double)frames * cycles_per_frame;
+  printf("ROM: %s\n", rom_path);
+  printf("Núcleo: lote SoA (%d lanes por fragmento)\n", CHIP8_BATCH_LANES);
+  char quirks[64];
+  printf("Quirks: %s\n", chip8_quirks_describe(proto->quirks, quirks, sizeof(quirks)));
+  printf("Instâncias: %u\n", instances);
+  printf("Threads: %d\n", chip8_batch_threads(batch));
+  printf("Ciclos por instância: %llu\n", (unsigned long long)frames * cycles_per_frame);
+  printf("Tempo: %.6f s\n", elapsed);
+  printf("Instâncias x ciclos/s: %.0f\n", elapsed > 0 ? lane_cycles / elapsed : 0.0);
+  printf("Lanes por despacho (média): %.2f\n",
+         stats.group_steps ? (double)stats.lane_steps / (double)stats.group_steps : 0.0);
+  printf("Framebuffers finais distintos: %u\n", distinct);
+  printf("Hash do framebuffer (instância 0): 0x%016llx\n",
+         (unsigned long long)chip8_batch_display_hash(batch, 0));
+
+  free(hashes);
+  chip8_batch_destroy(batch);
+  return 0;
+}
+
+// Unidades de tempo emulado até o fim do frame `frames` (tick número `frames`)
+static unsigned long long frames_to_units(unsigned long long frames, uint32_t clock_hz) {
+  return (frames * clock_hz + CHIP8_TIMER_HZ - 1) / CHIP8_TIMER_HZ;
+}
+
+// Cores do vídeo: as da paleta e, para os planos do XO-CHIP, os tons intermediários do chip8
+static void capture_palette(const Chip8Palette* p, Chip8CapturePalette out) {
+  for (int c = 0; c < 3; c++) {
+    out[0][c] = p->off[c];
+    out[1][c] = p->on[c];
+    out[2][c] = (uint8_t)((2 * p->off[c] + p->on[c]) / 3);
+    out[3][c] = (uint8_t)((p->off[c] + 2 * p->on[c]) / 3);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  const char* rom_path = NULL;
+  unsigned long long total_cycles = DEFAULT_CYCLES;
+  unsigned long long total_frames = 0; // -f: frames em vez de ciclos
+  int reference = 0;
+  int use_jit = 0;
+  uint32_t instances = 0;
+  int threads = 0;
+  const char* movie_path = NULL;
+  int replay = 0;
+  uint32_t clock_hz = 0; // 0 = padrão do modelo de custo
+  int vip_costs = 0;
+  const char* wav_path = NULL;
+  const char* profile_path = NULL;
+  const char* trace_path = NULL;
+  const char* library_dir = NULL;
+  int quirks_override = -1; // -1 = as do banco de ROMs
+  Chip8Machine machine = CHIP8_MACHINE_CHIP8;
+  const char* capture_path = NULL;
+  int capture_scale = CAPTURE_SCALE;
+  const char* palette_spec = "classico";
+
+  // Processa argumentos
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+      total_cycles = strtoull(argv[++i], NULL, 10);
+      total_frames = 0;
+    } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+      total_frames = strtoull(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "-r") == 0) {
+      reference = 1;
+    } else if (strcmp(argv[i], "-j") == 0) {
+      use_jit = 1;
+    } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+      instances = (uint32_t)strtoul(argv[++i], NULL, 10);
+      if (instances == 0) {
+        usage(argv[0]);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      threads = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--hz") == 0 && i + 1 < argc) {
+      clock_hz = (uint32_t)strtoul(argv[++i], NULL, 10);
+      if (clock_hz < CHIP8_CLOCK_MIN_HZ || clock_hz > CHIP8_CLOCK_MAX_HZ) {
+        usage(argv[0]);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "--vip") == 0) {
+      vip_costs = 1;
+    } else if ((strcmp(argv[i], "--record") == 0 || strcmp(argv[i], "--replay") == 0) &&
+               i + 1 < argc && !movie_path) {
+      replay = strcmp(argv[i], "--replay") == 0;
+      movie_path = argv[++i];
+    } else if (strcmp(argv[i], "--wav") == 0 && i + 1 < argc) {
+      wav_path = argv[++i];
+    } else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+      profile_path = argv[++i];
+      reference = 1;
+    } else if (strcmp(argv[i], "--library") == 0 && i + 1 < argc) {
+      library_dir = argv[++i];
+    } else if (strcmp(argv[i], "--quirks") == 0 && i + 1 < argc) {
+      uint8_t quirks;
+      if (chip8_quirks_parse(argv[++i], &quirks) != 0) {
+        printf("Erro: quirks desconhecidas: %s\n", argv[i]);
+        usage(argv[0]);
+        return 1;
+      }
+      quirks_override = quirks;
+    } else if (strcmp(argv[i], "--machine") == 0 && i + 1 < argc) {
+      if (chip8_machine_parse(argv[++i], &machine) != 0) {
+        printf("Erro: modelo de máquina desconhecido: %s\n", argv[i]);
+        usage(argv[0]);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+      trace_path = argv[++i];
+      reference = 1;
+    } else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+      capture_path = argv[++i];
+    } else if (strcmp(argv[i], "--capture-scale") == 0 && i + 1 < argc) {
+      capture_scale = atoi(argv[++i]);
+      if (capture_scale < 1 || capture_scale > CHIP8_CAPTURE_MAX_SCALE) {
+        usage(argv[0]);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+      palette_spec = argv[++i];
+    } else if (argv[i][0] != '-' && !rom_path) {
+      rom_path = argv[i];
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (!rom_path && library_dir) {
+    return list_library(library_dir);
+  }
+  if (!rom_path) {
+    usage(argv[0]);
+    return 1;
+  }
+  static char library_path[4500];
+  static uint8_t rom_image[CHIP8_ROM_MAX_XO];
+  uint32_t rom_size = 0;
+  int from_library = rom_path[0] == '@';
+  if (from_library) {
+    if (library_rom(library_dir ? library_dir : LIBRARY_DIR, rom_path + 1, library_path, sizeof(library_path),
+                    rom_image, &rom_size) != 0) {
+      return 1;
+    }
+    rom_path = library_path;
+  }
+  if (clock_hz == 0) {
+    clock_hz = vip_costs ? CHIP8_VIP_CLOCK_HZ : CHIP8_DEFAULT_CLOCK_HZ;
+  }
+  if (profile_path && (use_jit || instances > 0)) {
+    printf("Erro: --profile perfila o interpretador de referência (sem -j ou -b)\n");
+    return 1;
+  }
+  if (trace_path && (use_jit || instances > 0)) {
+    printf("Erro: --trace grava o interpretador de referência (sem -j ou -b)\n");
+    return 1;
+  }
+  if (vip_costs && (reference || use_jit)) {
+    printf("Erro: --vip usa o núcleo pré-decodificado (sem -r ou -j)\n");
+    return 1;
+  }
+  if (machine != CHIP8_MACHINE_CHIP8 && (vip_costs || instances > 0)) {
+    printf("Erro: --vip e o modo em lote só executam o CHIP-8 (sem --machine %s)\n", chip8_machine_name(machine));
+    return 1;
+  }
+  Chip8Palette palette;
+  if (chip8_palette_parse(palette_spec, &palette) != 0) {
+    printf("Erro: paleta inválida: %s\n", palette_spec);
+    return 1;
+  }
+
+  // Inicializa CHIP-8 e carrega ROM (o modelo de máquina vem antes: define a memória e as quirks padrão)
+  Chip8 chip8;
+  chip8_init(&chip8);
+  int rom_result = chip8_set_machine(&chip8, machine) != 0 ? -4
+                   : from_library                         ? chip8_load_rom_image(&chip8, rom_image, rom_size)
+                                                          : chip8_load_rom(&chip8, rom_path);
+  if (rom_result != 0) {
+    printf("Erro: %s: %s\n", chip8_load_error(rom_result), rom_path);
+    chip8_release(&chip8);
+    return 1;
+  }
+  if (quirks_override >= 0) {
+    chip8.quirks = (uint8_t)quirks_override;
+  }
+
+  if (instances > 0) {
+    // O lote executa frames de tamanho fixo: o clock precisa dar um número inteiro de ciclos por tick
+    if (movie_path || wav_path || capture_path || vip_costs || clock_hz % CHIP8_TIMER_HZ != 0) {
+      printf("Erro: o modo em lote requer clock múltiplo de %d Hz, sem --vip, movie, WAV nem captura\n", CHIP8_TIMER_HZ);
+      chip8_release(&chip8);
+      return 1;
+    }
+    uint32_t cycles_per_frame = clock_hz / CHIP8_TIMER_HZ;
+    if (total_frames) {
+      total_cycles = total_frames * cycles_per_frame;
+    }
+    int result = run_batch(&chip8, rom_path, total_cycles, cycles_per_frame, instances, threads);
+    chip8_release(&chip8);
+    return result;
+  }
+
+  // Recursos liberados em um único ponto de saída (cleanup), também nos erros
+  int status = 1;
+  Chip8Jit* jit = NULL;
+  Chip8Movie movie;
+  int have_movie = 0;
+  FILE* wav = NULL;
+  Chip8AudioRing* ring = NULL;
+  Chip8Profile* profile = NULL;
+  Chip8Trace* trace = NULL;
+  Chip8Capture* capture = NULL;
+  uint64_t end_frame = 0; // Último tick emulado (duração do último quadro do vídeo)
+
+  if (use_jit) {
+    jit = chip8_jit_create();
+    if (!jit) {
+      printf("Erro: sem memória para o JIT\n");
+      goto cleanup;
+    }
+  }
+
+  // Movie: ao reproduzir, o clock, o número de frames e as teclas vêm do arquivo
+  int recording = movie_path && !replay;
+  if (movie_path) {
+    uint64_t rom_hash;
+    if (chip8_rom_file_hash(rom_path, &rom_hash) != 0) {
+      printf("Erro: não foi possível ler %s\n", rom_path);
+      goto cleanup;
+    }
+    if (replay) {
+      int result = chip8_movie_load(&movie, movie_path);
+      if (result != 0) {
+        printf("Erro: %s: %s\n", chip8_movie_error(result), movie_path);
+        goto cleanup;
+      }
+      have_movie = 1;
+      if (movie.rom_hash != rom_hash) {
+        printf("Erro: o movie foi gravado com outra ROM\n");
+        goto cleanup;
+      }
+      if (movie.vip_costs && (reference || jit)) {
+        printf("Erro: o movie usa custos do VIP, que exigem o núcleo pré-decodificado\n");
+        goto cleanup;
+      }
+      if (movie.machine != chip8.machine) {
+        printf("Erro: o movie foi gravado com --machine %s\n", chip8_machine_name((Chip8Machine)movie.machine));
+        goto cleanup;
+      }
+      clock_hz = movie.clock_hz;
+      vip_costs = movie.vip_costs;
+      chip8.quirks = movie.quirks;
+      total_frames = movie.frames;
+    } else {
+      chip8_movie_init(&movie, rom_hash, clock_hz, vip_costs);
+      have_movie = 1;
+      movie.quirks = chip8.quirks;
+      movie.machine = chip8.machine;
+      if (!total_frames) {
+        total_frames = total_cycles * CHIP8_TIMER_HZ / clock_hz; // Apenas frames completos entram no movie
+      }
+    }
+  }
+  unsigned long long total_units = total_frames ? frames_to_units(total_frames, clock_hz) : total_cycles;
+
+  // Executa frame a frame: do tick atual até o próximo (ou até o fim do orçamento)
+  Chip8Sched sched;
+  chip8_sched_init(&sched, clock_hz, vip_costs);
+
+  // WAV: os eventos do som passam pelo mesmo ring do frontend SDL e são convertidos
+  // em amostras a cada frame
+  Chip8Beeper beeper;
+  uint64_t wav_samples = 0;
+  if (wav_path) {
+    ring = malloc(sizeof(Chip8AudioRing));
+    wav = ring ? fopen(wav_path, "wb") : NULL;
+    uint8_t header[44];
+    wav_header(header, 0);
+    if (!wav || fwrite(header, 1, sizeof(header), wav) != sizeof(header)) {
+      printf("Erro: não foi possível criar %s\n", wav_path);
+      goto cleanup;
+    }
+    chip8_audio_init(ring);
+    chip8_beeper_init(&beeper, WAV_SAMPLE_RATE, clock_hz);
+    chip8_sched_attach_audio(&sched, ring, WAV_SAMPLE_RATE);
+  }
+
+  if (profile_path) {
+    profile = chip8_profile_create();
+    if (!profile) {
+      printf("Erro: perfilador indisponível (compile com make clean && make headless PROFILE=1)\n");
+      goto cleanup;
+    }
+    chip8_profile_attach(profile);
+  }
+
+  if (trace_path) {
+    trace = chip8_trace_open(trace_path);
+    if (!trace) {
+      printf("Erro: não foi possível gravar o trace %s (o build precisa de make TRACE=1)\n", trace_path);
+      goto cleanup;
+    }
+    chip8_trace_attach(trace);
+  }
+
+  // Vídeo: cada frame em que o display mudou vai para a thread de codificação; sem tempo
+  // real para manter, a execução espera por ela em vez de descartar frames
+  uint32_t captured_gen = chip8.display_gen - 1; // Força o display inicial
+  if (capture_path) {
+    Chip8CapturePalette colors;
+    capture_palette(&palette, colors);
+    capture = chip8_capture_open(capture_path, machine, capture_scale, colors);
+    if (!capture) {
+      printf("Erro: não foi possível criar %s\n", capture_path);
+      goto cleanup;
+    }
+  }
+
+  int whole_budget = !reference && !vip_costs && !wav && !movie_path && !capture;
+  double start = now_seconds();
+  while (sched.units < total_units) {
+    if (capture && chip8.display_gen != captured_gen) {
+      captured_gen = chip8.display_gen;
+      chip8_capture_wait(capture);
+      chip8_capture_push(capture, &chip8, sched.ticks);
+    }
+    // Sem áudio, movie nem captura nada observa o estado entre os ticks, e com os dois
+    // temporizadores zerados os ticks não mudam nada: o bloco vai até o fim do orçamento,
+    // parando antes de um FX15/FX18 que ligue um temporizador (dali em diante, tick a tick)
+    if (whole_budget && chip8.delay_timer == 0 && chip8.sound_timer == 0) {
+      uint64_t rest = total_units - sched.units;
+      uint32_t n = rest < UINT32_MAX ? (uint32_t)rest : UINT32_MAX;
+      n = jit ? chip8_jit_run_until_timer(jit, &chip8, n) : chip8_run_until_timer(&chip8, n);
+      if (n > 0) {
+        chip8_sched_step(&sched, &chip8, n);
+        continue;
+      }
+    }
+    uint64_t cycles = chip8_sched_until_tick(&sched);
+    if (cycles > total_units - sched.units) {
+      cycles = total_units - sched.units;
+    }
+    uint32_t frame = (uint32_t)sched.ticks;
+    if (replay) {
+      chip8_set_keys(&chip8, movie.keys[frame]);
+    } else if (recording) {
+      uint16_t keys = seeded_keys(0, frame, NULL);
+      chip8_set_keys(&chip8, keys);
+      if (chip8_movie_append(&movie, keys) != 0) {
+        printf("Erro: sem memória para o movie\n");
+        end_frame = sched.ticks;
+        goto cleanup;
+      }
+    }
+    if (vip_costs) {
+      chip8_sched_run(&sched, &chip8, cycles);
+      if (wav && wav_drain(wav, &beeper, ring, &wav_samples) != 0) {
+        break;
+      }
+      continue;
+    }
+    // Sem áudio, o bloco vai até o tick; com áudio, em pedaços de uma amostra
+    for (uint64_t done = 0, n; done < cycles; done += n) {
+      n = cycles - done < sched.quantum ? cycles - done : sched.quantum;
+      if (reference) {
+        for (uint64_t i = 0; i < n; i++) {
+          chip8_cycle(&chip8);
+        }
+      } else if (jit) {
+        chip8_jit_run(jit, &chip8, (uint32_t)n);
+      } else {
+        chip8_run(&chip8, (uint32_t)n);
+      }
+      chip8_sched_step(&sched, &chip8, n);
+    }
+    if (wav && wav_drain(wav, &beeper, ring, &wav_samples) != 0) {
+      break;
+    }
+
+    // Parado em 1NNN para si mesmo ou em FX0A sem entradas: nada mais muda além dos
+    // temporizadores, então o restante do orçamento é avançado de uma vez
+#ifndef CHIP8_NO_IDLE_SKIP
+    if (!reference && !movie_path) {
+      Chip8Idle idle = chip8_idle(&chip8);
+      if (idle == CHIP8_IDLE_HALT || idle == CHIP8_IDLE_KEY_WAIT) {
+        uint64_t rest = total_units - sched.units;
+        chip8.idle_cycles += rest;
+        sched.instructions += rest;
+        chip8_sched_advance(&sched, &chip8, rest);
+        chip8_sched_sync_audio(&sched, &chip8);
+        if (wav && wav_drain(wav, &beeper, ring, &wav_samples) != 0) {
+          break;
+        }
+      }
+    }
+#endif
+  }
+  if (capture && chip8.display_gen != captured_gen) {
+    chip8_capture_wait(capture);
+    chip8_capture_push(capture, &chip8, sched.ticks);
+  }
+  double elapsed = now_seconds() - start;
+  // Ciclos pulados em laços ociosos não custaram nada: a vazão conta só os executados
+  unsigned long long emulated = sched.instructions;
+  unsigned long long skipped = chip8.idle_cycles;
+  unsigned long long executed = emulated - skipped;
+
+  // Relatório final
+  printf("ROM: %s\n", rom_path);
+  if (reference) {
+    printf("Núcleo: referência (chip8_cycle)\n");
+  } else if (chip8.machine != CHIP8_MACHINE_CHIP8) {
+    printf("Núcleo: interpretador das máquinas estendidas (chip8_machine_run)\n");
+  } else if (jit) {
+    printf("Núcleo: %s\n", chip8_jit_native(jit) ? "JIT x86-64" : "JIT indisponível, pré-decodificado (chip8_run)");
+  } else {
+    printf("Núcleo: pré-decodificado (chip8_run)\n");
+  }
+  char quirks[64];
+  printf("Máquina: %s\n", chip8_machine_name((Chip8Machine)chip8.machine));
+  printf("Quirks: %s\n", chip8_quirks_describe(chip8.quirks, quirks, sizeof(quirks)));
+  if (vip_costs) {
+    printf("Clock: %u µs emulados/s (custos do COSMAC VIP)\n", clock_hz);
+  } else {
+    printf("Clock: %u Hz\n", clock_hz);
+  }
+  printf("Ciclos emulados: %llu\n", emulated);
+  printf("Ciclos executados: %llu\n", executed);
+  if (!reference) {
+    printf("Ciclos ociosos pulados: %llu (%.1f%% dos emulados)\n", skipped,
+           emulated ? 100.0 * (double)skipped / (double)emulated : 0.0);
+  }
+  printf("Tempo emulado: %.3f s (%llu ticks dos temporizadores)\n",
+         (double)sched.units / clock_hz, (unsigned long long)sched.ticks);
+  printf("Tempo: %.6f s\n", elapsed);
+  printf("Ciclos/s: %.0f (só os executados)\n", elapsed > 0 ? (double)executed / elapsed : 0.0);
+  printf("Hash do framebuffer: 0x%016llx\n", (unsigned long long)chip8_display_hash(&chip8));
+
+  status = 0;
+  end_frame = sched.ticks;
+  if (profile) {
+    chip8_profile_attach(NULL);
+    chip8_profile_report(profile, stdout, 20);
+    const char* rom_name = strrchr(rom_path, '/') ? strrchr(rom_path, '/') + 1 : rom_path;
+    if (chip8_profile_write_collapsed(profile, profile_path, rom_name) != 0) {
+      printf("Erro: não foi possível gravar %s\n", profile_path);
+      status = 1;
+    } else {
+      printf("Pilhas colapsadas: %s (flamegraph.pl %s > perfil.svg)\n", profile_path, profile_path);
+    }
+    chip8_profile_destroy(profile);
+    profile = NULL;
+  }
+  if (trace) {
+    unsigned long long records = trace->records, dropped = trace->dropped;
+    if (chip8_trace_close(trace) != 0) {
+      printf("Erro: falha ao gravar %s\n", trace_path);
+      status = 1;
+    } else {
+      printf("Trace: %s (%llu registros, %llu descartados com o ring cheio)\n", trace_path, records, dropped);
+    }
+    trace = NULL;
+  }
+  if (recording) {
+    movie.final_hash = chip8_display_hash(&chip8);
+    movie.has_final_hash = 1;
+    int result = chip8_movie_save(&movie, movie_path);
+    if (result != 0) {
+      printf("Erro: %s: %s\n", chip8_movie_error(result), movie_path);
+      status = 1;
+    } else {
+      printf("Movie gravado: %s (%u frames)\n", movie_path, movie.frames);
+    }
+  } else if (replay) {
+    if (!movie.has_final_hash) {
+      printf("Movie: %u frames reproduzidos (sem hash final para conferir)\n", movie.frames);
+    } else if (movie.final_hash == chip8_display_hash(&chip8)) {
+      printf("Movie: %u frames reproduzidos, framebuffer idêntico ao gravado\n", movie.frames);
+    } else {
+      printf("Movie: DIVERGÊNCIA - framebuffer gravado 0x%016llx\n", (unsigned long long)movie.final_hash);
+      status = 2;
+    }
+  }
+  if (wav) {
+    // Amostras restantes e, por fim, os tamanhos no cabeçalho
+    uint8_t header[44];
+    int ok = wav_drain(wav, &beeper, ring, &wav_samples) == 0;
+    wav_header(header, (uint32_t)wav_samples);
+    ok = ok && fseek(wav, 0, SEEK_SET) == 0 && fwrite(header, 1, sizeof(header), wav) == sizeof(header);
+    if (fclose(wav) != 0 || !ok) {
+      printf("Erro: falha ao gravar %s\n", wav_path);
+      status = 1;
+    } else {
+      printf("WAV gravado: %s (%.3f s)\n", wav_path, (double)wav_samples / WAV_SAMPLE_RATE);
+    }
+    wav = NULL;
+  }
+  if (capture) {
+    unsigned long long pushed = capture->pushed;
+    if (chip8_capture_close(capture, end_frame) != 0) {
+      printf("Erro: falha ao gravar %s\n", capture_path);
+      status = 1;
+    } else {
+      printf("Vídeo gravado: %s (%llu frames com mudança no display)\n", capture_path, pushed);
+    }
+    capture = NULL;
+  }
+
+cleanup:
+  // Depois de um erro, fecha o que já tinha sido aberto (os arquivos ficam incompletos)
+  chip8_capture_close(capture, end_frame);
+  chip8_trace_close(trace);
+  if (profile) {
+    chip8_profile_attach(NULL);
+    chip8_profile_destroy(profile);
+  }
+  if (wav) {
+    fclose(wav);
+  }
+  free(ring);
+  if (have_movie) {
+    chip8_movie_free(&movie);
+  }
+  chip8_jit_destroy(jit);
+  chip8_release(&chip8);
+  return status;
+}
@@ -0,0 +1,40 @@
+#include <string.h>
+#include "input.h"
+
+#define QUEUE_MASK (CHIP8_INPUT_QUEUE_SIZE - 1u)
+
+void chip8_input_init(Chip8InputQueue* q) {
+  memset(q->events, 0, sizeof(q->events));
+  atomic_init(&q->head, 0u);
+  atomic_init(&q->tail, 0u);
+}
+
+int chip8_input_push(Chip8InputQueue* q, uint64_t time, uint8_t key, int down) {
+  unsigned head = atomic_load_explicit(&q->head, memory_order_relaxed);
+  if (head - atomic_load_explicit(&q->tail, memory_order_acquire) >= CHIP8_INPUT_QUEUE_SIZE) {
+    return -1;
+  }
+  q->events[head & QUEUE_MASK].time = time;
+  q->events[head & QUEUE_MASK].key = key & 0x0F;
+  q->events[head & QUEUE_MASK].down = (uint8_t)(down != 0);
+  atomic_store_explicit(&q->head, head + 1, memory_order_release);
+  return 0;
+}
+
+int chip8_input_peek(Chip8InputQueue* q, Chip8InputEvent* ev) {
+  unsigned tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+  if (tail == atomic_load_explicit(&q->head, memory_order_acquire)) {
+    return 0;
+  }
+  *ev = q->events[tail & QUEUE_MASK];
+  return 1;
+}
+
+void chip8_input_pop(Chip8InputQueue* q) {
+  unsigned tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+  atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+}
+
+uint16_t chip8_input_apply(uint16_t keys, const Chip8InputEvent* ev) {
+  return ev->down ? (uint16_t)(keys | (1u << ev->key)) : (uint16_t)(keys & ~(1u << ev->key));
+}
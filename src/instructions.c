@@ -1,11 +1,40 @@
 #include "instructions.h"
 #include <string.h>
 
+// Acessos via I que passam do fim da memória fazem wrap-around em 4 KB e são contados em oob_accesses
+static inline void check_range(Chip8* chip8, uint32_t len) {
+  if ((uint32_t)chip8->I + len > 4096) {
+    chip8->oob_accesses++;
+  }
+}
+
+// Invalida a cache de [addr, addr + len) considerando o wrap-around
+static void invalidate_wrapped(Chip8* chip8, uint16_t addr, uint16_t len) {
+  uint16_t start = addr & 0x0FFF;
+  if (start + len <= 4096) {
+    chip8_invalidate(chip8, start, len);
+  } else {
+    chip8_invalidate(chip8, start, 4096 - start);
+    chip8_invalidate(chip8, 0, start + len - 4096);
+  }
+}
+
 // Instruções de Sistema
 
 // 0x00E0: CLS - Limpar tela (clear screen)
 void inst_00E0(Chip8* chip8, uint16_t opcode) {
-  memset(chip8->display, 0, sizeof(chip8->display));
+  // Marca como sujas apenas as linhas que tinham algum pixel ligado
+  uint32_t dirty = 0;
+  for (int y = 0; y < 32; y++) {
+    if (chip8->display[y]) {
+      dirty |= 1u << y;
+    }
+  }
+  if (dirty) {
+    memset(chip8->display, 0, sizeof(chip8->display));
+    chip8->dirty_rows |= dirty;
+    chip8->display_gen++;
+  }
 }
 
 // 0x00EE: RET - Retornar de sub-rotina
@@ -129,8 +158,18 @@ void inst_8XY5(Chip8* chip8, uint16_t opcode) {
 // 0x8XY6: SHR Vx - Shift right (VF = bit menos significativo antes do shift)
 void inst_8XY6(Chip8* chip8, uint16_t opcode) {
   uint8_t x = (opcode & 0x0F00) >> 8;
-  chip8->V[0xF] = chip8->V[x] & 0x01;
-  chip8->V[x] >>= 1;
+  uint8_t value = chip8->V[x]; // Lido antes de VF: com X = F, o resultado prevalece (como em chip8_run)
+  chip8->V[0xF] = value & 0x01;
+  chip8->V[x] = value >> 1;
+}
+
+// 0x8XY6 com CHIP8_QUIRK_SHIFT_VY: Vx = Vy >> 1
+void inst_8XY6_vy(Chip8* chip8, uint16_t opcode) {
+  uint8_t x = (opcode & 0x0F00) >> 8;
+  uint8_t y = (opcode & 0x00F0) >> 4;
+  uint8_t value = chip8->V[y];
+  chip8->V[0xF] = value & 0x01;
+  chip8->V[x] = value >> 1;
 }
 
 // 0x8XY7: SUBN Vx, Vy - Vx = Vy - Vx (com borrow em VF)
@@ -144,8 +183,18 @@ void inst_8XY7(Chip8* chip8, uint16_t opcode) {
 // 0x8XYE: SHL Vx - Shift left (VF = bit mais significativo antes do shift)
 void inst_8XYE(Chip8* chip8, uint16_t opcode) {
   uint8_t x = (opcode & 0x0F00) >> 8;
-  chip8->V[0xF] = (chip8->V[x] & 0x80) >> 7;
-  chip8->V[x] <<= 1;
+  uint8_t value = chip8->V[x]; // Lido antes de VF, como em inst_8XY6
+  chip8->V[0xF] = (value & 0x80) >> 7;
+  chip8->V[x] = (uint8_t)(value << 1);
+}
+
+// 0x8XYE com CHIP8_QUIRK_SHIFT_VY: Vx = Vy << 1
+void inst_8XYE_vy(Chip8* chip8, uint16_t opcode) {
+  uint8_t x = (opcode & 0x0F00) >> 8;
+  uint8_t y = (opcode & 0x00F0) >> 4;
+  uint8_t value = chip8->V[y];
+  chip8->V[0xF] = (value & 0x80) >> 7;
+  chip8->V[x] = (uint8_t)(value << 1);
 }
 
 // Instruções de Salto Condicional
@@ -173,6 +222,13 @@ void inst_BNNN(Chip8* chip8, uint16_t opcode) {
   chip8->pc = chip8->V[0] + nnn;
 }
 
+// 0xBNNN com CHIP8_QUIRK_JUMP_VX (BXNN do SUPER-CHIP): pular para VX + NNN
+void inst_BNNN_vx(Chip8* chip8, uint16_t opcode) {
+  uint8_t x = (opcode & 0x0F00) >> 8;
+  uint16_t nnn = opcode & 0x0FFF;
+  chip8->pc = chip8->V[x] + nnn;
+}
+
 // 0xFX07: LD Vx, DT - Vx = delay_timer
 void inst_FX07(Chip8* chip8, uint16_t opcode) {
   uint8_t x = (opcode & 0x0F00) >> 8;
@@ -233,27 +289,44 @@ void inst_FX29(Chip8* chip8, uint16_t opcode) {
 void inst_FX33(Chip8* chip8, uint16_t opcode) {
   uint8_t x = (opcode & 0x0F00) >> 8;
   uint8_t value = chip8->V[x];
-  chip8->memory[chip8->I] = value / 100;        // Centenas
-  chip8->memory[chip8->I + 1] = (value / 10) % 10; // Dezenas
-  chip8->memory[chip8->I + 2] = value % 10;     // Unidades
+  check_range(chip8, 3);
+  chip8->memory[chip8->I & 0x0FFF] = value / 100;              // Centenas
+  chip8->memory[(chip8->I + 1) & 0x0FFF] = (value / 10) % 10;  // Dezenas
+  chip8->memory[(chip8->I + 2) & 0x0FFF] = value % 10;         // Unidades
+  invalidate_wrapped(chip8, chip8->I, 3); // Código automodificável: descarta instruções pré-decodificadas
 }
 
 // 0xFX55: LD [I], Vx - Salvar V0 até Vx na memória começando em I
 void inst_FX55(Chip8* chip8, uint16_t opcode) {
   uint8_t x = (opcode & 0x0F00) >> 8;
+  check_range(chip8, x + 1);
   for (int i = 0; i <= x; i++) {
-    chip8->memory[chip8->I + i] = chip8->V[i];
+    chip8->memory[(chip8->I + i) & 0x0FFF] = chip8->V[i];
   }
+  invalidate_wrapped(chip8, chip8->I, x + 1); // Código automodificável: descarta instruções pré-decodificadas
 }
 
 // 0xFX65: LD Vx, [I] - Carregar V0 até Vx da memória começando em I
 void inst_FX65(Chip8* chip8, uint16_t opcode) {
   uint8_t x = (opcode & 0x0F00) >> 8;
+  check_range(chip8, x + 1);
   for (int i = 0; i <= x; i++) {
-    chip8->V[i] = chip8->memory[chip8->I + i];
+    chip8->V[i] = chip8->memory[(chip8->I + i) & 0x0FFF];
   }
 }
 
+// 0xFX55 com CHIP8_QUIRK_LOAD_STORE_I: I avança X + 1 bytes, como no COSMAC VIP
+void inst_FX55_inc(Chip8* chip8, uint16_t opcode) {
+  inst_FX55(chip8, opcode);
+  chip8->I += ((opcode & 0x0F00) >> 8) + 1;
+}
+
+// 0xFX65 com CHIP8_QUIRK_LOAD_STORE_I
+void inst_FX65_inc(Chip8* chip8, uint16_t opcode) {
+  inst_FX65(chip8, opcode);
+  chip8->I += ((opcode & 0x0F00) >> 8) + 1;
+}
+
 // Instruções de Teclado
 
 // 0xEX9E: SKP Vx - Pular próxima instrução se tecla com valor Vx estiver pressionada
@@ -282,7 +355,9 @@ void inst_EXA1(Chip8* chip8, uint16_t opcode) {
 // Lê N bytes da memória começando em I
 // Cada bit 1 inverte o pixel correspondente (XOR)
 // VF é setado para 1 se algum pixel foi apagado (mudou de 1 para 0)
-void inst_DXYN(Chip8* chip8, uint16_t opcode) {
+// Com o display empacotado, cada linha do sprite vira uma rotação + XOR de 64 bits
+// A posição inicial sempre dá a volta; com `clip`, o que passa das bordas é descartado
+static inline void draw_sprite(Chip8* chip8, uint16_t opcode, int clip) {
   uint8_t x = (opcode & 0x0F00) >> 8;
   uint8_t y = (opcode & 0x00F0) >> 4;
   uint8_t n = opcode & 0x000F;
@@ -290,27 +365,42 @@ void inst_DXYN(Chip8* chip8, uint16_t opcode) {
   uint8_t vx = chip8->V[x] % 64; // Wrap-around horizontal
   uint8_t vy = chip8->V[y] % 32; // Wrap-around vertical
 
-  chip8->V[0xF] = 0; // Flag de colisão começa em 0
+  uint64_t collision = 0;
+  uint32_t dirty = 0;
+  check_range(chip8, n);
 
   // Para cada linha do sprite (N bytes)
   for (int row = 0; row < n; row++) {
-    uint8_t sprite_byte = chip8->memory[chip8->I + row];
+    if (clip && vy + row >= 32) {
+      break; // Linhas abaixo da borda inferior
+    }
     uint8_t py = (vy + row) % 32; // Posição Y na tela (com wrap-around)
 
-    // Para cada bit do byte (8 pixels horizontais)
-    for (int col = 0; col < 8; col++) {
-      uint8_t px = (vx + col) % 64; // Posição X na tela (com wrap-around)
-      int pixel_index = py * 64 + px;
-
-      // Verifica se o bit correspondente está setado no sprite
-      if (sprite_byte & (0x80 >> col)) {
-        // Se o pixel na tela já estava ligado, há colisão
-        if (chip8->display[pixel_index] == 1) {
-          chip8->V[0xF] = 1;
-        }
-        // Inverte o pixel (XOR)
-        chip8->display[pixel_index] ^= 1;
-      }
+    // Byte do sprite alinhado à coluna 0 e rotacionado até vx (a rotação faz o wrap-around horizontal);
+    // cortado, é só um deslocamento: as colunas além da 63 caem fora
+    uint64_t bits = (uint64_t)chip8->memory[(chip8->I + row) & 0x0FFF] << 56;
+    bits = clip ? bits >> vx : (bits >> vx) | (bits << ((64 - vx) & 63));
+
+    // Colisão: algum pixel do sprite já estava ligado
+    collision |= chip8->display[py] & bits;
+    chip8->display[py] ^= bits;
+    if (bits) {
+      dirty |= 1u << py;
     }
   }
+
+  chip8->V[0xF] = collision ? 1 : 0;
+  if (dirty) {
+    chip8->dirty_rows |= dirty;
+    chip8->display_gen++;
+  }
+}
+
+void inst_DXYN(Chip8* chip8, uint16_t opcode) {
+  draw_sprite(chip8, opcode, 0);
+}
+
+// 0xDXYN com CHIP8_QUIRK_CLIP
+void inst_DXYN_clip(Chip8* chip8, uint16_t opcode) {
+  draw_sprite(chip8, opcode, 1);
 }
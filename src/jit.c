@@ -0,0 +1,682 @@
+#define _DEFAULT_SOURCE // mmap / MAP_ANONYMOUS
+
+#include "jit.h"
+#include "instructions.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__linux__)
+#define JIT_X64 1
+#include <sys/mman.h>
+#endif
+
+#define JIT_CODE_SIZE  (1 << 20) // 1 MB de código nativo antes de descartar tudo
+#define JIT_MAX_BLOCK  64        // Instruções por bloco
+#define JIT_BLOCK_BYTES(n) (256 + (n) * 128) // Estimativa pessimista do tamanho de um bloco
+#define JIT_BLOCK_ALIGN 32       // Alinhamento do início de cada bloco
+#define JIT_CALL_BYTES 256       // A mais por chamada a um handler (salva e recarrega V[])
+
+enum { JIT_EMPTY = 0, JIT_COMPILED, JIT_INTERP };
+
+// Bloco traduzido: recebe o orçamento de ciclos (>= 1) e devolve o que sobrou
+typedef uint32_t (*JitBlockFn)(Chip8* chip8, uint32_t cycles);
+
+// Handler do interpretador (inst_*) chamado de dentro de um bloco
+typedef void (*JitHandler)(Chip8* chip8, uint16_t opcode);
+
+typedef struct {
+  JitBlockFn fn;
+  uint8_t state;   // JIT_EMPTY, JIT_COMPILED ou JIT_INTERP (primeira instrução não traduzível)
+  uint8_t self_loop; // Algum 1NNN volta ao início do bloco (candidato a laço ocioso)
+  uint8_t sets_timer; // O bloco tem FX15/FX18
+  uint8_t length;    // Instruções no bloco
+} JitBlock;
+
+struct Chip8Jit {
+  uint8_t* code;           // Buffer executável (NULL = sem suporte nativo)
+  size_t code_used;
+  JitBlock blocks[4096];   // Um bloco por endereço inicial
+  uint8_t covered[4096];   // Bytes da memória que fazem parte de algum bloco traduzido
+  uint8_t quirks;          // Quirks com que os blocos da cache foram traduzidos
+};
+
+Chip8Jit* chip8_jit_create(void) {
+  Chip8Jit* jit = calloc(1, sizeof(Chip8Jit));
+  if (!jit) {
+    return NULL;
+  }
+#ifdef JIT_X64
+  void* mem = mmap(NULL, JIT_CODE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  jit->code = (mem == MAP_FAILED) ? NULL : mem; // Sem memória executável: só interpreta
+#endif
+  return jit;
+}
+
+void chip8_jit_destroy(Chip8Jit* jit) {
+  if (!jit) {
+    return;
+  }
+#ifdef JIT_X64
+  if (jit->code) {
+    munmap(jit->code, JIT_CODE_SIZE);
+  }
+#endif
+  free(jit);
+}
+
+int chip8_jit_native(const Chip8Jit* jit) {
+  return jit->code != NULL;
+}
+
+void chip8_jit_flush(Chip8Jit* jit) {
+  memset(jit->blocks, 0, sizeof(jit->blocks));
+  memset(jit->covered, 0, sizeof(jit->covered));
+  jit->code_used = 0;
+}
+
+#ifdef JIT_X64
+
+// Emissor de código x86-64
+
+enum { RAX = 0, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+enum { ALU_ADD = 0x01, ALU_OR = 0x09, ALU_AND = 0x21, ALU_SUB = 0x29, ALU_XOR = 0x31, ALU_CMP = 0x39, ALU_MOV = 0x89 };
+enum { IMM_ADD = 0, IMM_OR = 1, IMM_AND = 4, IMM_SUB = 5, IMM_XOR = 6, IMM_CMP = 7 };
+enum { SH_SHL = 4, SH_SHR = 5 };
+enum { CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5 };
+
+// Registradores do host disponíveis para V[] (RDI = Chip8*, ESI = orçamento, RAX/RCX = temporários)
+// Os caller-saved vêm primeiro: blocos pequenos não precisam de push/pop
+static const uint8_t host_regs[] = { RDX, R8, R9, R10, R11, RBX, RBP, R12, R13, R14, R15 };
+#define JIT_HOST_REGS (int)(sizeof(host_regs) / sizeof(host_regs[0]))
+#define JIT_CALLER_SAVED 5
+
+#define OFF_V      ((int32_t)offsetof(Chip8, V))
+#define OFF_I      ((int32_t)offsetof(Chip8, I))
+#define OFF_PC     ((int32_t)offsetof(Chip8, pc))
+#define OFF_STACK  ((int32_t)offsetof(Chip8, stack))
+#define OFF_SP     ((int32_t)offsetof(Chip8, sp))
+#define OFF_DT     ((int32_t)offsetof(Chip8, delay_timer))
+#define OFF_ST     ((int32_t)offsetof(Chip8, sound_timer))
+#define OFF_KEYPAD ((int32_t)offsetof(Chip8, keypad))
+
+typedef struct {
+  uint8_t* p;
+} Emit;
+
+static void e8(Emit* e, uint8_t b) { *e->p++ = b; }
+static void e16(Emit* e, uint16_t v) { memcpy(e->p, &v, 2); e->p += 2; }
+static void e32(Emit* e, uint32_t v) { memcpy(e->p, &v, 4); e->p += 4; }
+
+// Prefixo REX quando algum registrador é R8-R15 (ou sempre, para operações de byte)
+static void rex(Emit* e, int reg, int rm, int force) {
+  uint8_t r = 0x40 | ((reg >> 3) << 2) | (rm >> 3);
+  if (r != 0x40 || force) e8(e, r);
+}
+
+static void alu_rr(Emit* e, uint8_t op, int dst, int src) { // op r/m32, r32
+  rex(e, src, dst, 0);
+  e8(e, op);
+  e8(e, 0xC0 | ((src & 7) << 3) | (dst & 7));
+}
+
+static void alu_ri(Emit* e, int ext, int dst, int32_t imm) { // op r/m32, imm
+  rex(e, 0, dst, 0);
+  if (imm >= -128 && imm <= 127) {
+    e8(e, 0x83); e8(e, 0xC0 | (ext << 3) | (dst & 7)); e8(e, (uint8_t)imm);
+  } else {
+    e8(e, 0x81); e8(e, 0xC0 | (ext << 3) | (dst & 7)); e32(e, (uint32_t)imm);
+  }
+}
+
+static void mov_ri(Emit* e, int dst, uint32_t imm) { // mov r32, imm32
+  rex(e, 0, dst, 0);
+  e8(e, 0xB8 + (dst & 7));
+  e32(e, imm);
+}
+
+static void shift_ri(Emit* e, int ext, int dst, uint8_t n) { // shl/shr r32, imm8
+  rex(e, 0, dst, 0);
+  e8(e, 0xC1); e8(e, 0xC0 | (ext << 3) | (dst & 7)); e8(e, n);
+}
+
+static void load8(Emit* e, int dst, int32_t disp) { // movzx r32, byte [rdi+disp]
+  rex(e, dst, RDI, 0);
+  e8(e, 0x0F); e8(e, 0xB6); e8(e, 0x80 | ((dst & 7) << 3) | 7); e32(e, (uint32_t)disp);
+}
+
+static void store8(Emit* e, int src, int32_t disp) { // mov byte [rdi+disp], r8
+  rex(e, src, RDI, 1);
+  e8(e, 0x88); e8(e, 0x80 | ((src & 7) << 3) | 7); e32(e, (uint32_t)disp);
+}
+
+static void load16(Emit* e, int dst, int32_t disp) { // movzx r32, word [rdi+disp]
+  rex(e, dst, RDI, 0);
+  e8(e, 0x0F); e8(e, 0xB7); e8(e, 0x80 | ((dst & 7) << 3) | 7); e32(e, (uint32_t)disp);
+}
+
+static void store16(Emit* e, int src, int32_t disp) { // mov word [rdi+disp], r16
+  e8(e, 0x66);
+  rex(e, src, RDI, 0);
+  e8(e, 0x89); e8(e, 0x80 | ((src & 7) << 3) | 7); e32(e, (uint32_t)disp);
+}
+
+static void store16_imm(Emit* e, int32_t disp, uint16_t imm) { // mov word [rdi+disp], imm16
+  e8(e, 0x66); e8(e, 0xC7); e8(e, 0x87); e32(e, (uint32_t)disp); e16(e, imm);
+}
+
+static void push_r(Emit* e, int r) { rex(e, 0, r, 0); e8(e, 0x50 + (r & 7)); }
+static void pop_r(Emit* e, int r) { rex(e, 0, r, 0); e8(e, 0x58 + (r & 7)); }
+
+static void mov_rax_imm64(Emit* e, uint64_t imm) { // mov rax, imm64
+  e8(e, 0x48); e8(e, 0xB8);
+  memcpy(e->p, &imm, 8); e->p += 8;
+}
+
+// Saltos: devolvem a posição do deslocamento para ser corrigido depois
+static uint8_t* jcc8(Emit* e, uint8_t cc) { e8(e, 0x70 | cc); e8(e, 0); return e->p - 1; }
+static uint8_t* jmp8(Emit* e) { e8(e, 0xEB); e8(e, 0); return e->p - 1; }
+static void patch8(Emit* e, uint8_t* at) { *at = (uint8_t)(e->p - (at + 1)); }
+static uint8_t* jcc32(Emit* e, uint8_t cc) { e8(e, 0x0F); e8(e, 0x80 | cc); e32(e, 0); return e->p - 4; }
+static uint8_t* jmp32(Emit* e) { e8(e, 0xE9); e32(e, 0); return e->p - 4; }
+static void patch32_to(uint8_t* at, uint8_t* target) {
+  int32_t rel = (int32_t)(target - (at + 4));
+  memcpy(at, &rel, 4);
+}
+
+// Instrução pode ser traduzida? (terminadoras também contam)
+static int jit_translatable(const Chip8Decoded* d) {
+  switch (d->op) {
+    case CHIP8_OP_8XY4: case CHIP8_OP_8XY5: case CHIP8_OP_8XY7:
+      // A ordem de escrita de VF no interpretador importa quando X ou Y é F: deixa para ele
+      return d->x != 0xF && d->y != 0xF;
+    case CHIP8_OP_8XY6: case CHIP8_OP_8XYE:
+      return d->x != 0xF;
+    case CHIP8_OP_UNDECODED: case CHIP8_OP_FX0A: case CHIP8_OP_FX33: case CHIP8_OP_FX55:
+      return 0;
+    default:
+      return 1;
+  }
+}
+
+// Handler do interpretador chamado pelo código nativo (DXYN, 00E0, FX65), ou NULL
+static JitHandler jit_handler(const Chip8Decoded* d, uint8_t quirks) {
+  switch (d->op) {
+    case CHIP8_OP_00E0: return inst_00E0;
+    case CHIP8_OP_DXYN: return (quirks & CHIP8_QUIRK_CLIP) ? inst_DXYN_clip : inst_DXYN;
+    case CHIP8_OP_FX65: return (quirks & CHIP8_QUIRK_LOAD_STORE_I) ? inst_FX65_inc : inst_FX65;
+    default: return NULL;
+  }
+}
+
+static int jit_terminator(const Chip8Decoded* d) {
+  switch (d->op) {
+    case CHIP8_OP_00EE: case CHIP8_OP_1NNN: case CHIP8_OP_2NNN: case CHIP8_OP_BNNN:
+    case CHIP8_OP_3XKK: case CHIP8_OP_4XKK: case CHIP8_OP_5XY0: case CHIP8_OP_9XY0:
+    case CHIP8_OP_EX9E: case CHIP8_OP_EXA1:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+// Registradores V[] lidos ou escritos pela instrução (máscara de 16 bits)
+static uint16_t jit_regs_used(const Chip8Decoded* d, uint8_t quirks) {
+  uint16_t x = 1u << d->x, y = 1u << d->y, f = 1u << 0xF;
+  switch (d->op) {
+    case CHIP8_OP_3XKK: case CHIP8_OP_4XKK: case CHIP8_OP_6XKK: case CHIP8_OP_7XKK:
+    case CHIP8_OP_EX9E: case CHIP8_OP_EXA1: case CHIP8_OP_FX07: case CHIP8_OP_FX15:
+    case CHIP8_OP_FX18: case CHIP8_OP_FX1E: case CHIP8_OP_FX29:
+      return x;
+    case CHIP8_OP_5XY0: case CHIP8_OP_9XY0:
+    case CHIP8_OP_8XY0: case CHIP8_OP_8XY1: case CHIP8_OP_8XY2: case CHIP8_OP_8XY3:
+      return x | y;
+    case CHIP8_OP_8XY4: case CHIP8_OP_8XY5: case CHIP8_OP_8XY7:
+      return x | y | f;
+    case CHIP8_OP_8XY6: case CHIP8_OP_8XYE:
+      return (quirks & CHIP8_QUIRK_SHIFT_VY) ? x | y | f : x | f;
+    case CHIP8_OP_BNNN:
+      return (quirks & CHIP8_QUIRK_JUMP_VX) ? x : 1u;
+    default:
+      return 0;
+  }
+}
+
+// Compara a condição de um salto condicional; devolve o código de condição x86 em que ele PULA
+static uint8_t emit_skip_cond(Emit* e, const Chip8Decoded* d, const int8_t* host) {
+  int hx = host[d->x], hy = host[d->y];
+  switch (d->op) {
+    case CHIP8_OP_3XKK: alu_ri(e, IMM_CMP, hx, d->kk); return CC_E;
+    case CHIP8_OP_4XKK: alu_ri(e, IMM_CMP, hx, d->kk); return CC_NE;
+    case CHIP8_OP_5XY0: alu_rr(e, ALU_CMP, hx, hy); return CC_E;
+    case CHIP8_OP_9XY0: alu_rr(e, ALU_CMP, hx, hy); return CC_NE;
+    default: // EX9E / EXA1
+      alu_rr(e, ALU_MOV, RAX, hx);
+      alu_ri(e, IMM_AND, RAX, 0x0F);
+      e8(e, 0x0F); e8(e, 0xB6); e8(e, 0x84); e8(e, 0x07); // movzx eax, byte [rdi + rax + keypad]
+      e32(e, (uint32_t)OFF_KEYPAD);
+      e8(e, 0x85); e8(e, 0xC0); // test eax, eax
+      return d->op == CHIP8_OP_EX9E ? CC_NE : CC_E;
+  }
+}
+
+static int jit_is_skip(const Chip8Decoded* d) {
+  return d->op == CHIP8_OP_3XKK || d->op == CHIP8_OP_4XKK || d->op == CHIP8_OP_5XY0 ||
+         d->op == CHIP8_OP_9XY0 || d->op == CHIP8_OP_EX9E || d->op == CHIP8_OP_EXA1;
+}
+
+// Chama handler(chip8, opcode) com V[] na estrutura: o handler lê e escreve os
+// registradores lá, e os caller-saved do host não sobrevivem à chamada
+static void emit_call(Emit* e, JitHandler handler, uint16_t opcode, const int8_t* host, int nregs) {
+  for (int v = 0; v < 16; v++) {
+    if (host[v] >= 0) store8(e, host[v], OFF_V + v);
+  }
+  // Na chamada a pilha precisa estar alinhada em 16: o endereço de retorno e os
+  // callee-saved do prólogo já estão nela
+  int pad = (nregs > JIT_CALLER_SAVED ? nregs - JIT_CALLER_SAVED : 0) % 2 == 0;
+  push_r(e, RDI);
+  push_r(e, RSI);
+  if (pad) { e8(e, 0x48); e8(e, 0x83); e8(e, 0xEC); e8(e, 0x08); } // sub rsp, 8
+  mov_ri(e, RSI, opcode);
+  mov_rax_imm64(e, (uint64_t)(uintptr_t)handler);
+  e8(e, 0xFF); e8(e, 0xD0); // call rax
+  if (pad) { e8(e, 0x48); e8(e, 0x83); e8(e, 0xC4); e8(e, 0x08); } // add rsp, 8
+  pop_r(e, RSI);
+  pop_r(e, RDI);
+  for (int v = 0; v < 16; v++) {
+    if (host[v] >= 0) load8(e, host[v], OFF_V + v);
+  }
+}
+
+// Saída antecipada pendente: PC a gravar quando o orçamento acabar naquele ponto
+typedef struct {
+  uint8_t* at;
+  uint16_t pc;
+} JitExit;
+
+typedef struct {
+  Emit e;
+  JitExit exits[JIT_MAX_BLOCK * 2];
+  int n_exits;
+} JitCtx;
+
+// Consome um ciclo; se o orçamento acabou, sai do bloco retomando em resume_pc
+static void consume(JitCtx* ctx, uint16_t resume_pc) {
+  Emit* e = &ctx->e;
+  e8(e, 0xFF); e8(e, 0xCE); // dec esi
+  ctx->exits[ctx->n_exits].at = jcc32(e, CC_E);
+  ctx->exits[ctx->n_exits].pc = resume_pc;
+  ctx->n_exits++;
+}
+
+// Traduz o bloco que começa em start; devolve 0 se a primeira instrução não é traduzível
+static int jit_compile(Chip8Jit* jit, const Chip8* chip8, uint16_t start) {
+  Chip8Decoded insts[JIT_MAX_BLOCK];
+  uint8_t fused[JIT_MAX_BLOCK];  // 1 = salto condicional seguido de 1NNN (vira um desvio dentro do bloco)
+  int n = 0;
+  uint16_t used = 0;
+  int8_t host[16];
+  int nregs = 0;
+  int n_calls = 0;
+  memset(host, -1, sizeof(host));
+
+  // 1) Descobre a extensão do bloco e aloca registradores
+  uint16_t addr = start;
+  while (n < JIT_MAX_BLOCK && addr < 4096 - 1) {
+    Chip8Decoded d = chip8_decode((chip8->memory[addr] << 8) | chip8->memory[addr + 1]);
+    if (!jit_translatable(&d)) {
+      break;
+    }
+    uint16_t regs = jit_regs_used(&d, chip8->quirks);
+    int extra = 0;
+    for (int v = 0; v < 16; v++) {
+      if ((regs & (1u << v)) && !(used & (1u << v))) extra++;
+    }
+    if (nregs + extra > JIT_HOST_REGS) {
+      break;
+    }
+    for (int v = 0; v < 16; v++) {
+      if ((regs & (1u << v)) && !(used & (1u << v))) host[v] = host_regs[nregs++];
+    }
+    used |= regs;
+    if (jit_handler(&d, chip8->quirks)) n_calls++;
+    fused[n] = 0;
+    insts[n++] = d;
+    addr += 2;
+
+    // Idioma "SE/SNE + JP": o par vira um desvio condicional e o bloco continua
+    if (jit_is_skip(&d) && n < JIT_MAX_BLOCK && addr < 4096 - 1) {
+      Chip8Decoded j = chip8_decode((chip8->memory[addr] << 8) | chip8->memory[addr + 1]);
+      if (j.op == CHIP8_OP_1NNN) {
+        fused[n - 1] = 1;
+        fused[n] = 0;
+        insts[n++] = j;
+        addr += 2;
+        continue;
+      }
+    }
+    if (jit_terminator(&d)) {
+      break;
+    }
+  }
+  if (n == 0) {
+    return 0;
+  }
+
+  if (jit->code_used + JIT_BLOCK_BYTES(n) + (size_t)n_calls * JIT_CALL_BYTES > JIT_CODE_SIZE) {
+    chip8_jit_flush(jit); // Buffer cheio: recomeça do zero
+  }
+
+  JitCtx ctx;
+  ctx.e.p = jit->code + jit->code_used;
+  ctx.n_exits = 0;
+  Emit* e = &ctx.e;
+  // Blocos começam em 32 bytes: um laço curto não fica com o salto cruzando a
+  // fronteira (a vazão dele dependeria do tamanho dos blocos traduzidos antes)
+  while ((uintptr_t)e->p & (JIT_BLOCK_ALIGN - 1)) e8(e, 0xCC); // int3
+  uint8_t* entry = e->p;
+  uint8_t* to_epilogue[JIT_MAX_BLOCK];
+  int n_to_epilogue = 0;
+
+  // 2) Prólogo: salva só os registradores callee-saved usados e carrega V[]
+  for (int k = JIT_CALLER_SAVED; k < nregs; k++) push_r(e, host_regs[k]);
+  for (int v = 0; v < 16; v++) {
+    if (host[v] >= 0) load8(e, host[v], OFF_V + v);
+  }
+  uint8_t* loop_top = e->p;
+
+  // 3) Corpo
+  for (int i = 0; i < n; i++) {
+    const Chip8Decoded* d = &insts[i];
+    uint16_t pc_next = (uint16_t)(start + 2 * (i + 1));
+    int hx = host[d->x], hy = host[d->y], hf = host[0xF];
+    int last = (i + 1 == n);
+
+    if (fused[i]) {
+      // Pula (PC + 4, segue no bloco) ou executa o JP da instrução seguinte
+      const Chip8Decoded* jp = &insts[i + 1];
+      uint16_t after = (uint16_t)(pc_next + 2);
+      uint8_t* skipped = jcc32(e, emit_skip_cond(e, d, host));
+      consume(&ctx, pc_next);
+      if (jp->nnn == start) {
+        consume(&ctx, start);
+        patch32_to(jmp32(e), loop_top);
+      } else {
+        e8(e, 0xFF); e8(e, 0xCE); // dec esi
+        store16_imm(e, OFF_PC, jp->nnn);
+        to_epilogue[n_to_epilogue++] = jmp32(e);
+      }
+      patch32_to(skipped, e->p);
+      i++;
+      if (i + 1 < n) {
+        consume(&ctx, after);
+      } else {
+        e8(e, 0xFF); e8(e, 0xCE); // dec esi
+        store16_imm(e, OFF_PC, after);
+      }
+      continue;
+    }
+
+    switch (d->op) {
+      case CHIP8_OP_NOP: break;
+      case CHIP8_OP_6XKK: mov_ri(e, hx, d->kk); break;
+      case CHIP8_OP_7XKK: alu_ri(e, IMM_ADD, hx, d->kk); alu_ri(e, IMM_AND, hx, 0xFF); break;
+      case CHIP8_OP_8XY0: alu_rr(e, ALU_MOV, hx, hy); break;
+      case CHIP8_OP_8XY1: alu_rr(e, ALU_OR, hx, hy); break;
+      case CHIP8_OP_8XY2: alu_rr(e, ALU_AND, hx, hy); break;
+      case CHIP8_OP_8XY3: alu_rr(e, ALU_XOR, hx, hy); break;
+      case CHIP8_OP_8XY4: // soma de 9 bits: carry = bit 8
+        alu_rr(e, ALU_ADD, hx, hy);
+        alu_rr(e, ALU_MOV, hf, hx);
+        shift_ri(e, SH_SHR, hf, 8);
+        alu_ri(e, IMM_AND, hx, 0xFF);
+        break;
+      case CHIP8_OP_8XY5: // VF = !(Vx - Vy < 0)
+      case CHIP8_OP_8XY7: // VF = !(Vy - Vx < 0)
+        alu_rr(e, ALU_MOV, RAX, d->op == CHIP8_OP_8XY5 ? hx : hy);
+        alu_rr(e, ALU_SUB, RAX, d->op == CHIP8_OP_8XY5 ? hy : hx);
+        alu_rr(e, ALU_MOV, hx, RAX);
+        alu_ri(e, IMM_AND, hx, 0xFF);
+        shift_ri(e, SH_SHR, RAX, 31);
+        alu_ri(e, IMM_XOR, RAX, 1);
+        alu_rr(e, ALU_MOV, hf, RAX);
+        break;
+      case CHIP8_OP_8XY6:
+        if (chip8->quirks & CHIP8_QUIRK_SHIFT_VY) {
+          // Vy pode ser VF: lê antes de escrever qualquer um dos dois
+          alu_rr(e, ALU_MOV, RAX, hy);
+          alu_rr(e, ALU_MOV, hx, RAX);
+          shift_ri(e, SH_SHR, hx, 1);
+          alu_ri(e, IMM_AND, RAX, 1);
+          alu_rr(e, ALU_MOV, hf, RAX);
+          break;
+        }
+        alu_rr(e, ALU_MOV, hf, hx);
+        alu_ri(e, IMM_AND, hf, 1);
+        shift_ri(e, SH_SHR, hx, 1);
+        break;
+      case CHIP8_OP_8XYE:
+        if (chip8->quirks & CHIP8_QUIRK_SHIFT_VY) {
+          alu_rr(e, ALU_MOV, RAX, hy);
+          alu_rr(e, ALU_MOV, hx, RAX);
+          shift_ri(e, SH_SHL, hx, 1);
+          alu_ri(e, IMM_AND, hx, 0xFF);
+          shift_ri(e, SH_SHR, RAX, 7);
+          alu_rr(e, ALU_MOV, hf, RAX);
+          break;
+        }
+        alu_rr(e, ALU_MOV, hf, hx);
+        shift_ri(e, SH_SHR, hf, 7);
+        shift_ri(e, SH_SHL, hx, 1);
+        alu_ri(e, IMM_AND, hx, 0xFF);
+        break;
+      case CHIP8_OP_ANNN: store16_imm(e, OFF_I, d->nnn); break;
+      case CHIP8_OP_FX07: load8(e, hx, OFF_DT); break;
+      case CHIP8_OP_FX15: store8(e, hx, OFF_DT); break;
+      case CHIP8_OP_FX18: store8(e, hx, OFF_ST); break;
+      case CHIP8_OP_FX1E:
+        load16(e, RAX, OFF_I);
+        alu_rr(e, ALU_ADD, RAX, hx);
+        store16(e, RAX, OFF_I);
+        break;
+      case CHIP8_OP_FX29:
+        alu_rr(e, ALU_MOV, RAX, hx);
+        alu_ri(e, IMM_AND, RAX, 0x0F);
+        e8(e, 0x8D); e8(e, 0x04); e8(e, 0x80); // lea eax, [rax + rax*4]
+        alu_ri(e, IMM_ADD, RAX, 0x050);
+        store16(e, RAX, OFF_I);
+        break;
+
+      case CHIP8_OP_00E0: case CHIP8_OP_DXYN: case CHIP8_OP_FX65:
+        emit_call(e, jit_handler(d, chip8->quirks), d->opcode, host, nregs);
+        break;
+
+      // Terminadoras: definem o PC
+      case CHIP8_OP_1NNN:
+        if (d->nnn == start) {
+          // Laço sobre o próprio bloco: continua nativo enquanto houver orçamento
+          consume(&ctx, start);
+          patch32_to(jmp32(e), loop_top);
+          continue;
+        }
+        store16_imm(e, OFF_PC, d->nnn);
+        break;
+      case CHIP8_OP_BNNN:
+        alu_rr(e, ALU_MOV, RAX, (chip8->quirks & CHIP8_QUIRK_JUMP_VX) ? hx : host[0]);
+        alu_ri(e, IMM_ADD, RAX, d->nnn);
+        store16(e, RAX, OFF_PC);
+        break;
+      case CHIP8_OP_2NNN: {
+        load8(e, RAX, OFF_SP);
+        alu_ri(e, IMM_CMP, RAX, 16);
+        uint8_t* full = jcc8(e, CC_AE);
+        e8(e, 0x66); e8(e, 0xC7); e8(e, 0x84); e8(e, 0x47); // mov word [rdi + rax*2 + stack], imm16
+        e32(e, (uint32_t)OFF_STACK); e16(e, pc_next);
+        alu_ri(e, IMM_ADD, RAX, 1);
+        store8(e, RAX, OFF_SP);
+        store16_imm(e, OFF_PC, d->nnn);
+        uint8_t* done = jmp8(e);
+        patch8(e, full);
+        store16_imm(e, OFF_PC, pc_next);
+        patch8(e, done);
+        break;
+      }
+      case CHIP8_OP_00EE: {
+        load8(e, RAX, OFF_SP);
+        e8(e, 0x85); e8(e, 0xC0); // test eax, eax
+        uint8_t* empty = jcc8(e, CC_E);
+        alu_ri(e, IMM_SUB, RAX, 1);
+        store8(e, RAX, OFF_SP);
+        e8(e, 0x0F); e8(e, 0xB7); e8(e, 0x8C); e8(e, 0x47); // movzx ecx, word [rdi + rax*2 + stack]
+        e32(e, (uint32_t)OFF_STACK);
+        store16(e, RCX, OFF_PC);
+        uint8_t* done = jmp8(e);
+        patch8(e, empty);
+        store16_imm(e, OFF_PC, pc_next);
+        patch8(e, done);
+        break;
+      }
+      case CHIP8_OP_3XKK: case CHIP8_OP_4XKK: case CHIP8_OP_5XY0:
+      case CHIP8_OP_9XY0: case CHIP8_OP_EX9E: case CHIP8_OP_EXA1: {
+        // PC = next, ou next + 2 se a condição de pulo vale (mov não altera as flags)
+        uint8_t skip_cc = emit_skip_cond(e, d, host);
+        mov_ri(e, RAX, pc_next);
+        uint8_t* over = jcc8(e, skip_cc ^ 1);
+        mov_ri(e, RAX, (uint16_t)(pc_next + 2));
+        patch8(e, over);
+        store16(e, RAX, OFF_PC);
+        break;
+      }
+      default:
+        break;
+    }
+
+    if (!last) {
+      consume(&ctx, pc_next);
+    } else {
+      e8(e, 0xFF); e8(e, 0xCE); // dec esi
+      if (!jit_terminator(d)) {
+        store16_imm(e, OFF_PC, pc_next); // Bloco cortado (instrução não traduzível ou limite)
+      }
+    }
+  }
+
+  // 4) Epílogo: devolve V[] à estrutura e retorna o orçamento restante
+  uint8_t* epilogue = e->p;
+  for (int k = 0; k < n_to_epilogue; k++) patch32_to(to_epilogue[k], epilogue);
+  for (int v = 0; v < 16; v++) {
+    if (host[v] >= 0) store8(e, host[v], OFF_V + v);
+  }
+  for (int k = nregs - 1; k >= JIT_CALLER_SAVED; k--) pop_r(e, host_regs[k]);
+  alu_rr(e, ALU_MOV, RAX, RSI);
+  e8(e, 0xC3); // ret
+
+  // 5) Saídas antecipadas: gravam o PC onde retomar e vão ao epílogo
+  for (int k = 0; k < ctx.n_exits; k++) {
+    patch32_to(ctx.exits[k].at, e->p);
+    store16_imm(e, OFF_PC, ctx.exits[k].pc);
+    patch32_to(jmp32(e), epilogue);
+  }
+
+  jit->code_used = (size_t)(e->p - jit->code);
+  jit->blocks[start].fn = (JitBlockFn)(void*)entry;
+  jit->blocks[start].state = JIT_COMPILED;
+  jit->blocks[start].self_loop = 0;
+  jit->blocks[start].sets_timer = 0;
+  jit->blocks[start].length = (uint8_t)n;
+  for (int i = 0; i < n; i++) {
+    if (insts[i].op == CHIP8_OP_1NNN && insts[i].nnn == start) jit->blocks[start].self_loop = 1;
+    if (insts[i].op == CHIP8_OP_FX15 || insts[i].op == CHIP8_OP_FX18) jit->blocks[start].sets_timer = 1;
+  }
+  memset(&jit->covered[start], 1, (size_t)(addr - start));
+  return 1;
+}
+
+#endif // JIT_X64
+
+// Corpo de chip8_jit_run e chip8_jit_run_until_timer: devolve os ciclos não executados
+static uint32_t jit_run(Chip8Jit* jit, Chip8* chip8, uint32_t cycles, int until_timer) {
+#ifdef JIT_X64
+  if (jit->code && chip8->machine == CHIP8_MACHINE_CHIP8) {
+    // Os blocos já traduzidos embutem as quirks (8XY6/8XYE/BNNN): outra combinação, outra cache
+    if (chip8->quirks != jit->quirks) {
+      chip8_jit_flush(jit);
+      jit->quirks = chip8->quirks;
+    }
+    while (cycles > 0) {
+      uint16_t pc = chip8->pc;
+      if (pc < 4096 - 1) {
+        JitBlock* b = &jit->blocks[pc];
+        if (b->state == JIT_EMPTY) {
+          b->state = JIT_INTERP;
+          jit_compile(jit, chip8, pc);
+          b = &jit->blocks[pc]; // jit_compile pode ter esvaziado a cache
+        }
+        if (b->state == JIT_COMPILED && until_timer && b->sets_timer) {
+          // O código nativo não para no meio do bloco: o interpretador executa as
+          // instruções dele uma a uma (nenhuma escreve na memória)
+          uint16_t end = (uint16_t)(pc + 2 * b->length);
+          do {
+            if (chip8_run_until_timer(chip8, 1) == 0) {
+              return cycles; // Parou antes de um FX15/FX18 que liga um temporizador
+            }
+            cycles--;
+          } while (cycles > 0 && chip8->pc >= pc && chip8->pc < end);
+          continue;
+        }
+        if (b->state == JIT_COMPILED) {
+          // Laço ocioso (espera do delay_timer, salto para si mesmo): não gira no código nativo
+#ifndef CHIP8_NO_IDLE_SKIP
+          if (b->self_loop && chip8_skip_idle(chip8, cycles)) {
+            return 0;
+          }
+#endif
+          cycles = b->fn(chip8, cycles);
+          continue;
+        }
+      }
+
+      // Instrução não traduzível: executa uma instrução pela tabela pré-decodificada
+      // PC fora dos 4 KB: a busca faz wrap-around como no interpretador (um FX55 ali também escreve)
+      uint16_t opcode = (uint16_t)((chip8->memory[pc & 0x0FFF] << 8) | chip8->memory[(pc + 1) & 0x0FFF]);
+      uint16_t i_before = chip8->I; // Com CHIP8_QUIRK_LOAD_STORE_I, FX55 avança I
+      if (chip8_idle(chip8) == CHIP8_IDLE_KEY_WAIT) {
+        // FX0A sem tecla: as teclas não mudam durante a chamada, então ele espera até
+        // o fim do orçamento (de uma vez no interpretador, que também pula a espera)
+        chip8_run(chip8, cycles);
+        return 0;
+      }
+      chip8_run(chip8, 1);
+      cycles--;
+
+      // FX33/FX55 escreveram sobre código traduzido? Descarta a cache
+      if ((opcode & 0xF0FF) == 0xF033 || (opcode & 0xF0FF) == 0xF055) {
+        uint32_t len = ((opcode & 0x00FF) == 0x33) ? 3 : ((opcode & 0x0F00) >> 8) + 1;
+        for (uint32_t k = 0; k < len; k++) {
+          if (jit->covered[(i_before + k) & 0x0FFF]) {
+            chip8_jit_flush(jit);
+            break;
+          }
+        }
+      }
+    }
+    return 0;
+  }
+#else
+  (void)jit;
+#endif
+  if (until_timer) {
+    return cycles - chip8_run_until_timer(chip8, cycles);
+  }
+  chip8_run(chip8, cycles);
+  return 0;
+}
+
+void chip8_jit_run(Chip8Jit* jit, Chip8* chip8, uint32_t cycles) {
+  jit_run(jit, chip8, cycles, 0);
+}
+
+uint32_t chip8_jit_run_until_timer(Chip8Jit* jit, Chip8* chip8, uint32_t cycles) {
+  return cycles - jit_run(jit, chip8, cycles, 1);
+}
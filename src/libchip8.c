@@ -0,0 +1,156 @@
+#include <stdlib.h>
+#include <string.h>
+#include "libchip8.h"
+#include "chip8.h"
+#include "machine.h"
+#include "sched.h"
+
+// Os valores públicos são os internos: a API só os repassa
+_Static_assert(CHIP8_CORE_MACHINE_CHIP8 == CHIP8_MACHINE_CHIP8 && CHIP8_CORE_MACHINE_SCHIP == CHIP8_MACHINE_SCHIP &&
+                   CHIP8_CORE_MACHINE_XOCHIP == CHIP8_MACHINE_XOCHIP,
+               "modelos da API diferentes de Chip8Machine");
+_Static_assert(CHIP8_CORE_QUIRK_SHIFT_VY == CHIP8_QUIRK_SHIFT_VY && CHIP8_CORE_QUIRK_LOAD_STORE_I == CHIP8_QUIRK_LOAD_STORE_I &&
+                   CHIP8_CORE_QUIRK_JUMP_VX == CHIP8_QUIRK_JUMP_VX && CHIP8_CORE_QUIRK_CLIP == CHIP8_QUIRK_CLIP,
+               "quirks da API diferentes de CHIP8_QUIRK_*");
+
+#define CORE_ERR_NO_ROM -100 // Nenhuma imagem (data NULL)
+
+struct Chip8Core {
+  Chip8 chip8;
+  Chip8Sched sched;
+  Chip8Machine machine;
+  uint32_t clock_hz;
+};
+
+// Máquina recém-ligada do modelo do núcleo, com o escalonador no tempo zero. A
+// extensão do modelo é reaproveitada: o ponteiro de chip8_core_framebuffer segue
+// válido. A cache de instruções também, esvaziada (a memória mudou)
+static void reset(Chip8Core* core) {
+  Chip8Ext* ext = core->chip8.ext;
+  Chip8Decoded* decoded = core->chip8.decoded;
+  chip8_init(&core->chip8);
+  core->chip8.ext = ext;
+  core->chip8.decoded = decoded;
+  if (decoded) {
+    memset(decoded, 0, 4096 * sizeof(Chip8Decoded));
+  }
+  core->chip8.machine = (uint8_t)core->machine;
+  chip8_set_machine(&core->chip8, core->machine); // Não aloca: só zera a extensão
+  chip8_sched_init(&core->sched, core->clock_hz, 0);
+}
+
+uint32_t chip8_core_api_version(void) {
+  return CHIP8_CORE_API_VERSION;
+}
+
+Chip8Core* chip8_core_create(uint32_t clock_hz, int machine) {
+  if (clock_hz < CHIP8_CLOCK_MIN_HZ || clock_hz > CHIP8_CLOCK_MAX_HZ || machine < 0 || machine >= CHIP8_MACHINE_COUNT) {
+    return NULL;
+  }
+  Chip8Core* core = malloc(sizeof(*core)); // ~4,6 KB; a extensão do modelo e a tabela pré-decodificada à parte
+  if (!core) {
+    return NULL;
+  }
+  core->machine = (Chip8Machine)machine;
+  core->clock_hz = clock_hz;
+  core->chip8.ext = NULL;
+  core->chip8.decoded = NULL;
+  core->chip8.machine = CHIP8_MACHINE_CHIP8;
+  if (chip8_machine_ext(&core->chip8, core->machine) != 0) {
+    free(core);
+    return NULL;
+  }
+  reset(core);
+  return core;
+}
+
+void chip8_core_destroy(Chip8Core* core) {
+  if (core) {
+    chip8_release(&core->chip8);
+  }
+  free(core);
+}
+
+int chip8_core_load_rom(Chip8Core* core, const uint8_t* data, size_t size) {
+  if (!data) {
+    return CORE_ERR_NO_ROM;
+  }
+  reset(core);
+  return chip8_load_rom_image(&core->chip8, data, size);
+}
+
+const char* chip8_core_error(int code) {
+  return code == CORE_ERR_NO_ROM ? "Nenhuma imagem de ROM" : chip8_load_error(code);
+}
+
+void chip8_core_set_quirks(Chip8Core* core, uint8_t quirks) {
+  core->chip8.quirks = (uint8_t)(quirks & (CHIP8_QUIRK_COUNT - 1));
+}
+
+uint8_t chip8_core_quirks(const Chip8Core* core) {
+  return core->chip8.quirks;
+}
+
+void chip8_core_run_cycles(Chip8Core* core, uint64_t n) {
+  chip8_sched_run(&core->sched, &core->chip8, n);
+}
+
+void chip8_core_run_frame(Chip8Core* core) {
+  chip8_sched_run(&core->sched, &core->chip8, chip8_sched_until_tick(&core->sched));
+}
+
+uint64_t chip8_core_frames(const Chip8Core* core) {
+  return core->sched.ticks;
+}
+
+uint64_t chip8_core_instructions(const Chip8Core* core) {
+  return core->sched.instructions;
+}
+
+void chip8_core_set_keypad(Chip8Core* core, uint16_t keys) {
+  chip8_set_keys(&core->chip8, keys);
+}
+
+int chip8_core_sound_on(const Chip8Core* core) {
+  return core->chip8.sound_timer > 0;
+}
+
+const uint64_t* chip8_core_framebuffer(const Chip8Core* core, int plane, uint32_t* words_per_row) {
+  const Chip8* chip8 = &core->chip8;
+  if (chip8->machine == CHIP8_MACHINE_CHIP8) {
+    if (plane != 0) {
+      return NULL;
+    }
+    if (words_per_row) {
+      *words_per_row = 1;
+    }
+    return chip8->display;
+  }
+  if (plane < 0 || plane >= (chip8->machine == CHIP8_MACHINE_XOCHIP ? CHIP8_PLANES : 1)) {
+    return NULL;
+  }
+  if (words_per_row) {
+    *words_per_row = 2;
+  }
+  return &chip8->ext->screen[plane][0][0];
+}
+
+int chip8_core_width(const Chip8Core* core) {
+  return chip8_screen_width(&core->chip8);
+}
+
+int chip8_core_height(const Chip8Core* core) {
+  return chip8_screen_height(&core->chip8);
+}
+
+uint32_t chip8_core_display_gen(const Chip8Core* core) {
+  return core->chip8.display_gen;
+}
+
+uint32_t chip8_core_take_dirty_rows(Chip8Core* core) {
+  return chip8_take_dirty_rows(&core->chip8);
+}
+
+uint64_t chip8_core_display_hash(const Chip8Core* core) {
+  return chip8_display_hash(&core->chip8);
+}
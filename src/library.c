@@ -0,0 +1,613 @@
+#define _POSIX_C_SOURCE 200809L // opendir, mmap, fstat
+
+#include <ctype.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "library.h"
+
+#define NOTES_MAX 65536 // Bytes lidos de cada nota .txt
+
+enum {
+  LIBRARY_ERR_DIR = -1,
+  LIBRARY_ERR_MEMORY = -2,
+  LIBRARY_ERR_OPEN = -3,
+  LIBRARY_ERR_CHANGED = -4,
+  LIBRARY_ERR_MAP = -5,
+  LIBRARY_ERR_SIZE = -6
+};
+
+const char* chip8_library_error(int code) {
+  switch (code) {
+    case 0:                   return "Sucesso";
+    case LIBRARY_ERR_DIR:     return "Diretório de ROMs não encontrado";
+    case LIBRARY_ERR_MEMORY:  return "Memória insuficiente";
+    case LIBRARY_ERR_OPEN:    return "Não foi possível abrir a ROM";
+    case LIBRARY_ERR_CHANGED: return "A ROM mudou desde a indexação (abra a biblioteca de novo)";
+    case LIBRARY_ERR_MAP:     return "Não foi possível mapear a ROM";
+    case LIBRARY_ERR_SIZE:    return "ROM muito grande (máximo 3584 bytes; 65024 no XO-CHIP)";
+    default:                  return "Erro desconhecido";
+  }
+}
+
+// ---------------------------------------------------------------------------
+// SHA-1 (FIPS 180-4)
+
+static uint32_t rol32(uint32_t v, int n) {
+  return (v << n) | (v >> (32 - n));
+}
+
+static void sha1_block(uint32_t h[5], const uint8_t* p) {
+  uint32_t w[80];
+  for (int i = 0; i < 16; i++) {
+    w[i] = ((uint32_t)p[4 * i] << 24) | ((uint32_t)p[4 * i + 1] << 16) | ((uint32_t)p[4 * i + 2] << 8) | p[4 * i + 3];
+  }
+  for (int i = 16; i < 80; i++) {
+    w[i] = rol32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+  }
+  uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+  for (int i = 0; i < 80; i++) {
+    uint32_t f, k;
+    if (i < 20) {
+      f = (b & c) | (~b & d);
+      k = 0x5A827999;
+    } else if (i < 40) {
+      f = b ^ c ^ d;
+      k = 0x6ED9EBA1;
+    } else if (i < 60) {
+      f = (b & c) | (b & d) | (c & d);
+      k = 0x8F1BBCDC;
+    } else {
+      f = b ^ c ^ d;
+      k = 0xCA62C1D6;
+    }
+    uint32_t t = rol32(a, 5) + f + e + k + w[i];
+    e = d;
+    d = c;
+    c = rol32(b, 30);
+    b = a;
+    a = t;
+  }
+  h[0] += a;
+  h[1] += b;
+  h[2] += c;
+  h[3] += d;
+  h[4] += e;
+}
+
+void chip8_sha1(const uint8_t* data, size_t len, uint8_t out[20]) {
+  uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+  size_t full = len / 64 * 64;
+  for (size_t i = 0; i < full; i += 64) {
+    sha1_block(h, data + i);
+  }
+  // Último bloco: resto, bit 1, zeros e o tamanho em bits (big-endian)
+  uint8_t tail[128] = {0};
+  size_t rest = len - full;
+  memcpy(tail, data + full, rest);
+  tail[rest] = 0x80;
+  size_t tail_len = rest < 56 ? 64 : 128;
+  uint64_t bits = (uint64_t)len * 8;
+  for (int i = 0; i < 8; i++) {
+    tail[tail_len - 1 - i] = (uint8_t)(bits >> (8 * i));
+  }
+  for (size_t i = 0; i < tail_len; i += 64) {
+    sha1_block(h, tail + i);
+  }
+  for (int i = 0; i < 5; i++) {
+    out[4 * i] = (uint8_t)(h[i] >> 24);
+    out[4 * i + 1] = (uint8_t)(h[i] >> 16);
+    out[4 * i + 2] = (uint8_t)(h[i] >> 8);
+    out[4 * i + 3] = (uint8_t)h[i];
+  }
+}
+
+void chip8_sha1_hex(const uint8_t sha1[20], char out[41]) {
+  static const char digits[] = "0123456789abcdef";
+  for (int i = 0; i < 20; i++) {
+    out[2 * i] = digits[sha1[i] >> 4];
+    out[2 * i + 1] = digits[sha1[i] & 0x0F];
+  }
+  out[40] = '\0';
+}
+
+// ---------------------------------------------------------------------------
+// Metadados: nome do arquivo e nota .txt
+
+static void copy_trimmed(char* out, size_t size, const char* s, size_t len) {
+  while (len > 0 && isspace((unsigned char)*s)) {
+    s++;
+    len--;
+  }
+  while (len > 0 && isspace((unsigned char)s[len - 1])) {
+    len--;
+  }
+  if (len >= size) {
+    len = size - 1;
+  }
+  for (size_t i = 0; i < len; i++) {
+    // Tabulações e quebras de linha separam campos no índice
+    out[i] = (s[i] == '\t' || s[i] == '\n' || s[i] == '\r') ? ' ' : s[i];
+  }
+  out[len] = '\0';
+}
+
+// "Pong [Paul Vervalin, 1990].ch8" -> título "Pong", autor "Paul Vervalin", ano 1990;
+// vale também para o último grupo entre parênteses ("Lunar Lander (Udo Pernisz, 1979)")
+static void parse_file_name(Chip8RomEntry* e) {
+  size_t len = strlen(e->file) - 4; // Sem ".ch8"
+  const char* name = e->file;
+  const char* open = NULL;
+  char close = 0;
+  if (len > 0 && (name[len - 1] == ']' || name[len - 1] == ')')) {
+    close = name[len - 1];
+    for (size_t i = len - 1; i-- > 0;) {
+      if (name[i] == (close == ']' ? '[' : '(')) {
+        open = name + i;
+        break;
+      }
+    }
+  }
+  if (!open || open == name) {
+    copy_trimmed(e->title, sizeof(e->title), name, len);
+    return;
+  }
+  copy_trimmed(e->title, sizeof(e->title), name, (size_t)(open - name));
+
+  const char* group = open + 1;
+  size_t group_len = (size_t)(name + len - 1 - group);
+  // ", AAAA" no fim do grupo (ou o grupo inteiro) é o ano
+  size_t author_len = group_len;
+  if (group_len >= 4) {
+    const char* y = group + group_len - 4;
+    if (isdigit((unsigned char)y[0]) && isdigit((unsigned char)y[1]) &&
+        isdigit((unsigned char)y[2]) && isdigit((unsigned char)y[3]) &&
+        (group_len == 4 || y[-1] == ' ' || y[-1] == ',')) {
+      e->year = (uint16_t)atoi(y);
+      author_len = group_len - 4;
+      while (author_len > 0 && (group[author_len - 1] == ' ' || group[author_len - 1] == ',')) {
+        author_len--;
+      }
+    }
+  }
+  copy_trimmed(e->author, sizeof(e->author), group, author_len);
+}
+
+// "Campo : valor" no início de uma linha (cabeçalho das notas da Revival Studios e outras)
+static int note_field(const char* notes, const char* field, char* out, size_t size) {
+  size_t field_len = strlen(field);
+  for (const char* line = notes; line && *line; line = strchr(line, '\n') ? strchr(line, '\n') + 1 : NULL) {
+    if (strncasecmp(line, field, field_len) != 0) {
+      continue;
+    }
+    const char* p = line + field_len;
+    while (*p == ' ' || *p == '\t') {
+      p++;
+    }
+    if (*p != ':') {
+      continue;
+    }
+    p++;
+    const char* end = strchr(p, '\n');
+    copy_trimmed(out, size, p, end ? (size_t)(end - p) : strlen(p));
+    return out[0] != '\0';
+  }
+  return 0;
+}
+
+// Teclas citadas depois de "key", "button", "press" ou "use", até o fim da frase:
+// dígitos e A-F maiúsculos isolados ("Key 1,2,3 or 9", "Button 2,4,6,8 will move")
+static uint16_t parse_key_hints(const char* notes) {
+  static const char* const words[] = {"key", "button", "press", "use"};
+  uint16_t mask = 0;
+  for (const char* p = notes; *p; p++) {
+    if (p != notes && isalnum((unsigned char)p[-1])) {
+      continue;
+    }
+    size_t w = 0;
+    for (; w < sizeof(words) / sizeof(words[0]); w++) {
+      if (strncasecmp(p, words[w], strlen(words[w])) == 0) {
+        break;
+      }
+    }
+    if (w == sizeof(words) / sizeof(words[0])) {
+      continue;
+    }
+    const char* q = p + strlen(words[w]);
+    while (isalpha((unsigned char)*q)) { // "keys", "pressing", "buttons"
+      q++;
+    }
+    for (int n = 0; n < 48 && q[n] && q[n] != '.' && q[n] != '\n'; n++) {
+      char ch = q[n];
+      int isolated = !isalnum((unsigned char)q[n + 1]) && (n == 0 || !isalnum((unsigned char)q[n - 1]));
+      if (!isolated) {
+        continue;
+      }
+      if (ch >= '0' && ch <= '9') {
+        mask |= (uint16_t)(1u << (ch - '0'));
+      } else if (ch >= 'A' && ch <= 'F') {
+        mask |= (uint16_t)(1u << (ch - 'A' + 10));
+      }
+    }
+  }
+  return mask;
+}
+
+static void parse_notes(Chip8RomEntry* e, const char* path) {
+  FILE* in = fopen(path, "rb");
+  if (!in) {
+    return;
+  }
+  char* notes = malloc(NOTES_MAX + 1);
+  if (!notes) {
+    fclose(in);
+    return;
+  }
+  size_t n = fread(notes, 1, NOTES_MAX, in);
+  fclose(in);
+  notes[n] = '\0';
+  for (size_t i = 0; i < n; i++) {
+    if (notes[i] == '\0') {
+      notes[i] = ' '; // Notas com bytes nulos (há uma no diretório games/)
+    }
+  }
+  note_field(notes, "Title", e->title, sizeof(e->title));
+  note_field(notes, "Author", e->author, sizeof(e->author));
+  e->key_hints = parse_key_hints(notes);
+  free(notes);
+}
+
+// ---------------------------------------------------------------------------
+// Índice
+
+static int has_ch8_suffix(const char* name) {
+  size_t len = strlen(name);
+  return len > 4 && strcasecmp(name + len - 4, ".ch8") == 0;
+}
+
+static int compare_files(const void* a, const void* b) {
+  return strcmp(((const Chip8RomEntry*)a)->file, ((const Chip8RomEntry*)b)->file);
+}
+
+static int compare_sha1(const void* a, const void* b) {
+  const Chip8RomEntry* x = a;
+  const Chip8RomEntry* y = b;
+  int c = memcmp(x->sha1, y->sha1, sizeof(x->sha1));
+  return c ? c : strcmp(x->file, y->file);
+}
+
+static int parse_hex_sha1(const char* hex, uint8_t out[20]) {
+  for (int i = 0; i < 40; i++) {
+    if (!isxdigit((unsigned char)hex[i])) {
+      return -1;
+    }
+  }
+  for (int i = 0; i < 20; i++) {
+    char byte[3] = {hex[2 * i], hex[2 * i + 1], '\0'};
+    out[i] = (uint8_t)strtoul(byte, NULL, 16);
+  }
+  return 0;
+}
+
+// Campos separados por tabulação: sha1 tamanho mtime mtime_nota teclas ano arquivo título autor
+static int parse_index_line(char* line, Chip8RomEntry* e) {
+  char* fields[9];
+  int n = 0;
+  for (char* p = line; n < 9; n++) {
+    fields[n] = p;
+    p = strchr(p, '\t');
+    if (!p) {
+      n++;
+      break;
+    }
+    *p++ = '\0';
+  }
+  if (n != 9 || parse_hex_sha1(fields[0], e->sha1) != 0) {
+    return -1;
+  }
+  fields[8][strcspn(fields[8], "\r\n")] = '\0';
+  e->size = (uint32_t)strtoul(fields[1], NULL, 10);
+  e->mtime = strtoll(fields[2], NULL, 10);
+  e->notes_mtime = strtoll(fields[3], NULL, 10);
+  e->key_hints = (uint16_t)strtoul(fields[4], NULL, 16);
+  e->year = (uint16_t)strtoul(fields[5], NULL, 10);
+  snprintf(e->file, sizeof(e->file), "%s", fields[6]);
+  snprintf(e->title, sizeof(e->title), "%s", fields[7]);
+  snprintf(e->author, sizeof(e->author), "%s", fields[8]);
+  e->image = NULL;
+  return 0;
+}
+
+// Entradas do índice gravado, ordenadas pelo nome do arquivo (NULL se não houver índice válido)
+static Chip8RomEntry* read_index(const char* path, uint32_t* count) {
+  *count = 0;
+  FILE* in = fopen(path, "r");
+  if (!in) {
+    return NULL;
+  }
+  char line[1024];
+  int version = 0;
+  if (!fgets(line, sizeof(line), in) || sscanf(line, "chip8index %d", &version) != 1 ||
+      version != CHIP8_LIBRARY_VERSION) {
+    fclose(in);
+    return NULL;
+  }
+  Chip8RomEntry* entries = NULL;
+  uint32_t capacity = 0;
+  while (fgets(line, sizeof(line), in)) {
+    if (*count == capacity) {
+      uint32_t grown = capacity ? capacity * 2 : 64;
+      Chip8RomEntry* bigger = realloc(entries, sizeof(Chip8RomEntry) * grown);
+      if (!bigger) {
+        break;
+      }
+      entries = bigger;
+      capacity = grown;
+    }
+    if (parse_index_line(line, &entries[*count]) == 0) {
+      (*count)++;
+    }
+  }
+  fclose(in);
+  qsort(entries, *count, sizeof(Chip8RomEntry), compare_files);
+  return entries;
+}
+
+// Grava em um temporário e renomeia: um índice interrompido no meio nunca é lido
+static int write_index(const Chip8Library* lib) {
+  char path[4200], tmp[4300];
+  snprintf(path, sizeof(path), "%s/%s", lib->dir, CHIP8_LIBRARY_INDEX);
+  snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+  FILE* out = fopen(tmp, "w");
+  if (!out) {
+    return -1;
+  }
+  fprintf(out, "chip8index %d\n", CHIP8_LIBRARY_VERSION);
+  for (uint32_t i = 0; i < lib->count; i++) {
+    const Chip8RomEntry* e = &lib->entries[i];
+    char hex[41];
+    chip8_sha1_hex(e->sha1, hex);
+    fprintf(out, "%s\t%u\t%lld\t%lld\t%04x\t%u\t%s\t%s\t%s\n", hex, e->size, (long long)e->mtime,
+            (long long)e->notes_mtime, e->key_hints, e->year, e->file, e->title, e->author);
+  }
+  if (fclose(out) != 0 || rename(tmp, path) != 0) {
+    remove(tmp);
+    return -1;
+  }
+  return 0;
+}
+
+// Mapeia a ROM; o tamanho e o mtime precisam ser os da entrada
+static int map_rom(const char* path, Chip8RomEntry* e, int check) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return LIBRARY_ERR_OPEN;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return LIBRARY_ERR_OPEN;
+  }
+  if (check && ((uint64_t)st.st_size != e->size || (int64_t)st.st_mtime != e->mtime)) {
+    close(fd);
+    return LIBRARY_ERR_CHANGED;
+  }
+  if (st.st_size > CHIP8_ROM_MAX_XO) {
+    close(fd);
+    return LIBRARY_ERR_SIZE;
+  }
+  e->size = (uint32_t)st.st_size;
+  e->mtime = (int64_t)st.st_mtime;
+  if (e->size == 0) {
+    close(fd);
+    e->image = (const uint8_t*)"";
+    return 0;
+  }
+  void* image = mmap(NULL, e->size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // O mapeamento continua válido sem o descritor
+  if (image == MAP_FAILED) {
+    return LIBRARY_ERR_MAP;
+  }
+  e->image = image;
+  return 0;
+}
+
+static void unmap_rom(Chip8RomEntry* e) {
+  if (e->image && e->size > 0) {
+    munmap((void*)e->image, e->size);
+  }
+  e->image = NULL;
+}
+
+int chip8_library_open(Chip8Library* lib, const char* dir) {
+  memset(lib, 0, sizeof(*lib));
+  snprintf(lib->dir, sizeof(lib->dir), "%s", dir);
+  DIR* d = opendir(dir);
+  if (!d) {
+    return LIBRARY_ERR_DIR;
+  }
+
+  char path[4500];
+  snprintf(path, sizeof(path), "%s/%s", dir, CHIP8_LIBRARY_INDEX);
+  uint32_t old_count;
+  Chip8RomEntry* old = read_index(path, &old_count);
+
+  uint32_t capacity = 0;
+  int status = 0;
+  struct dirent* ent;
+  while ((ent = readdir(d)) != NULL) {
+    if (!has_ch8_suffix(ent->d_name) || strlen(ent->d_name) >= sizeof(lib->entries[0].file)) {
+      continue;
+    }
+    snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+    struct stat st, notes_st;
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size > CHIP8_ROM_MAX_XO) {
+      continue;
+    }
+    if (lib->count == capacity) {
+      uint32_t grown = capacity ? capacity * 2 : 64;
+      Chip8RomEntry* bigger = realloc(lib->entries, sizeof(Chip8RomEntry) * grown);
+      if (!bigger) {
+        status = LIBRARY_ERR_MEMORY;
+        break;
+      }
+      lib->entries = bigger;
+      capacity = grown;
+    }
+    char notes_path[4500];
+    snprintf(notes_path, sizeof(notes_path), "%s/%.*s.txt", dir, (int)strlen(ent->d_name) - 4, ent->d_name);
+    int64_t notes_mtime = stat(notes_path, &notes_st) == 0 ? (int64_t)notes_st.st_mtime : 0;
+
+    // Mesma ROM e mesma nota do índice: reaproveita sem ler nada
+    Chip8RomEntry* e = &lib->entries[lib->count];
+    Chip8RomEntry key;
+    snprintf(key.file, sizeof(key.file), "%s", ent->d_name);
+    const Chip8RomEntry* cached = old ? bsearch(&key, old, old_count, sizeof(Chip8RomEntry), compare_files) : NULL;
+    if (cached && cached->size == (uint64_t)st.st_size && cached->mtime == (int64_t)st.st_mtime &&
+        cached->notes_mtime == notes_mtime) {
+      *e = *cached;
+      lib->count++;
+      continue;
+    }
+
+    memset(e, 0, sizeof(*e));
+    snprintf(e->file, sizeof(e->file), "%s", ent->d_name);
+    if (map_rom(path, e, 0) != 0) {
+      continue;
+    }
+    chip8_sha1(e->image, e->size, e->sha1);
+    parse_file_name(e);
+    e->notes_mtime = notes_mtime;
+    if (notes_mtime) {
+      parse_notes(e, notes_path);
+    }
+    lib->hashed++;
+    lib->count++;
+  }
+  closedir(d);
+
+  // Regrava o índice se alguma ROM foi (re)hasheada ou removida; um diretório
+  // sem permissão de escrita só perde o cache
+  if (status == 0 && (lib->hashed > 0 || lib->count != old_count || !old)) {
+    lib->index_written = write_index(lib) == 0;
+  }
+  free(old);
+  if (status != 0) {
+    chip8_library_close(lib);
+    return status;
+  }
+  qsort(lib->entries, lib->count, sizeof(Chip8RomEntry), compare_sha1);
+  return 0;
+}
+
+void chip8_library_close(Chip8Library* lib) {
+  for (uint32_t i = 0; i < lib->count; i++) {
+    unmap_rom(&lib->entries[i]);
+  }
+  free(lib->entries);
+  lib->entries = NULL;
+  lib->count = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Busca e carga
+
+static int sha1_hex_prefix_cmp(const uint8_t sha1[20], const char* hex, size_t len) {
+  char full[41];
+  chip8_sha1_hex(sha1, full);
+  return strncasecmp(full, hex, len);
+}
+
+const Chip8RomEntry* chip8_library_find(const Chip8Library* lib, const char* hex) {
+  size_t len = strlen(hex);
+  if (len < 4 || len > 40 || strspn(hex, "0123456789abcdefABCDEF") != len) {
+    return NULL;
+  }
+  // Primeira entrada >= prefixo (as entradas estão ordenadas pelo SHA-1)
+  uint32_t lo = 0, hi = lib->count;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    if (sha1_hex_prefix_cmp(lib->entries[mid].sha1, hex, len) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo == lib->count || sha1_hex_prefix_cmp(lib->entries[lo].sha1, hex, len) != 0) {
+    return NULL;
+  }
+  // Prefixo ambíguo: só vale se as outras entradas forem cópias da mesma ROM
+  for (uint32_t i = lo + 1; i < lib->count && sha1_hex_prefix_cmp(lib->entries[i].sha1, hex, len) == 0; i++) {
+    if (memcmp(lib->entries[i].sha1, lib->entries[lo].sha1, 20) != 0) {
+      return NULL;
+    }
+  }
+  return &lib->entries[lo];
+}
+
+void chip8_library_path(const Chip8Library* lib, const Chip8RomEntry* e, char* out, size_t size) {
+  snprintf(out, size, "%s/%s", lib->dir, e->file);
+}
+
+const uint8_t* chip8_library_image(Chip8Library* lib, const Chip8RomEntry* entry, int* error) {
+  Chip8RomEntry* e = &lib->entries[entry - lib->entries];
+  *error = 0;
+  if (!e->image) {
+    char path[4500];
+    chip8_library_path(lib, e, path, sizeof(path));
+    *error = map_rom(path, e, 1);
+  }
+  return *error ? NULL : e->image;
+}
+
+int chip8_library_load(Chip8Library* lib, const Chip8RomEntry* e, Chip8* chip8) {
+  int error;
+  const uint8_t* image = chip8_library_image(lib, e, &error);
+  if (!image) {
+    return error;
+  }
+  return chip8_load_rom_image(chip8, image, e->size) == 0 ? 0 : LIBRARY_ERR_SIZE;
+}
+
+static int compare_titles(const void* a, const void* b) {
+  const Chip8RomEntry* x = *(const Chip8RomEntry* const*)a;
+  const Chip8RomEntry* y = *(const Chip8RomEntry* const*)b;
+  int c = strcasecmp(x->title, y->title);
+  return c ? c : strcmp(x->file, y->file);
+}
+
+void chip8_library_print(const Chip8Library* lib, FILE* out) {
+  const Chip8RomEntry** sorted = malloc(sizeof(Chip8RomEntry*) * (lib->count ? lib->count : 1));
+  if (!sorted) {
+    return;
+  }
+  for (uint32_t i = 0; i < lib->count; i++) {
+    sorted[i] = &lib->entries[i];
+  }
+  qsort(sorted, lib->count, sizeof(Chip8RomEntry*), compare_titles);
+  for (uint32_t i = 0; i < lib->count; i++) {
+    const Chip8RomEntry* e = sorted[i];
+    char hex[41], keys[17] = "", credit[160] = "";
+    chip8_sha1_hex(e->sha1, hex);
+    for (int k = 0, n = 0; k < 16; k++) {
+      if (e->key_hints & (1u << k)) {
+        keys[n++] = "0123456789ABCDEF"[k];
+        keys[n] = '\0';
+      }
+    }
+    if (e->author[0] && e->year) {
+      snprintf(credit, sizeof(credit), " (%s, %u)", e->author, e->year);
+    } else if (e->author[0]) {
+      snprintf(credit, sizeof(credit), " (%s)", e->author);
+    } else if (e->year) {
+      snprintf(credit, sizeof(credit), " (%u)", e->year);
+    }
+    fprintf(out, "%.12s %5u  %-16s %s%s\n", hex, e->size, keys[0] ? keys : "-", e->title, credit);
+  }
+  free(sorted);
+}
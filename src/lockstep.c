@@ -0,0 +1,513 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "chip8.h"
+#include "batch.h"
+#include "jit.h"
+#include "machine.h"
+#include "quirks.h"
+#include "trace.h"
+
+// Execução em lockstep: o interpretador de referência (chip8_cycle) e um
+// núcleo otimizado (chip8_run pré-decodificado, o JIT ou o motor em lote)
+// executam a mesma ROM com as mesmas teclas, lado a lado. O estado
+// arquitetural (V, I, PC, SP, pilha, temporizadores, memória e display) é
+// comparado após cada bloco de -k instruções (no lote, após cada frame) e a
+// execução para na primeira divergência, com os dois estados e as últimas
+// instruções da referência.
+//
+// Com --fuzz, as ROMs são programas de opcodes aleatórios (uma combinação de
+// quirks sorteada por programa), gerados a partir de uma semente: o programa i
+// usa a semente s + i e pode ser reproduzido sozinho com --fuzz 1 -s (s + i).
+
+#define CYCLES_PER_FRAME   10  // Mesmo valor do main.c: temporizadores a cada 10 ciclos
+#define DEFAULT_FRAMES     600
+#define FUZZ_FRAMES        60  // Frames por programa do fuzzer
+#define DEFAULT_INSTANCES  8   // Instâncias do lote, cada uma com as próprias teclas
+#define FUZZ_MIN_LENGTH    16  // Instruções por programa do fuzzer
+#define FUZZ_MAX_LENGTH    256
+#define HISTORY            16  // Instruções da referência mostradas na divergência
+#define MAX_MEMORY_DIFFS   16
+
+typedef enum {
+  BACKEND_RUN,   // chip8_run (tabela pré-decodificada, despacho encadeado)
+  BACKEND_JIT,   // chip8_jit_run
+  BACKEND_BATCH, // chip8_batch_run_frames (comparado frame a frame)
+  BACKEND_COUNT
+} Backend;
+
+static const char* const backend_names[] = {"run", "jit", "batch"};
+
+typedef struct {
+  uint16_t pc[HISTORY];
+  uint16_t opcode[HISTORY];
+  uint64_t steps;             // Instruções executadas pela referência
+} History;
+
+typedef struct {
+  uint32_t frames;
+  uint32_t cycles_per_frame;
+  uint32_t block;             // Instruções entre comparações (run e JIT)
+  uint32_t instances;         // Instâncias do lote
+  const char* label;          // ROM ou programa do fuzzer, para o relatório
+  uint64_t compared;          // Comparações feitas (todas as execuções)
+} Lockstep;
+
+// Teclas de cada frame: cada instância segura uma tecla (ou nenhuma) por 8 frames,
+// escolhida por um hash (splitmix64) da instância e do frame
+static uint16_t seeded_keys(uint32_t instance, uint64_t frame, void* user) {
+  (void)user;
+  uint64_t h = ((uint64_t)instance << 32) ^ (frame / 8);
+  h += 0x9E3779B97F4A7C15ULL;
+  h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+  h ^= h >> 31;
+  uint32_t key = (uint32_t)(h % 20);
+  return key < 16 ? (uint16_t)(1u << key) : 0; // 4 em 20: nenhuma tecla
+}
+
+// Um passo da referência, guardando PC e opcode no histórico
+static void reference_step(Chip8* chip8, History* h) {
+  uint32_t slot = (uint32_t)(h->steps % HISTORY);
+  h->pc[slot] = chip8->pc;
+  h->opcode[slot] = (uint16_t)((chip8_peek(chip8, chip8->pc) << 8) | chip8_peek(chip8, chip8->pc + 1u));
+  h->steps++;
+  chip8_cycle(chip8);
+}
+
+// Primeira diferença no estado arquitetural (NULL se iguais). Ficam de fora os
+// contadores (oob_accesses, idle_cycles), display_gen / dirty_rows e a cache pré-decodificada
+static const char* first_difference(const Chip8* a, const Chip8* b) {
+  if (memcmp(a->V, b->V, sizeof(a->V)) != 0) return "V";
+  if (a->I != b->I) return "I";
+  if (a->pc != b->pc) return "PC";
+  if (a->sp != b->sp) return "SP";
+  if (memcmp(a->stack, b->stack, sizeof(uint16_t) * (a->sp < 16 ? a->sp : 16)) != 0) return "pilha";
+  if (a->delay_timer != b->delay_timer) return "delay timer";
+  if (a->sound_timer != b->sound_timer) return "sound timer";
+  if (memcmp(a->memory, b->memory, sizeof(a->memory)) != 0) return "memória";
+  if (a->machine == CHIP8_MACHINE_XOCHIP && memcmp(a->ext->memory, b->ext->memory, CHIP8_MEMORY_SIZE - 4096) != 0) {
+    return "memória";
+  }
+  if (a->machine == CHIP8_MACHINE_CHIP8) {
+    if (memcmp(a->display, b->display, sizeof(a->display)) != 0) return "display";
+  } else {
+    if (a->hires != b->hires || a->planes != b->planes) return "modo de vídeo";
+    if (memcmp(a->ext->screen, b->ext->screen, sizeof(a->ext->screen)) != 0) return "display";
+    if (memcmp(a->flags, b->flags, sizeof(a->flags)) != 0) return "flags";
+  }
+  return NULL;
+}
+
+static void print_row(const char* label, int y, uint64_t row) {
+  printf("  %-11s %2d  ", label, y);
+  for (int x = 0; x < 64; x++) {
+    putchar((row >> (63 - x)) & 1 ? '#' : '.');
+  }
+  putchar('\n');
+}
+
+// Os dois estados lado a lado (diferenças marcadas) e as últimas instruções da referência
+static void dump_divergence(const Lockstep* ls, Backend backend, uint32_t instance, uint32_t frame,
+                            const char* field, const Chip8* ref, const Chip8* cand, const History* h) {
+  printf("DIVERGÊNCIA (%s) em %s", backend_names[backend], field);
+  if (backend == BACKEND_BATCH) {
+    printf(", instância %u", instance);
+  }
+  printf(": %s, frame %u, após %llu instruções\n", ls->label, frame, (unsigned long long)h->steps);
+
+  printf("  %-11s %-12s %-12s\n", "", "referência", backend_names[backend]);
+  for (int r = 0; r < 16; r++) {
+    char name[4];
+    snprintf(name, sizeof(name), "V%X", r);
+    printf("  %-11s 0x%02X         0x%02X%s\n", name, ref->V[r], cand->V[r], ref->V[r] != cand->V[r] ? "   <" : "");
+  }
+  printf("  %-11s 0x%04X       0x%04X%s\n", "I", ref->I, cand->I, ref->I != cand->I ? "   <" : "");
+  printf("  %-11s 0x%04X       0x%04X%s\n", "PC", ref->pc, cand->pc, ref->pc != cand->pc ? "   <" : "");
+  printf("  %-11s %-12u %u%s\n", "SP", ref->sp, cand->sp, ref->sp != cand->sp ? "   <" : "");
+  printf("  %-11s %-12u %u%s\n", "DT", ref->delay_timer, cand->delay_timer,
+         ref->delay_timer != cand->delay_timer ? "   <" : "");
+  printf("  %-11s %-12u %u%s\n", "ST", ref->sound_timer, cand->sound_timer,
+         ref->sound_timer != cand->sound_timer ? "   <" : "");
+  int depth = ref->sp > cand->sp ? ref->sp : cand->sp;
+  for (int s = 0; s < depth && s < 16; s++) {
+    char name[12];
+    snprintf(name, sizeof(name), "pilha[%d]", s);
+    printf("  %-11s 0x%04X       0x%04X%s\n", name, ref->stack[s], cand->stack[s],
+           ref->stack[s] != cand->stack[s] ? "   <" : "");
+  }
+
+  uint32_t size = chip8_memory_size(ref), diffs = 0;
+  for (uint32_t a = 0; a < size; a++) {
+    uint8_t r = chip8_peek(ref, a), c = chip8_peek(cand, a);
+    if (r != c) {
+      if (diffs < MAX_MEMORY_DIFFS) {
+        printf("  mem[0x%04X] 0x%02X         0x%02X   <\n", a, r, c);
+      }
+      diffs++;
+    }
+  }
+  if (diffs > MAX_MEMORY_DIFFS) {
+    printf("  ... %u bytes diferentes na memória\n", diffs);
+  }
+
+  if (ref->machine == CHIP8_MACHINE_CHIP8) {
+    for (int y = 0; y < CHIP8_HEIGHT; y++) {
+      if (ref->display[y] != cand->display[y]) {
+        print_row("referência", y, ref->display[y]);
+        print_row(backend_names[backend], y, cand->display[y]);
+      }
+    }
+  } else if (strcmp(field, "display") == 0) {
+    printf("  (framebuffer estendido: hash 0x%016llx na referência, 0x%016llx em %s)\n",
+           (unsigned long long)chip8_display_hash(ref), (unsigned long long)chip8_display_hash(cand),
+           backend_names[backend]);
+  }
+
+  printf("  Últimas instruções da referência:\n");
+  uint64_t first = h->steps > HISTORY ? h->steps - HISTORY : 0;
+  for (uint64_t i = first; i < h->steps; i++) {
+    char text[32];
+    uint32_t slot = (uint32_t)(i % HISTORY);
+    printf("    %10llu  0x%04X  %04X  %s\n", (unsigned long long)i, h->pc[slot], h->opcode[slot],
+           chip8_disassemble(h->opcode[slot], text, sizeof(text)));
+  }
+}
+
+static Chip8 reference, candidate, exported; // Reaproveitados entre os programas (chip8_copy mantém a cache)
+
+// chip8_run ou o JIT: compara a cada bloco de ls->block instruções. Retorna 0 ou 2 (divergência)
+static int lockstep_single(Lockstep* ls, Backend backend, const Chip8* proto, Chip8Jit* jit) {
+  History h = {{0}, {0}, 0};
+  if (chip8_copy(&reference, proto) != 0 || chip8_copy(&candidate, proto) != 0) {
+    printf("Erro: sem memória para as cópias do estado\n");
+    return 1;
+  }
+  if (jit) {
+    chip8_jit_flush(jit); // Outra ROM na mesma memória
+  }
+  for (uint32_t f = 0; f < ls->frames; f++) {
+    uint16_t keys = seeded_keys(0, f, NULL);
+    chip8_set_keys(&reference, keys);
+    chip8_set_keys(&candidate, keys);
+    for (uint32_t done = 0; done < ls->cycles_per_frame;) {
+      uint32_t n = ls->cycles_per_frame - done < ls->block ? ls->cycles_per_frame - done : ls->block;
+      for (uint32_t i = 0; i < n; i++) {
+        reference_step(&reference, &h);
+      }
+      if (backend == BACKEND_JIT) {
+        chip8_jit_run(jit, &candidate, n);
+      } else {
+        chip8_run(&candidate, n);
+      }
+      done += n;
+      ls->compared++;
+      const char* field = first_difference(&reference, &candidate);
+      if (field) {
+        dump_divergence(ls, backend, 0, f, field, &reference, &candidate, &h);
+        return 2;
+      }
+    }
+    chip8_tick_timers(&reference);
+    chip8_tick_timers(&candidate);
+  }
+  return 0;
+}
+
+// Motor em lote: cada instância contra a própria referência, comparadas após cada frame.
+// Retorna 0, 1 (erro) ou 2 (divergência)
+static int lockstep_batch(Lockstep* ls, const Chip8* proto) {
+  Chip8Batch* batch = chip8_batch_create(proto, ls->instances, 0);
+  Chip8* refs = malloc(sizeof(Chip8) * ls->instances);
+  History* history = calloc(ls->instances, sizeof(History));
+  if (!batch || !refs || !history) {
+    printf("Erro: %s\n", proto->machine != CHIP8_MACHINE_CHIP8 ? "o motor em lote só executa o CHIP-8"
+                                                               : "sem memória para o lote");
+    chip8_batch_destroy(batch);
+    free(refs);
+    free(history);
+    return 1;
+  }
+  for (uint32_t i = 0; i < ls->instances; i++) {
+    refs[i] = *proto;
+    refs[i].decoded = NULL; // A referência (chip8_cycle) não usa a cache de proto
+  }
+
+  int result = 0;
+  for (uint32_t f = 0; f < ls->frames && result == 0; f++) {
+    if (chip8_batch_run_frames(batch, 1, ls->cycles_per_frame, seeded_keys, NULL) != 0) {
+      printf("Erro: sem memória para as cópias privadas das instâncias\n");
+      result = 1;
+      break;
+    }
+    for (uint32_t i = 0; i < ls->instances; i++) {
+      chip8_set_keys(&refs[i], seeded_keys(i, f, NULL));
+      for (uint32_t c = 0; c < ls->cycles_per_frame; c++) {
+        reference_step(&refs[i], &history[i]);
+      }
+      chip8_tick_timers(&refs[i]);
+      chip8_batch_export(batch, i, &exported);
+      ls->compared++;
+      const char* field = first_difference(&refs[i], &exported);
+      if (field) {
+        dump_divergence(ls, BACKEND_BATCH, i, f, field, &refs[i], &exported, &history[i]);
+        result = 2;
+        break;
+      }
+    }
+  }
+  chip8_batch_destroy(batch);
+  free(refs);
+  free(history);
+  return result;
+}
+
+// Todos os backends pedidos (mask: bit b = Backend b) sobre o mesmo estado inicial
+static int lockstep_all(Lockstep* ls, unsigned mask, const Chip8* proto, Chip8Jit* jit) {
+  for (int b = 0; b < BACKEND_COUNT; b++) {
+    if (!(mask & (1u << b))) {
+      continue;
+    }
+    int result = b == BACKEND_BATCH ? lockstep_batch(ls, proto) : lockstep_single(ls, (Backend)b, proto, jit);
+    if (result != 0) {
+      return result;
+    }
+  }
+  return 0;
+}
+
+// Gerador do fuzzer: splitmix64
+static uint64_t next_random(uint64_t* state) {
+  uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+typedef struct {
+  uint16_t base;              // Bits fixos
+  uint16_t random;            // Bits sorteados
+} OpcodeForm;
+
+// As formas que o núcleo implementa (o sorteio é uniforme entre elas); 1NNN,
+// 2NNN e BNNN caem quase sempre dentro do programa, e a última forma é um
+// opcode qualquer (inclusive os desconhecidos)
+static const OpcodeForm opcode_forms[] = {
+  {0x00E0, 0x0000}, {0x00EE, 0x0000}, {0x1000, 0x0FFF}, {0x2000, 0x0FFF},
+  {0x3000, 0x0FFF}, {0x4000, 0x0FFF}, {0x5000, 0x0FF0}, {0x6000, 0x0FFF},
+  {0x7000, 0x0FFF}, {0x8000, 0x0FF0}, {0x8001, 0x0FF0}, {0x8002, 0x0FF0},
+  {0x8003, 0x0FF0}, {0x8004, 0x0FF0}, {0x8005, 0x0FF0}, {0x8006, 0x0FF0},
+  {0x8007, 0x0FF0}, {0x800E, 0x0FF0}, {0x9000, 0x0FF0}, {0xA000, 0x0FFF},
+  {0xB000, 0x0FFF}, {0xD000, 0x0FFF}, {0xE09E, 0x0F00}, {0xE0A1, 0x0F00},
+  {0xF007, 0x0F00}, {0xF00A, 0x0F00}, {0xF015, 0x0F00}, {0xF018, 0x0F00},
+  {0xF01E, 0x0F00}, {0xF029, 0x0F00}, {0xF033, 0x0F00}, {0xF055, 0x0F00},
+  {0xF065, 0x0F00}, {0x0000, 0xFFFF},
+};
+
+#define OPCODE_FORMS (sizeof(opcode_forms) / sizeof(opcode_forms[0]))
+
+static uint16_t random_opcode(uint64_t* state, uint32_t length) {
+  const OpcodeForm* form = &opcode_forms[next_random(state) % OPCODE_FORMS];
+  uint64_t r = next_random(state);
+  uint16_t opcode = (uint16_t)(form->base | (r & form->random));
+  uint16_t high = opcode & 0xF000;
+  if ((high == 0x1000 || high == 0x2000 || high == 0xB000) && (r >> 32) % 8 != 0) {
+    // Salto para uma instrução do programa (BNNN ainda soma V0 / VX)
+    opcode = (uint16_t)(high | (0x200 + 2 * ((r >> 40) % length)));
+  }
+  return opcode;
+}
+
+// Programa aleatório em image; retorna o tamanho em bytes
+static uint32_t random_program(uint64_t seed, uint8_t* image, uint8_t* quirks) {
+  uint64_t state = seed;
+  uint32_t length = FUZZ_MIN_LENGTH + (uint32_t)(next_random(&state) % (FUZZ_MAX_LENGTH - FUZZ_MIN_LENGTH + 1));
+  *quirks = (uint8_t)(next_random(&state) % CHIP8_QUIRK_COUNT);
+  for (uint32_t i = 0; i < length; i++) {
+    uint16_t opcode = random_opcode(&state, length);
+    image[2 * i] = (uint8_t)(opcode >> 8);
+    image[2 * i + 1] = (uint8_t)opcode;
+  }
+  return 2 * length;
+}
+
+static int parse_backends(const char* text, unsigned* mask) {
+  *mask = 0;
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%s", text);
+  for (char* name = strtok(buf, ","); name; name = strtok(NULL, ",")) {
+    int found = 0;
+    for (int b = 0; b < BACKEND_COUNT; b++) {
+      if (strcmp(name, backend_names[b]) == 0) {
+        *mask |= 1u << b;
+        found = 1;
+      }
+    }
+    if (!found) {
+      return -1;
+    }
+  }
+  return *mask ? 0 : -1;
+}
+
+static void usage(const char* prog) {
+  printf("Uso: %s <arquivo_rom> [-f frames] [-c ciclos] [-k bloco] [-b backends] [-n instancias]\n"
+         "       [--quirks perfil] [--machine modelo]\n"
+         "       %s --fuzz programas [-s semente] [-o arquivo] [mesmas opções]\n", prog, prog);
+  printf("  -f N         frames por ROM (padrão: %d; %d por programa com --fuzz)\n", DEFAULT_FRAMES, FUZZ_FRAMES);
+  printf("  -c N         instruções por frame (padrão: %d)\n", CYCLES_PER_FRAME);
+  printf("  -k N         instruções entre comparações em run e jit (padrão: 1; o lote compara por frame)\n");
+  printf("  -b LISTA     backends separados por vírgula: run, jit, batch (padrão: todos)\n");
+  printf("  -n N         instâncias do lote, cada uma com as próprias teclas (padrão: %d)\n", DEFAULT_INSTANCES);
+  printf("  --quirks Q   perfil ou quirks separadas por vírgula (padrão: as do banco de ROMs;\n"
+         "               com --fuzz, sorteadas por programa)\n");
+  printf("  --machine M  chip8 (padrão), schip ou xochip (só run e jit)\n");
+  printf("  --fuzz N     compara N programas de opcodes aleatórios\n");
+  printf("  -s S         semente do primeiro programa (padrão: 1; o programa i usa S + i)\n");
+  printf("  -o ARQ       grava em ARQ o programa que divergiu (para repetir como ROM)\n");
+  printf("Código de saída: 0 sem divergências, 2 na primeira divergência, 1 em erro\n");
+}
+
+int main(int argc, char* argv[]) {
+  const char* rom_path = NULL;
+  const char* out_path = NULL;
+  Lockstep ls = {0, CYCLES_PER_FRAME, 1, DEFAULT_INSTANCES, NULL, 0};
+  long frames = -1;
+  unsigned backends = (1u << BACKEND_COUNT) - 1;
+  int quirks_override = -1;
+  Chip8Machine machine = CHIP8_MACHINE_CHIP8;
+  long fuzz = 0;
+  unsigned long long seed = 1;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+      frames = atol(argv[++i]);
+    } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+      ls.cycles_per_frame = (uint32_t)atol(argv[++i]);
+    } else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+      ls.block = (uint32_t)atol(argv[++i]);
+    } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      ls.instances = (uint32_t)atol(argv[++i]);
+    } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+      if (parse_backends(argv[++i], &backends) != 0) {
+        printf("Erro: backends desconhecidos: %s (run, jit, batch)\n", argv[i]);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "--quirks") == 0 && i + 1 < argc) {
+      uint8_t quirks;
+      if (chip8_quirks_parse(argv[++i], &quirks) != 0) {
+        printf("Erro: quirks desconhecidas: %s (perfis: modern, vip, schip, xochip)\n", argv[i]);
+        return 1;
+      }
+      quirks_override = quirks;
+    } else if (strcmp(argv[i], "--machine") == 0 && i + 1 < argc) {
+      if (chip8_machine_parse(argv[++i], &machine) != 0) {
+        printf("Erro: modelo de máquina desconhecido: %s (chip8, schip, xochip)\n", argv[i]);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "--fuzz") == 0 && i + 1 < argc) {
+      fuzz = atol(argv[++i]);
+    } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      seed = strtoull(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      out_path = argv[++i];
+    } else if (argv[i][0] != '-' && !rom_path) {
+      rom_path = argv[i];
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if ((!rom_path) == (fuzz <= 0) || ls.cycles_per_frame == 0 || ls.block == 0 || ls.instances == 0 || frames == 0) {
+    usage(argv[0]);
+    return 1;
+  }
+  ls.frames = frames > 0 ? (uint32_t)frames : (fuzz > 0 ? FUZZ_FRAMES : DEFAULT_FRAMES);
+  if (machine != CHIP8_MACHINE_CHIP8 && (backends & (1u << BACKEND_BATCH))) {
+    backends &= ~(1u << BACKEND_BATCH); // O lote só executa o CHIP-8
+    if (!backends) {
+      printf("Erro: o motor em lote só executa o CHIP-8 (sem --machine %s)\n", chip8_machine_name(machine));
+      return 1;
+    }
+  }
+
+  Chip8Jit* jit = NULL;
+  if (backends & (1u << BACKEND_JIT)) {
+    jit = chip8_jit_create();
+    if (!jit) {
+      printf("Erro: sem memória para o JIT\n");
+      return 1;
+    }
+    if (!chip8_jit_native(jit)) {
+      printf("Aviso: JIT sem código nativo nesta plataforma (compara chip8_run)\n");
+    }
+  }
+
+  static Chip8 proto;
+  int result = 0;
+  if (rom_path) {
+    chip8_init(&proto);
+    int load = chip8_set_machine(&proto, machine) != 0 ? -4 : chip8_load_rom(&proto, rom_path);
+    if (load != 0) {
+      printf("Erro: %s: %s\n", chip8_load_error(load), rom_path);
+      chip8_jit_destroy(jit);
+      return 1;
+    }
+    if (quirks_override >= 0) {
+      proto.quirks = (uint8_t)quirks_override;
+    }
+    ls.label = rom_path;
+    result = lockstep_all(&ls, backends, &proto, jit);
+  } else {
+    static uint8_t image[2 * FUZZ_MAX_LENGTH];
+    char label[64];
+    long p;
+    for (p = 0; p < fuzz && result == 0; p++) {
+      uint64_t program_seed = seed + (uint64_t)p;
+      uint8_t quirks;
+      uint32_t size = random_program(program_seed, image, &quirks);
+      chip8_release(&proto);
+      chip8_init(&proto);
+      if (chip8_set_machine(&proto, machine) != 0) {
+        printf("Erro: sem memória para o modelo\n");
+        result = 1;
+        break;
+      }
+      chip8_load_rom_image(&proto, image, size);
+      proto.quirks = quirks_override >= 0 ? (uint8_t)quirks_override : quirks;
+      snprintf(label, sizeof(label), "programa com semente %llu (quirks 0x%X)", (unsigned long long)program_seed,
+               proto.quirks);
+      ls.label = label;
+      result = lockstep_all(&ls, backends, &proto, jit);
+      if (result == 2 && out_path) {
+        FILE* out = fopen(out_path, "wb");
+        if (!out || fwrite(image, 1, size, out) != size) {
+          printf("Erro: não foi possível gravar %s\n", out_path);
+        } else {
+          printf("Programa gravado em %s\n", out_path);
+        }
+        if (out) {
+          fclose(out);
+        }
+      }
+    }
+    if (result == 0) {
+      printf("Programas: %ld (sementes %llu a %llu)\n", fuzz, seed, seed + (unsigned long long)fuzz - 1);
+    }
+  }
+
+  if (result == 0) {
+    printf("Backends:");
+    for (int b = 0; b < BACKEND_COUNT; b++) {
+      if (backends & (1u << b)) {
+        printf(" %s", backend_names[b]);
+      }
+    }
+    printf("\nComparações: %llu, nenhuma divergência\n", (unsigned long long)ls.compared);
+  }
+  chip8_release(&proto);
+  chip8_release(&reference);
+  chip8_release(&candidate);
+  chip8_jit_destroy(jit);
+  return result;
+}
@@ -0,0 +1,580 @@
+#include <stdlib.h>
+#include <string.h>
+#include "instructions.h"
+#include "machine.h"
+
+// Fonte grande do SUPER-CHIP (8x10, dígitos 0-9) com as letras A-F do XO-CHIP
+static const uint8_t big_font[160] = {
+  0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, // 0
+  0x18, 0x78, 0x78, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, // 1
+  0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, // 2
+  0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, // 3
+  0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03, // 4
+  0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, // 5
+  0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, // 6
+  0xFF, 0xFF, 0x03, 0x03, 0x06, 0x0C, 0x18, 0x18, 0x18, 0x18, // 7
+  0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, // 8
+  0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, // 9
+  0x7E, 0xFF, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xC3, // A
+  0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC, // B
+  0x3C, 0xFF, 0xC3, 0xC0, 0xC0, 0xC0, 0xC0, 0xC3, 0xFF, 0x3C, // C
+  0xFC, 0xFE, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFE, 0xFC, // D
+  0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, // E
+  0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0, // F
+};
+
+static const char* const machine_names[CHIP8_MACHINE_COUNT] = {"chip8", "schip", "xochip"};
+
+// Quirks padrão: SUPER-CHIP 1.1 (BXNN, corta nas bordas); XO-CHIP segue o Octo
+// (desloca VY, FX55/FX65 avançam I, sprites dão a volta)
+static const uint8_t machine_quirks[CHIP8_MACHINE_COUNT] = {
+  CHIP8_QUIRKS_MODERN,
+  CHIP8_QUIRK_JUMP_VX | CHIP8_QUIRK_CLIP,
+  CHIP8_QUIRK_SHIFT_VY | CHIP8_QUIRK_LOAD_STORE_I,
+};
+
+// Bytes da extensão do modelo (0 no CHIP-8)
+static size_t ext_size(Chip8Machine machine) {
+  switch (machine) {
+    case CHIP8_MACHINE_SCHIP:  return sizeof(Chip8Ext);
+    case CHIP8_MACHINE_XOCHIP: return sizeof(Chip8Ext) + CHIP8_MEMORY_SIZE - 4096;
+    default:                   return 0;
+  }
+}
+
+int chip8_machine_ext(Chip8* chip8, Chip8Machine machine) {
+  size_t size = ext_size(machine);
+  if (!chip8->ext || size != ext_size((Chip8Machine)chip8->machine)) {
+    Chip8Ext* ext = NULL;
+    if (size > 0 && !(ext = calloc(1, size))) {
+      return -1;
+    }
+    free(chip8->ext);
+    chip8->ext = ext;
+  }
+  // As estendidas não mantêm a cache de instruções do CHIP-8 (ela ficaria desatualizada)
+  if (machine != CHIP8_MACHINE_CHIP8) {
+    free(chip8->decoded);
+    chip8->decoded = NULL;
+  }
+  return 0;
+}
+
+void chip8_release(Chip8* chip8) {
+  free(chip8->ext);
+  chip8->ext = NULL;
+  free(chip8->decoded);
+  chip8->decoded = NULL;
+}
+
+int chip8_copy(Chip8* dst, const Chip8* src) {
+  Chip8Ext* ext = dst->ext;
+  Chip8Decoded* decoded = dst->decoded;
+  size_t size = src->ext ? ext_size((Chip8Machine)src->machine) : 0;
+  if (size != (ext ? ext_size((Chip8Machine)dst->machine) : 0)) {
+    Chip8Ext* fresh = NULL;
+    if (size > 0 && !(fresh = malloc(size))) {
+      return -1;
+    }
+    free(ext);
+    ext = fresh;
+  }
+  // dst fica com a própria cache: só as entradas cujos bytes mudam são invalidadas
+  if (decoded && src->machine != CHIP8_MACHINE_CHIP8) {
+    free(decoded);
+    decoded = NULL;
+  } else if (decoded) {
+    for (uint16_t a = 0; a < 4096; a++) {
+      if (dst->memory[a] != src->memory[a]) {
+        chip8_invalidate(dst, a, 1);
+      }
+    }
+  }
+  *dst = *src;
+  dst->ext = ext;
+  dst->decoded = decoded;
+  if (ext) {
+    memcpy(ext, src->ext, size);
+  }
+  return 0;
+}
+
+int chip8_set_machine(Chip8* chip8, Chip8Machine machine) {
+  int extended = machine != CHIP8_MACHINE_CHIP8;
+  if (chip8_machine_ext(chip8, machine) != 0) {
+    return -1;
+  }
+  chip8->machine = (uint8_t)machine;
+  chip8->quirks = machine_quirks[machine];
+  chip8->hires = 0;
+  chip8->planes = extended ? 1 : 0;
+  chip8->pitch = extended ? 64 : 0; // 4000 bits/s
+  memset(chip8->flags, 0, sizeof(chip8->flags));
+  memset(chip8->audio_pattern, 0, sizeof(chip8->audio_pattern));
+  if (extended) {
+    memset(chip8->ext, 0, ext_size(machine)); // Framebuffer e, no XO-CHIP, a memória além dos 4 KB
+    memcpy(&chip8->memory[CHIP8_BIG_FONT_ADDR], big_font, sizeof(big_font));
+  } else {
+    memset(&chip8->memory[CHIP8_BIG_FONT_ADDR], 0, sizeof(big_font));
+  }
+  chip8_invalidate(chip8, CHIP8_BIG_FONT_ADDR, sizeof(big_font));
+  chip8->dirty_rows = 0xFFFFFFFFu;
+  chip8->display_gen++;
+  return 0;
+}
+
+const char* chip8_machine_name(Chip8Machine machine) {
+  return machine < CHIP8_MACHINE_COUNT ? machine_names[machine] : "?";
+}
+
+int chip8_machine_parse(const char* text, Chip8Machine* machine) {
+  for (int m = 0; m < CHIP8_MACHINE_COUNT; m++) {
+    if (strcmp(text, machine_names[m]) == 0) {
+      *machine = (Chip8Machine)m;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+uint8_t chip8_machine_quirks(Chip8Machine machine) {
+  return machine < CHIP8_MACHINE_COUNT ? machine_quirks[machine] : CHIP8_QUIRKS_MODERN;
+}
+
+// Endereços fazem wrap-around no fim da memória do modelo
+static inline uint16_t mem_mask(const Chip8* chip8) {
+  return chip8->machine == CHIP8_MACHINE_XOCHIP ? 0xFFFF : 0x0FFF;
+}
+
+uint32_t chip8_memory_size(const Chip8* chip8) {
+  return (uint32_t)mem_mask(chip8) + 1;
+}
+
+// Byte no endereço addr (já com a máscara): os primeiros 4 KB ficam em
+// Chip8.memory, o resto da memória do XO-CHIP na extensão
+static inline uint8_t* cell_at(Chip8* chip8, uint16_t addr) {
+  return addr < 4096 ? &chip8->memory[addr] : &chip8->ext->memory[addr - 4096];
+}
+
+// Os len bytes a partir de addr, quando ficam todos nos primeiros 4 KB (o caso comum,
+// sem o teste de cell_at a cada byte); NULL se passam para a extensão ou dão a volta
+static inline uint8_t* base_range(Chip8* chip8, uint32_t addr, uint32_t len) {
+  return addr + len <= 4096 ? &chip8->memory[addr] : NULL;
+}
+
+uint8_t chip8_peek(const Chip8* chip8, uint32_t addr) {
+  uint16_t a = (uint16_t)(addr & mem_mask(chip8));
+  return a < 4096 ? chip8->memory[a] : chip8->ext->memory[a - 4096];
+}
+
+// Acessos via I que passam do fim da memória são contados em oob_accesses
+static inline void check_range(Chip8* chip8, uint32_t len) {
+  if ((uint32_t)chip8->I + len > chip8_memory_size(chip8)) {
+    chip8->oob_accesses++;
+  }
+}
+
+// Pula a próxima instrução; no XO-CHIP, F000 NNNN ocupa 4 bytes e é pulada inteira
+static inline void skip_next(Chip8* chip8) {
+  uint16_t mask = mem_mask(chip8);
+  if (chip8->machine == CHIP8_MACHINE_XOCHIP && *cell_at(chip8, chip8->pc & mask) == 0xF0 &&
+      *cell_at(chip8, (uint16_t)(chip8->pc + 1) & mask) == 0x00) {
+    chip8->pc += 4;
+  } else {
+    chip8->pc += 2;
+  }
+}
+
+int chip8_screen_width(const Chip8* chip8) {
+  return chip8->hires ? CHIP8_HIRES_WIDTH : CHIP8_WIDTH;
+}
+
+int chip8_screen_height(const Chip8* chip8) {
+  return chip8->hires ? CHIP8_HIRES_HEIGHT : CHIP8_HEIGHT;
+}
+
+// Planos afetados por desenho, limpeza e rolagem (o SUPER-CHIP só tem o primeiro)
+static inline uint8_t selected_planes(const Chip8* chip8) {
+  return chip8->machine == CHIP8_MACHINE_XOCHIP ? chip8->planes : 1;
+}
+
+// Bit de dirty_rows da linha y (em hires, cada bit cobre duas linhas)
+static inline uint32_t row_bit(const Chip8* chip8, int y) {
+  return 1u << (chip8->hires ? y >> 1 : y);
+}
+
+static inline void screen_changed(Chip8* chip8, uint32_t dirty) {
+  if (dirty) {
+    chip8->dirty_rows |= dirty;
+    chip8->display_gen++;
+  }
+}
+
+// 00E0: limpa os planos selecionados
+static void clear_planes(Chip8* chip8) {
+  uint8_t planes = selected_planes(chip8);
+  int height = chip8_screen_height(chip8);
+  uint32_t dirty = 0;
+  for (int p = 0; p < CHIP8_PLANES; p++) {
+    if (!(planes & (1u << p))) {
+      continue;
+    }
+    for (int y = 0; y < height; y++) {
+      uint64_t* row = chip8->ext->screen[p][y];
+      if (row[0] | row[1]) {
+        dirty |= row_bit(chip8, y);
+        row[0] = row[1] = 0;
+      }
+    }
+  }
+  screen_changed(chip8, dirty);
+}
+
+// 00FE / 00FF: troca a resolução e limpa todos os planos
+static void set_hires(Chip8* chip8, uint8_t hires) {
+  chip8->hires = hires;
+  memset(chip8->ext->screen, 0, sizeof(chip8->ext->screen));
+  screen_changed(chip8, 0xFFFFFFFFu);
+}
+
+// 00CN / 00DN: move as linhas dos planos selecionados n linhas para baixo (n > 0)
+// ou para cima (n < 0); as que entram ficam apagadas
+static void scroll_vertical(Chip8* chip8, int n) {
+  uint8_t planes = selected_planes(chip8);
+  int height = chip8_screen_height(chip8);
+  int shift = n < 0 ? -n : n;
+  if (shift == 0) {
+    return;
+  }
+  if (shift > height) {
+    shift = height;
+  }
+  for (int p = 0; p < CHIP8_PLANES; p++) {
+    if (!(planes & (1u << p))) {
+      continue;
+    }
+    uint64_t (*rows)[2] = chip8->ext->screen[p];
+    if (n > 0) {
+      memmove(rows + shift, rows, sizeof(rows[0]) * (size_t)(height - shift));
+      memset(rows, 0, sizeof(rows[0]) * (size_t)shift);
+    } else {
+      memmove(rows, rows + shift, sizeof(rows[0]) * (size_t)(height - shift));
+      memset(rows + height - shift, 0, sizeof(rows[0]) * (size_t)shift);
+    }
+  }
+  screen_changed(chip8, 0xFFFFFFFFu);
+}
+
+// 00FB / 00FC: 4 pixels para a direita / esquerda; em hires, os bits que saem
+// de uma palavra entram na outra
+static void scroll_horizontal(Chip8* chip8, int right) {
+  uint8_t planes = selected_planes(chip8);
+  int height = chip8_screen_height(chip8);
+  for (int p = 0; p < CHIP8_PLANES; p++) {
+    if (!(planes & (1u << p))) {
+      continue;
+    }
+    for (int y = 0; y < height; y++) {
+      uint64_t* row = chip8->ext->screen[p][y];
+      if (!chip8->hires) {
+        row[0] = right ? row[0] >> 4 : row[0] << 4;
+      } else if (right) {
+        row[1] = (row[1] >> 4) | (row[0] << 60);
+        row[0] >>= 4;
+      } else {
+        row[0] = (row[0] << 4) | (row[1] >> 60);
+        row[1] <<= 4;
+      }
+    }
+  }
+  screen_changed(chip8, 0xFFFFFFFFu);
+}
+
+// Põe uma linha de sprite (até 16 pixels alinhados ao bit 63) na coluna vx de
+// uma linha de `width` pixels; sem clip, o que passa da borda direita volta pela esquerda
+static inline void place_row(uint64_t bits, int vx, int width, int clip, uint64_t* w0, uint64_t* w1) {
+  if (width == CHIP8_WIDTH) {
+    *w0 = clip ? bits >> vx : (bits >> vx) | (bits << ((64 - vx) & 63));
+    *w1 = 0;
+  } else if (vx < 64) {
+    *w0 = bits >> vx;
+    *w1 = vx ? bits << (64 - vx) : 0; // Parte que cruza para a segunda palavra
+  } else {
+    *w0 = !clip && vx > 64 ? bits << (128 - vx) : 0; // Parte que passa da coluna 127
+    *w1 = bits >> (vx - 64);
+  }
+}
+
+// DXYN / DXY0: desenha em cada plano selecionado, com os dados do plano
+// seguinte logo após os do anterior. DXY0 é um sprite de 16x16 (2 bytes por linha)
+static void draw(Chip8* chip8, uint16_t opcode) {
+  uint8_t x = (opcode & 0x0F00) >> 8;
+  uint8_t y = (opcode & 0x00F0) >> 4;
+  uint8_t n = opcode & 0x000F;
+  int width = chip8_screen_width(chip8);
+  int height = chip8_screen_height(chip8);
+  int rows = n ? n : 16;
+  int row_bytes = n ? 1 : 2;
+  int vx = chip8->V[x] & (width - 1);
+  int vy = chip8->V[y] & (height - 1);
+  int clip = (chip8->quirks & CHIP8_QUIRK_CLIP) != 0;
+  uint16_t mask = mem_mask(chip8);
+  uint8_t planes = selected_planes(chip8);
+  uint16_t addr = chip8->I;
+  int collided = 0; // Linhas com colisão
+  uint32_t dirty = 0;
+
+  uint32_t bytes = (uint32_t)(rows * row_bytes * ((planes & 1) + (planes >> 1)));
+  const uint8_t* base = base_range(chip8, addr, bytes);
+  check_range(chip8, bytes);
+  for (int p = 0; p < CHIP8_PLANES; p++) {
+    if (!(planes & (1u << p))) {
+      continue;
+    }
+    for (int row = 0; row < rows; row++) {
+      if (clip && vy + row >= height) {
+        break;
+      }
+      int py = (vy + row) & (height - 1);
+      uint16_t src = (uint16_t)(addr + row * row_bytes);
+      uint64_t bits = (uint64_t)(base ? base[src - chip8->I] : *cell_at(chip8, src & mask)) << 56;
+      if (row_bytes == 2) {
+        bits |= (uint64_t)(base ? base[src + 1 - chip8->I] : *cell_at(chip8, (uint16_t)(src + 1) & mask)) << 48;
+      }
+      uint64_t w0, w1;
+      place_row(bits, vx, width, clip, &w0, &w1);
+
+      uint64_t* line = chip8->ext->screen[p][py];
+      collided += ((line[0] & w0) | (line[1] & w1)) != 0;
+      line[0] ^= w0;
+      line[1] ^= w1;
+      if (w0 | w1) {
+        dirty |= row_bit(chip8, py);
+      }
+    }
+    addr = (uint16_t)(addr + rows * row_bytes);
+  }
+
+  // SUPER-CHIP em hires: VF = número de linhas com colisão; nos demais casos, 0 ou 1
+  chip8->V[0xF] = chip8->machine == CHIP8_MACHINE_SCHIP && chip8->hires ? (uint8_t)collided : collided != 0;
+  screen_changed(chip8, dirty);
+}
+
+// FX33 / FX55 / FX65 com a memória do modelo
+static void store_bcd(Chip8* chip8, uint8_t x) {
+  uint16_t mask = mem_mask(chip8);
+  uint8_t value = chip8->V[x];
+  check_range(chip8, 3);
+  *cell_at(chip8, chip8->I & mask) = value / 100;
+  *cell_at(chip8, (uint16_t)(chip8->I + 1) & mask) = (value / 10) % 10;
+  *cell_at(chip8, (uint16_t)(chip8->I + 2) & mask) = value % 10;
+}
+
+static void store_regs(Chip8* chip8, uint8_t x, int load) {
+  uint16_t mask = mem_mask(chip8);
+  uint8_t* base = base_range(chip8, chip8->I, x + 1u);
+  check_range(chip8, x + 1u);
+  for (int i = 0; i <= x; i++) {
+    uint8_t* cell = base ? base + i : cell_at(chip8, (uint16_t)(chip8->I + i) & mask);
+    if (load) {
+      chip8->V[i] = *cell;
+    } else {
+      *cell = chip8->V[i];
+    }
+  }
+  if (chip8->quirks & CHIP8_QUIRK_LOAD_STORE_I) {
+    chip8->I += x + 1;
+  }
+}
+
+// 5XY2 / 5XY3: grava / lê VX..VY (em qualquer ordem) a partir de I, sem mudar I
+static void store_range(Chip8* chip8, uint8_t x, uint8_t y, int load) {
+  uint16_t mask = mem_mask(chip8);
+  int step = x <= y ? 1 : -1;
+  int count = (x <= y ? y - x : x - y) + 1;
+  uint8_t* base = base_range(chip8, chip8->I, (uint32_t)count);
+  check_range(chip8, (uint32_t)count);
+  for (int i = 0; i < count; i++) {
+    uint8_t* cell = base ? base + i : cell_at(chip8, (uint16_t)(chip8->I + i) & mask);
+    uint8_t reg = (uint8_t)(x + i * step);
+    if (load) {
+      chip8->V[reg] = *cell;
+    } else {
+      *cell = chip8->V[reg];
+    }
+  }
+}
+
+void chip8_machine_execute(Chip8* chip8, uint16_t opcode) {
+  uint8_t x = (opcode & 0x0F00) >> 8;
+  uint8_t y = (opcode & 0x00F0) >> 4;
+  uint8_t kk = opcode & 0x00FF;
+  int xo = chip8->machine == CHIP8_MACHINE_XOCHIP;
+
+  switch (opcode & 0xF000) {
+    case 0x0000:
+      if ((opcode & 0xFFF0) == 0x00C0) {
+        scroll_vertical(chip8, opcode & 0x000F); // SCD n
+      } else if (xo && (opcode & 0xFFF0) == 0x00D0) {
+        scroll_vertical(chip8, -(opcode & 0x000F)); // SCU n
+      } else {
+        switch (opcode) {
+          case 0x00E0: clear_planes(chip8); break;           // CLS
+          case 0x00EE: inst_00EE(chip8, opcode); break;      // RET
+          case 0x00FB: scroll_horizontal(chip8, 1); break;   // SCR
+          case 0x00FC: scroll_horizontal(chip8, 0); break;   // SCL
+          case 0x00FD: chip8->pc -= 2; break;                // EXIT: para aqui (laço ocioso)
+          case 0x00FE: set_hires(chip8, 0); break;           // LOW
+          case 0x00FF: set_hires(chip8, 1); break;           // HIGH
+        }
+      }
+      break;
+
+    case 0x1000: inst_1NNN(chip8, opcode); break;
+    case 0x2000: inst_2NNN(chip8, opcode); break;
+    case 0x3000: if (chip8->V[x] == kk) skip_next(chip8); break;
+    case 0x4000: if (chip8->V[x] != kk) skip_next(chip8); break;
+
+    case 0x5000:
+      switch (opcode & 0x000F) {
+        case 0x0: if (chip8->V[x] == chip8->V[y]) skip_next(chip8); break;
+        case 0x2: if (xo) store_range(chip8, x, y, 0); break;
+        case 0x3: if (xo) store_range(chip8, x, y, 1); break;
+      }
+      break;
+
+    case 0x6000: inst_6XKK(chip8, opcode); break;
+    case 0x7000: inst_7XKK(chip8, opcode); break;
+
+    case 0x8000:
+      switch (opcode & 0x000F) {
+        case 0x0: inst_8XY0(chip8, opcode); break;
+        case 0x1: inst_8XY1(chip8, opcode); break;
+        case 0x2: inst_8XY2(chip8, opcode); break;
+        case 0x3: inst_8XY3(chip8, opcode); break;
+        case 0x4: inst_8XY4(chip8, opcode); break;
+        case 0x5: inst_8XY5(chip8, opcode); break;
+        case 0x6:
+          if (chip8->quirks & CHIP8_QUIRK_SHIFT_VY) inst_8XY6_vy(chip8, opcode);
+          else inst_8XY6(chip8, opcode);
+          break;
+        case 0x7: inst_8XY7(chip8, opcode); break;
+        case 0xE:
+          if (chip8->quirks & CHIP8_QUIRK_SHIFT_VY) inst_8XYE_vy(chip8, opcode);
+          else inst_8XYE(chip8, opcode);
+          break;
+      }
+      break;
+
+    case 0x9000: if (chip8->V[x] != chip8->V[y]) skip_next(chip8); break;
+    case 0xA000: inst_ANNN(chip8, opcode); break;
+
+    case 0xB000:
+      if (chip8->quirks & CHIP8_QUIRK_JUMP_VX) inst_BNNN_vx(chip8, opcode);
+      else inst_BNNN(chip8, opcode);
+      break;
+
+    case 0xD000: draw(chip8, opcode); break;
+
+    case 0xE000:
+      if (kk == 0x9E && chip8->keypad[chip8->V[x] & 0x0F]) skip_next(chip8);
+      else if (kk == 0xA1 && !chip8->keypad[chip8->V[x] & 0x0F]) skip_next(chip8);
+      break;
+
+    case 0xF000:
+      if (xo && opcode == 0xF000) {
+        // I = NNNN (a palavra seguinte)
+        uint16_t mask = mem_mask(chip8);
+        chip8->I = (uint16_t)((*cell_at(chip8, chip8->pc & mask) << 8) |
+                              *cell_at(chip8, (uint16_t)(chip8->pc + 1) & mask));
+        chip8->pc += 2;
+        break;
+      }
+      switch (kk) {
+        case 0x01: if (xo) chip8->planes = x & 3; break; // FN01: seleciona os planos
+        case 0x02:                                      // F002: padrão de áudio em I
+          if (xo && x == 0) {
+            check_range(chip8, sizeof(chip8->audio_pattern));
+            for (int i = 0; i < (int)sizeof(chip8->audio_pattern); i++) {
+              chip8->audio_pattern[i] = *cell_at(chip8, (uint16_t)(chip8->I + i) & mem_mask(chip8));
+            }
+          }
+          break;
+        case 0x07: inst_FX07(chip8, opcode); break;
+        case 0x0A: inst_FX0A(chip8, opcode); break;
+        case 0x15: inst_FX15(chip8, opcode); break;
+        case 0x18: inst_FX18(chip8, opcode); break;
+        case 0x1E: inst_FX1E(chip8, opcode); break;
+        case 0x29: inst_FX29(chip8, opcode); break;
+        case 0x30: chip8->I = CHIP8_BIG_FONT_ADDR + (chip8->V[x] & 0x0F) * 10; break; // Dígito grande
+        case 0x33: store_bcd(chip8, x); break;
+        case 0x3A: if (xo) chip8->pitch = chip8->V[x]; break;
+        case 0x55: store_regs(chip8, x, 0); break;
+        case 0x65: store_regs(chip8, x, 1); break;
+        case 0x75:                                      // Salva V0..VX nas flags (até V7 no SUPER-CHIP)
+          memcpy(chip8->flags, chip8->V, (size_t)(xo || x < 8 ? x : 7) + 1);
+          break;
+        case 0x85:
+          memcpy(chip8->V, chip8->flags, (size_t)(xo || x < 8 ? x : 7) + 1);
+          break;
+      }
+      break;
+
+    default:
+      // Opcode desconhecido - ignora, como chip8_cycle
+      break;
+  }
+}
+
+void chip8_machine_run(Chip8* chip8, uint32_t cycles) {
+  uint16_t mask = mem_mask(chip8);
+  while (cycles > 0) {
+    uint16_t pc = chip8->pc;
+    if (pc >= mask) {
+      chip8->oob_accesses++;
+    }
+    // Quase todo código fica nos primeiros 4 KB: só fora deles a busca passa pela extensão
+    uint16_t opcode = pc < 4096 - 1 ? (uint16_t)((chip8->memory[pc] << 8) | chip8->memory[pc + 1])
+                                    : (uint16_t)((*cell_at(chip8, pc & mask) << 8) | *cell_at(chip8, (uint16_t)(pc + 1) & mask));
+    chip8->pc = (uint16_t)(pc + 2);
+    chip8_machine_execute(chip8, opcode);
+
+    // Laço ocioso (salto curto para trás, FX0A sem tecla, 00FD): o resto dos ciclos de uma vez
+    if (chip8->pc <= pc && pc - chip8->pc <= 4 && cycles > 1 && chip8_skip_idle(chip8, cycles - 1)) {
+      return;
+    }
+    cycles--;
+  }
+}
+
+uint8_t chip8_screen_pixel(const Chip8* chip8, int x, int y) {
+  if (chip8->machine == CHIP8_MACHINE_CHIP8) {
+    return chip8_get_pixel(chip8, x, y);
+  }
+  x &= chip8_screen_width(chip8) - 1;
+  y &= chip8_screen_height(chip8) - 1;
+  uint8_t bits = 0;
+  for (int p = 0; p < CHIP8_PLANES; p++) {
+    bits |= (uint8_t)(((chip8->ext->screen[p][y][x >> 6] >> (63 - (x & 63))) & 1) << p);
+  }
+  return bits;
+}
+
+uint64_t chip8_screen_hash(const Chip8* chip8) {
+  if (chip8->machine == CHIP8_MACHINE_CHIP8) {
+    return chip8_display_hash(chip8);
+  }
+  // Mesmo FNV-1a por palavra de chip8_display_hash, começando pela resolução
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  hash ^= chip8->hires;
+  hash *= 0x100000001b3ULL;
+  for (int p = 0; p < CHIP8_PLANES; p++) {
+    for (int y = 0; y < CHIP8_HIRES_HEIGHT; y++) {
+      hash ^= chip8->ext->screen[p][y][0];
+      hash *= 0x100000001b3ULL;
+      hash ^= chip8->ext->screen[p][y][1];
+      hash *= 0x100000001b3ULL;
+    }
+  }
+  return hash;
+}
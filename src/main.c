@@ -1,15 +1,36 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <stdatomic.h>
 #include <SDL2/SDL.h>
 #include "chip8.h"
+#include "render.h"
+#include "state.h"
+#include "movie.h"
+#include "sched.h"
+#include "triple.h"
+#include "audio.h"
+#include "input.h"
+#include "library.h"
+#include "quirks.h"
+#include "machine.h"
+#include "capture.h"
 
-// Constantes
-#define CHIP8_WIDTH 64
-#define CHIP8_HEIGHT 32
+// Constantes (CHIP8_WIDTH e CHIP8_HEIGHT vêm de chip8.h)
 #define SCALE 10
-#define CYCLES_PER_FRAME 10  // Número de ciclos CHIP-8 por frame
-#define TIMER_HZ 60          // Frequência dos temporizadores (60 Hz)
-#define TARGET_FPS 60        // FPS alvo
+#define MAX_CATCH_UP_MS 250  // Após uma pausa longa (janela arrastada, depurador), não tenta recuperar mais que isso
+#define REWIND_ARENA_BYTES (512 * 1024) // Memória do buffer de rewind (alguns minutos de jogo)
+#define REWIND_KEYFRAME_INTERVAL 60     // Um keyframe por segundo emulado
+#define REQUEST_SAVE 1u                 // Pedidos da renderização à emulação (F5 / F9)
+#define REQUEST_LOAD 2u
+#define AUDIO_SAMPLE_RATE 48000
+#define AUDIO_BUFFER_FRAMES 256         // ~5 ms por callback
+#define AUDIO_WAKE_MS 4                 // Com áudio, a emulação avança em passos de no máximo 4 ms
+#define LATENCY_SAMPLES 4096            // Medições de latência entrada -> tela guardadas (-L)
+#define LIBRARY_DIR "games"             // Biblioteca usada por "@hash" sem --library
+#define CAPTURE_SCALE 4                 // Escala padrão do vídeo de --capture
+#define PATH_BYTES 4500                 // Caminho da ROM (da linha de comando ou da biblioteca)
+#define STATE_SUFFIX ".state"
 
 // Mapeamento de teclas SDL2 para teclado do CHIP-8
 // Layout do CHIP-8 original:
@@ -41,10 +62,517 @@ static const SDL_Scancode keymap[16] = {
   SDL_SCANCODE_V   // F
 };
 
+// Encerra a gravação: registra o framebuffer atual como referência e grava o arquivo
+static void finish_recording(Chip8Movie* movie, const Chip8* chip8, const char* path) {
+  movie->final_hash = chip8_display_hash(chip8);
+  movie->has_final_hash = 1;
+  int result = chip8_movie_save(movie, path);
+  if (result == 0) {
+    printf("Movie gravado: %s (%u frames)\n", path, movie->frames);
+  } else {
+    printf("Erro: %s: %s\n", chip8_movie_error(result), path);
+  }
+}
+
+// "@prefixo": acha a ROM pelo SHA-1 e copia a imagem mapeada; `path` recebe o caminho
+// do arquivo (o save state fica ao lado dele)
+static int library_rom(const char* dir, const char* hex, char* path, size_t path_size,
+                       uint8_t image[CHIP8_ROM_MAX_XO], uint32_t* size) {
+  Chip8Library library;
+  int result = chip8_library_open(&library, dir);
+  if (result != 0) {
+    printf("Erro: %s: %s\n", chip8_library_error(result), dir);
+    return -1;
+  }
+  const Chip8RomEntry* entry = chip8_library_find(&library, hex);
+  const uint8_t* mapped = entry ? chip8_library_image(&library, entry, &result) : NULL;
+  if (!mapped) {
+    printf("Erro: %s\n", entry ? chip8_library_error(result) : "nenhuma ROM (ou mais de uma) com esse hash na biblioteca");
+    chip8_library_close(&library);
+    return -1;
+  }
+  memcpy(image, mapped, entry->size);
+  *size = entry->size;
+  chip8_library_path(&library, entry, path, path_size);
+  chip8_library_close(&library);
+  return 0;
+}
+
+static int compare_float(const void* a, const void* b) {
+  float x = *(const float*)a, y = *(const float*)b;
+  return (x > y) - (x < y);
+}
+
+// Resumo das medições de latência entrada -> tela (-L)
+static void print_latency(float* ms, uint32_t count) {
+  if (count == 0) {
+    printf("Latência entrada -> tela: nenhuma medição (nenhuma tecla mudou o display)\n");
+    return;
+  }
+  qsort(ms, count, sizeof(float), compare_float);
+  double sum = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    sum += ms[i];
+  }
+  printf("Latência entrada -> tela (%u medições): média %.2f ms, mediana %.2f ms, p95 %.2f ms, mín %.2f ms, máx %.2f ms\n",
+         count, sum / count, ms[count / 2], ms[count * 95 / 100], ms[0], ms[count - 1]);
+}
+
+// Emulação e renderização rodam em threads separadas. A thread de emulação é
+// dona de tudo abaixo de "chip8" e publica cada frame no triple buffer; a de
+// renderização (a principal, como o SDL exige) só lê frames prontos e devolve
+// os eventos do teclado por uma fila sem locks, então um SDL_RenderPresent
+// preso no vsync nunca atrasa a emulação
+typedef struct {
+  // Thread de emulação
+  Chip8 chip8;
+  Chip8Sched sched;
+  Chip8Rewind* rewind_buffer;
+  Chip8Movie movie;
+  int recording, playing;
+  uint32_t play_frame;
+  const char* record_path;
+  char state_path[PATH_BYTES + sizeof(STATE_SUFFIX)];
+  uint16_t keys;                  // Teclado CHIP-8 após os eventos já aplicados
+  uint16_t latched;               // Teclas pressionadas desde o último frame (movie: toques curtos)
+  int just_applied;               // O último passo foi aplicar um evento (o próximo espera uma instrução)
+  uint64_t input_time;            // Instante da entrada mais antiga ainda não publicada em um frame
+  Chip8Capture* capture;          // --capture: frames com mudança no display vão para o codificador
+  uint64_t capture_frame;         // Frames de 60 Hz mostrados desde o início (o rewind também avança)
+  uint64_t capture_ticks;         // sched.ticks já contados em capture_frame
+
+  // Compartilhado
+  Chip8TripleBuffer frames;
+  Chip8InputQueue input;          // Teclas pressionadas/soltas, com o instante de chegada
+  atomic_int rewind_held;         // Backspace segurado
+  atomic_uint requests;           // REQUEST_SAVE | REQUEST_LOAD pendentes
+  atomic_int quit;
+  atomic_int frame_event_pending; // Já há um evento de frame novo na fila do SDL
+  Uint32 frame_event;             // Tipo do evento SDL que acorda a renderização
+  SDL_sem* wake;                  // Acorda a emulação (entrada, pedidos, fim)
+  Chip8AudioRing audio;           // Eventos do som: emulação -> callback de áudio
+
+  // Thread de áudio do SDL
+  Chip8Beeper beeper;
+} Emulator;
+
+// Callback do SDL: só consome o ring de eventos, sem locks nem chamadas ao núcleo
+static void audio_callback(void* userdata, Uint8* stream, int len) {
+  Emulator* emu = userdata;
+  chip8_beeper_stream(&emu->beeper, &emu->audio, (int16_t*)stream, (uint32_t)len / sizeof(int16_t));
+}
+
+// Pedido da renderização para a emulação
+static void post_request(Emulator* emu, unsigned request) {
+  atomic_fetch_or(&emu->requests, request);
+  SDL_SemPost(emu->wake);
+}
+
+static void handle_requests(Emulator* emu, unsigned requests) {
+  Chip8* chip8 = &emu->chip8;
+  if (requests & REQUEST_SAVE) {
+    int result = chip8_save_state(chip8, emu->state_path);
+    printf("%s: %s\n", result == 0 ? "Estado salvo" : chip8_state_error(result), emu->state_path);
+  }
+  if (requests & REQUEST_LOAD) {
+    // Um movie só é reproduzível a partir do início da ROM: carregar um estado o encerra
+    if (emu->recording) {
+      printf("Aviso: gravação do movie encerrada antes de carregar o estado\n");
+      finish_recording(&emu->movie, chip8, emu->record_path);
+      emu->recording = 0;
+    } else if (emu->playing) {
+      printf("Aviso: reprodução do movie interrompida\n");
+      emu->playing = 0;
+    }
+    int result = chip8_load_state(chip8, emu->state_path);
+    printf("%s: %s\n", result == 0 ? "Estado carregado" : chip8_state_error(result), emu->state_path);
+    if (result == 0 && emu->rewind_buffer) {
+      chip8_rewind_clear(emu->rewind_buffer); // O histórico anterior não leva a este estado
+    }
+  }
+}
+
+// Marca a entrada para a medição de latência (o frame publicado em seguida a reflete)
+static void apply_input(Emulator* emu, const Chip8InputEvent* ev) {
+  emu->keys = chip8_input_apply(emu->keys, ev);
+  if (ev->down) {
+    emu->latched |= (uint16_t)(1u << ev->key);
+  }
+  if (!emu->input_time) {
+    emu->input_time = ev->time;
+  }
+}
+
+// Modo livre: emula `units` unidades correspondentes ao intervalo de tempo real
+// [start, end], aplicando cada evento do teclado no ciclo do instante em que chegou
+static void run_free(Emulator* emu, uint64_t start, uint64_t end, uint64_t units, uint64_t counter_hz) {
+  Chip8* chip8 = &emu->chip8;
+  uint64_t done = 0;
+  Chip8InputEvent ev;
+  while (chip8_input_peek(&emu->input, &ev) && ev.time <= end) {
+    uint64_t at = ev.time > start ? (ev.time - start) * emu->sched.clock_hz / counter_hz : 0;
+    if (at < done + (uint64_t)emu->just_applied) {
+      at = done + (uint64_t)emu->just_applied; // Toques curtos valem por pelo menos uma instrução
+    }
+    if (at > done) {
+      chip8_sched_run(&emu->sched, chip8, at - done);
+      done = at;
+    }
+    apply_input(emu, &ev);
+    chip8_set_keys(chip8, emu->keys);
+    chip8_input_pop(&emu->input);
+    emu->just_applied = 1;
+  }
+  if (units > done) {
+    chip8_sched_run(&emu->sched, chip8, units - done);
+    emu->just_applied = 0;
+  }
+  emu->latched = 0;
+}
+
+// Registra o frame no rewind; se nem um keyframe cabe na arena, o recurso é desativado
+static void push_rewind(Emulator* emu) {
+  if (emu->rewind_buffer && chip8_rewind_push(emu->rewind_buffer, &emu->chip8) != 0) {
+    printf("Aviso: o estado não cabe no buffer de rewind; recurso desativado\n");
+    chip8_rewind_destroy(emu->rewind_buffer);
+    emu->rewind_buffer = NULL;
+  }
+}
+
+// Um frame (de um tick dos temporizadores ao seguinte) com movie ativo, ou um frame de rewind
+static void step_frame(Emulator* emu, int rewinding) {
+  Chip8* chip8 = &emu->chip8;
+  Chip8Movie* movie = &emu->movie;
+
+  if (emu->playing && emu->play_frame == movie->frames) {
+    // Fim do movie: confere o framebuffer e devolve o controle ao teclado
+    if (!movie->has_final_hash) {
+      printf("Movie reproduzido: %u frames\n", movie->frames);
+    } else if (movie->final_hash == chip8_display_hash(chip8)) {
+      printf("Movie reproduzido: %u frames, framebuffer idêntico ao gravado\n", movie->frames);
+    } else {
+      printf("Movie reproduzido: DIVERGÊNCIA no framebuffer final\n");
+    }
+    emu->playing = 0;
+  }
+
+  if (rewinding) {
+    // Rewind: restaura o frame anterior em vez de emular (para no início do histórico)
+    // O movie acompanha: a gravação descarta o frame desfeito e a reprodução recua
+    if (chip8_rewind_step_back(emu->rewind_buffer, chip8, 1) == 0) {
+      if (emu->recording && movie->frames > 0) {
+        movie->frames--;
+        chip8_sched_seek(&emu->sched, movie->frames);
+      } else if (emu->playing && emu->play_frame > 0) {
+        emu->play_frame--;
+        chip8_sched_seek(&emu->sched, emu->play_frame);
+      }
+      if ((emu->recording || emu->playing) && emu->sched.vip_costs) {
+        // Com custos do VIP, a última instrução de um frame pode invadir o seguinte:
+        // voltar ao início exato do frame não é garantido, então o movie termina aqui
+        printf("Aviso: rewind com custos do VIP encerra o movie\n");
+        if (emu->recording) {
+          finish_recording(movie, chip8, emu->record_path);
+        }
+        emu->recording = emu->playing = 0;
+      }
+    }
+    return;
+  }
+
+  // O movie guarda uma máscara por frame: um toque que começou e terminou dentro
+  // do frame conta como pressionado nele
+  uint16_t keys = emu->keys | emu->latched;
+  emu->latched = 0;
+  chip8_set_keys(chip8, emu->playing ? movie->keys[emu->play_frame] : keys);
+  if (emu->recording && chip8_movie_append(movie, keys) != 0) {
+    printf("Aviso: sem memória para o movie; gravação encerrada\n");
+    finish_recording(movie, chip8, emu->record_path);
+    emu->recording = 0;
+  }
+  chip8_sched_run(&emu->sched, chip8, chip8_sched_until_tick(&emu->sched));
+  if (emu->playing) {
+    emu->play_frame++;
+  }
+  push_rewind(emu);
+}
+
+static int emulation_thread(void* data) {
+  Emulator* emu = data;
+  Chip8* chip8 = &emu->chip8;
+
+  // Escalonador: o tempo real decorrido (SDL_GetPerformanceCounter) vira unidades de
+  // tempo emulado; a fração que sobra de cada conversão é levada para a iteração seguinte
+  const uint64_t counter_hz = SDL_GetPerformanceFrequency();
+  const uint64_t max_elapsed = counter_hz * MAX_CATCH_UP_MS / 1000;
+  uint64_t last_counter = SDL_GetPerformanceCounter();
+  uint64_t unit_carry = 0;  // Fração de unidade emulada (modo livre)
+  uint64_t frame_carry = 0; // Fração de frame (movie e rewind)
+  uint64_t pushed_tick = 0; // Último tick registrado no rewind
+  uint32_t published_gen = chip8->display_gen;
+  chip8_triple_publish(&emu->frames, chip8, 0, 0);
+  if (emu->capture) {
+    chip8_capture_push(emu->capture, chip8, 0);
+    emu->capture_ticks = emu->sched.ticks;
+  }
+
+  while (!atomic_load(&emu->quit)) {
+    int rewinding = emu->rewind_buffer && atomic_load(&emu->rewind_held);
+    unsigned requests = atomic_exchange(&emu->requests, 0);
+    if (requests) {
+      handle_requests(emu, requests);
+    }
+
+    uint64_t counter = SDL_GetPerformanceCounter();
+    uint64_t elapsed = counter - last_counter;
+    last_counter = counter;
+    if (elapsed > max_elapsed) {
+      elapsed = max_elapsed;
+    }
+
+    int per_frame = rewinding || emu->recording || emu->playing;
+    uint64_t frames_stepped = 0;
+    if (per_frame) {
+      // Um frame a cada 1/60 s de tempo real: o movie não depende do relógio
+      // e o rewind volta no ritmo do jogo
+      // Os eventos chegados até agora valem para os próximos frames
+      Chip8InputEvent ev;
+      while (chip8_input_peek(&emu->input, &ev) && ev.time <= counter) {
+        apply_input(emu, &ev);
+        chip8_input_pop(&emu->input);
+      }
+      uint64_t scaled = elapsed * CHIP8_TIMER_HZ + frame_carry;
+      frame_carry = scaled % counter_hz;
+      frames_stepped = scaled / counter_hz;
+      for (uint64_t f = frames_stepped; f > 0; f--) {
+        step_frame(emu, rewinding);
+      }
+      unit_carry = 0;
+    } else {
+      // Emula o tempo real decorrido; os temporizadores avançam dentro de chip8_sched_run
+      // exatamente 60 vezes por segundo emulado, mesmo se frames forem perdidos
+      chip8_set_keys(chip8, emu->keys);
+      uint64_t scaled = elapsed * emu->sched.clock_hz + unit_carry;
+      unit_carry = scaled % counter_hz;
+      run_free(emu, counter - elapsed, counter, scaled / counter_hz, counter_hz);
+      if (emu->rewind_buffer && emu->sched.ticks != pushed_tick) {
+        push_rewind(emu);
+        pushed_tick = emu->sched.ticks;
+      }
+      frame_carry = 0;
+    }
+
+    // Tempo emulado alcançado (e o estado do som após load ou rewind) para o callback de áudio
+    chip8_sched_sync_audio(&emu->sched, chip8);
+
+    // Relógio do vídeo: avança com os ticks emulados e, no rewind (que recua os ticks),
+    // um frame por passo, como na tela
+    if (emu->capture) {
+      if (rewinding) {
+        emu->capture_frame += frames_stepped;
+      } else if (emu->sched.ticks > emu->capture_ticks) {
+        emu->capture_frame += emu->sched.ticks - emu->capture_ticks;
+      }
+      emu->capture_ticks = emu->sched.ticks;
+    }
+
+    // Publica só frames em que o display mudou; um único evento SDL pendente por vez
+    if (chip8->display_gen != published_gen || chip8->dirty_rows) {
+      published_gen = chip8->display_gen;
+      chip8_triple_publish(&emu->frames, chip8, emu->sched.ticks, emu->input_time);
+      if (emu->capture) {
+        chip8_capture_push(emu->capture, chip8, emu->capture_frame); // Só uma cópia: o codificador é outra thread
+      }
+      emu->input_time = 0;
+      if (!atomic_exchange(&emu->frame_event_pending, 1)) {
+        SDL_Event event;
+        memset(&event, 0, sizeof(event));
+        event.type = emu->frame_event;
+        SDL_PushEvent(&event);
+      }
+    }
+
+    // Parado em 1NNN para si mesmo ou em FX0A, com os temporizadores zerados: nada muda
+    // até a renderização mandar outra entrada ou um pedido. Durante a reprodução de um
+    // movie as teclas vêm do arquivo
+    if (!emu->playing && !rewinding && chip8->delay_timer == 0 && chip8->sound_timer == 0) {
+      Chip8Idle idle = chip8_idle(chip8);
+      if (idle == CHIP8_IDLE_HALT || idle == CHIP8_IDLE_KEY_WAIT) {
+        SDL_SemWait(emu->wake);
+        last_counter = SDL_GetPerformanceCounter(); // O tempo parado não é emulado
+        continue;
+      }
+    }
+
+    // Dorme até o próximo tick (ou o próximo frame de movie/rewind); entrada nova acorda antes
+    uint64_t wait_ms = per_frame
+      ? (counter_hz - frame_carry) * 1000 / (CHIP8_TIMER_HZ * counter_hz)
+      : chip8_sched_until_tick(&emu->sched) * 1000 / emu->sched.clock_hz;
+    if (emu->sched.audio && wait_ms > AUDIO_WAKE_MS) {
+      wait_ms = AUDIO_WAKE_MS; // O som só pode ser gerado depois que o tempo emulado o alcança
+    }
+    SDL_SemWaitTimeout(emu->wake, (Uint32)wait_ms + 1);
+  }
+
+  if (emu->recording) {
+    finish_recording(&emu->movie, chip8, emu->record_path);
+  }
+  return 0;
+}
+
 int main(int argc, char* argv[]) {
   // Verifica argumentos
-  if (argc != 2) {
-    printf("Uso: %s <arquivo_rom>\n", argv[0]);
+  const char* rom_path = NULL;
+  const char* palette_spec = "classico";
+  const char* record_path = NULL;
+  const char* play_path = NULL;
+  int prescale = 0; // 0 = automático (pré-escala apenas com renderizador por software)
+  uint32_t clock_hz = 0; // 0 = padrão do modelo de custo
+  int vip_costs = 0;
+  int measure_latency = 0;
+  const char* library_dir = LIBRARY_DIR;
+  int quirks_override = -1; // -1 = as do banco de ROMs
+  Chip8Machine machine = CHIP8_MACHINE_CHIP8;
+  const char* capture_path = NULL;
+  int capture_scale = CAPTURE_SCALE;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--hz") == 0 && i + 1 < argc) {
+      clock_hz = (uint32_t)strtoul(argv[++i], NULL, 10);
+      if (clock_hz < CHIP8_CLOCK_MIN_HZ || clock_hz > CHIP8_CLOCK_MAX_HZ) {
+        printf("Erro: o clock deve estar entre %d e %d Hz\n", CHIP8_CLOCK_MIN_HZ, CHIP8_CLOCK_MAX_HZ);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "--vip") == 0) {
+      vip_costs = 1;
+    } else if (strcmp(argv[i], "--library") == 0 && i + 1 < argc) {
+      library_dir = argv[++i];
+    } else if (strcmp(argv[i], "--quirks") == 0 && i + 1 < argc) {
+      uint8_t quirks;
+      if (chip8_quirks_parse(argv[++i], &quirks) != 0) {
+        printf("Erro: quirks desconhecidas: %s (perfis: modern, vip, schip, xochip)\n", argv[i]);
+        return 1;
+      }
+      quirks_override = quirks;
+    } else if (strcmp(argv[i], "--machine") == 0 && i + 1 < argc) {
+      if (chip8_machine_parse(argv[++i], &machine) != 0) {
+        printf("Erro: modelo de máquina desconhecido: %s (chip8, schip, xochip)\n", argv[i]);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+      capture_path = argv[++i];
+    } else if (strcmp(argv[i], "--capture-scale") == 0 && i + 1 < argc) {
+      capture_scale = atoi(argv[++i]);
+      if (capture_scale < 1 || capture_scale > CHIP8_CAPTURE_MAX_SCALE) {
+        printf("Erro: a escala do vídeo deve estar entre 1 e %d\n", CHIP8_CAPTURE_MAX_SCALE);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "-L") == 0) {
+      measure_latency = 1;
+    } else if (strcmp(argv[i], "-R") == 0 && i + 1 < argc && !play_path) {
+      record_path = argv[++i];
+    } else if (strcmp(argv[i], "-P") == 0 && i + 1 < argc && !record_path) {
+      play_path = argv[++i];
+    } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+      palette_spec = argv[++i];
+    } else if (strcmp(argv[i], "-x") == 0 && i + 1 < argc) {
+      prescale = atoi(argv[++i]);
+      if (prescale < 1 || prescale > CHIP8_RENDER_MAX_SCALE) {
+        printf("Erro: pré-escala deve estar entre 1 e %d\n", CHIP8_RENDER_MAX_SCALE);
+        return 1;
+      }
+    } else if (argv[i][0] != '-' && !rom_path) {
+      rom_path = argv[i];
+    } else {
+      rom_path = NULL;
+      break;
+    }
+  }
+  if (!rom_path) {
+    printf("Uso: %s <arquivo_rom | @sha1> [-p paleta] [-x pre_escala] [--hz clock] [--vip] [-L] [-R movie | -P movie]\n"
+           "       [--library dir] [--quirks perfil] [--machine modelo] [--capture video [--capture-scale N]]\n", argv[0]);
+    printf("  -p paleta  classico, invertido, fosforo, ambar, lcd ou RRGGBB:RRGGBB (apagado:aceso)\n");
+    printf("  -x N       pré-escala inteira da textura (padrão: %d com renderizador por software, 1 caso contrário)\n", SCALE);
+    printf("  --hz N     clock da CPU em instruções/s (padrão: %d)\n", CHIP8_DEFAULT_CLOCK_HZ);
+    printf("  --vip      custo de cada opcode como no COSMAC VIP (clock em µs/s, padrão: %d)\n", CHIP8_VIP_CLOCK_HZ);
+    printf("  -L         mede a latência entrada -> tela e mostra um resumo ao fechar\n");
+    printf("  -R movie   grava as teclas de cada frame no arquivo (salvo ao fechar)\n");
+    printf("  -P movie   reproduz um movie gravado e depois devolve o controle ao teclado\n");
+    printf("  --library D  biblioteca indexada usada por @sha1 (padrão: %s)\n", LIBRARY_DIR);
+    printf("  --quirks Q   modern, vip, schip, xochip ou quirks separadas por vírgula (shift_vy, load_store_i,\n"
+           "               jump_vx, clip), no lugar das do banco de ROMs\n");
+    printf("  --machine M  chip8 (padrão), schip (SUPER-CHIP 1.1, 128x64) ou xochip (XO-CHIP, 64 KB e dois planos)\n");
+    printf("  --capture F  grava a sessão em F (fechado ao sair): GIF animado ou, com extensão .y4m,\n"
+           "               vídeo YUV4MPEG2 a 60 quadros/s; a codificação roda em outra thread\n");
+    printf("  --capture-scale N  escala inteira do vídeo (1 a %d, padrão: %d)\n", CHIP8_CAPTURE_MAX_SCALE, CAPTURE_SCALE);
+    return 1;
+  }
+
+  // "@hash": ROM da biblioteca; a imagem mapeada é copiada e a biblioteca fechada
+  static char library_path[PATH_BYTES];
+  static uint8_t rom_image[CHIP8_ROM_MAX_XO];
+  uint32_t rom_size = 0;
+  int from_library = rom_path[0] == '@';
+  if (from_library) {
+    if (library_rom(library_dir, rom_path + 1, library_path, sizeof(library_path), rom_image, &rom_size) != 0) {
+      return 1;
+    }
+    rom_path = library_path;
+  }
+  if (strlen(rom_path) >= PATH_BYTES) {
+    printf("Erro: caminho da ROM longo demais (máximo de %d bytes)\n", PATH_BYTES - 1);
+    return 1;
+  }
+  if (clock_hz == 0) {
+    clock_hz = vip_costs ? CHIP8_VIP_CLOCK_HZ : CHIP8_DEFAULT_CLOCK_HZ;
+  }
+
+  // Movie: o hash da ROM impede reproduzir entradas gravadas com outro jogo
+  Chip8Movie movie;
+  int recording = 0, playing = 0;
+  uint32_t play_frame = 0;
+  if (record_path || play_path) {
+    uint64_t rom_hash;
+    if (chip8_rom_file_hash(rom_path, &rom_hash) != 0) {
+      printf("Erro: não foi possível ler %s\n", rom_path);
+      return 1;
+    }
+    if (play_path) {
+      int result = chip8_movie_load(&movie, play_path);
+      if (result != 0) {
+        printf("Erro: %s: %s\n", chip8_movie_error(result), play_path);
+        return 1;
+      }
+      if (movie.rom_hash != rom_hash) {
+        printf("Erro: o movie foi gravado com outra ROM: %s\n", play_path);
+        chip8_movie_free(&movie);
+        return 1;
+      }
+      clock_hz = movie.clock_hz; // A reprodução usa o clock e o modelo de máquina da gravação
+      vip_costs = movie.vip_costs;
+      machine = (Chip8Machine)movie.machine;
+      playing = 1;
+    } else {
+      chip8_movie_init(&movie, rom_hash, clock_hz, vip_costs);
+      movie.machine = (uint8_t)machine;
+      recording = 1;
+    }
+  }
+  if (machine != CHIP8_MACHINE_CHIP8 && vip_costs) {
+    printf("Erro: --vip só vale para o CHIP-8 (sem --machine %s)\n", chip8_machine_name(machine));
+    if (record_path || play_path) {
+      chip8_movie_free(&movie);
+    }
+    return 1;
+  }
+
+  // SUPER-CHIP / XO-CHIP: textura de 128x64 (lores é desenhado em 2x2) na mesma janela
+  int extended = machine != CHIP8_MACHINE_CHIP8;
+  int screen_width = extended ? CHIP8_HIRES_WIDTH : CHIP8_WIDTH;
+  int screen_height = extended ? CHIP8_HIRES_HEIGHT : CHIP8_HEIGHT;
+
+  Chip8Palette palette;
+  if (chip8_palette_parse(palette_spec, &palette) != 0) {
+    printf("Erro: paleta inválida: %s\n", palette_spec);
     return 1;
   }
 
@@ -69,11 +597,11 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
-  // Cria renderizador
+  // Cria renderizador (o vsync só prende a thread de renderização)
   SDL_Renderer* renderer = SDL_CreateRenderer(
     window,
     -1,
-    SDL_RENDERER_ACCELERATED
+    SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC
   );
   if (!renderer) {
     printf("Erro ao criar renderizador: %s\n", SDL_GetError());
@@ -82,14 +610,25 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
+  // Sem aceleração por GPU, o SDL escala a textura pixel a pixel a cada
+  // apresentação; pré-escalar na conversão deixa o SDL_RenderCopy como cópia 1:1
+  if (prescale == 0) {
+    SDL_RendererInfo renderer_info;
+    prescale = 1;
+    if (SDL_GetRendererInfo(renderer, &renderer_info) == 0 &&
+        (renderer_info.flags & SDL_RENDERER_SOFTWARE)) {
+      prescale = extended ? SCALE / 2 : SCALE;
+    }
+  }
+
   // Cria textura para o display
   // Usa formato nativo do renderer para melhor performance
   SDL_Texture* texture = SDL_CreateTexture(
     renderer,
     SDL_PIXELFORMAT_RGBA8888,
     SDL_TEXTUREACCESS_STREAMING,
-    CHIP8_WIDTH,
-    CHIP8_HEIGHT
+    screen_width * prescale,
+    screen_height * prescale
   );
   if (!texture) {
     printf("Erro ao criar textura: %s\n", SDL_GetError());
@@ -99,27 +638,51 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
-  // Inicializa CHIP-8
-  Chip8 chip8;
-  chip8_init(&chip8);
+  // Mapeia as cores da paleta uma única vez (SDL_MapRGBA garante a ordem correta de bytes)
+  SDL_PixelFormat* format = SDL_AllocFormat(SDL_PIXELFORMAT_RGBA8888);
+  if (!format) {
+    printf("Erro ao criar formato de pixel: %s\n", SDL_GetError());
+    SDL_DestroyTexture(texture);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return 1;
+  }
+  Chip8Render render;
+  chip8_render_init(&render,
+                    SDL_MapRGBA(format, palette.off[0], palette.off[1], palette.off[2], 255),
+                    SDL_MapRGBA(format, palette.on[0], palette.on[1], palette.on[2], 255),
+                    prescale);
+  // Pixels só do segundo plano (XO-CHIP) e dos dois: tons entre as cores da paleta
+  chip8_render_set_planes(&render,
+                          SDL_MapRGBA(format, (uint8_t)((2 * palette.off[0] + palette.on[0]) / 3),
+                                      (uint8_t)((2 * palette.off[1] + palette.on[1]) / 3),
+                                      (uint8_t)((2 * palette.off[2] + palette.on[2]) / 3), 255),
+                          SDL_MapRGBA(format, (uint8_t)((palette.off[0] + 2 * palette.on[0]) / 3),
+                                      (uint8_t)((palette.off[1] + 2 * palette.on[1]) / 3),
+                                      (uint8_t)((palette.off[2] + 2 * palette.on[2]) / 3), 255));
+  SDL_FreeFormat(format);
+
+  // Estado da emulação (no heap: o Chip8 sozinho tem dezenas de KB)
+  Emulator* emu = calloc(1, sizeof(Emulator));
+  if (!emu) {
+    printf("Erro: sem memória\n");
+    SDL_DestroyTexture(texture);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return 1;
+  }
 
-  // Carrega ROM
-  int rom_result = chip8_load_rom(&chip8, argv[1]);
+  // Inicializa CHIP-8 e carrega ROM
+  chip8_init(&emu->chip8);
+  int rom_result = chip8_set_machine(&emu->chip8, machine) != 0 ? -4
+                   : from_library ? chip8_load_rom_image(&emu->chip8, rom_image, rom_size)
+                                  : chip8_load_rom(&emu->chip8, rom_path);
   if (rom_result != 0) {
-    switch (rom_result) {
-      case -1:
-        printf("Erro: Arquivo não encontrado: %s\n", argv[1]);
-        break;
-      case -2:
-        printf("Erro: ROM muito grande (máximo 3584 bytes)\n");
-        break;
-      case -3:
-        printf("Erro: Falha ao ler o arquivo: %s\n", argv[1]);
-        break;
-      default:
-        printf("Erro desconhecido ao carregar ROM: %s\n", argv[1]);
-        break;
-    }
+    printf("Erro: %s: %s\n", chip8_load_error(rom_result), rom_path);
+    chip8_release(&emu->chip8);
+    free(emu);
     SDL_DestroyTexture(texture);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
@@ -127,93 +690,241 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
-  // Variáveis para controle de loop e temporizadores
-  int running = 1;
-  uint32_t last_timer_tick = SDL_GetTicks();
-  uint32_t last_frame_time = SDL_GetTicks();
-  const uint32_t frame_delay = 1000 / TARGET_FPS; // Delay em milissegundos para 60 FPS
+  // Quirks: as do banco de ROMs, as de --quirks ou, reproduzindo, as da gravação
+  if (quirks_override >= 0) {
+    emu->chip8.quirks = (uint8_t)quirks_override;
+  }
+  if (playing) {
+    emu->chip8.quirks = movie.quirks;
+  } else if (recording) {
+    movie.quirks = emu->chip8.quirks;
+  }
 
-  // Loop principal
-  while (running) {
-    // Processa eventos SDL
-    SDL_Event event;
-    while (SDL_PollEvent(&event)) {
-      if (event.type == SDL_QUIT) {
-        running = 0;
+  // Vídeo: mesmas cores da tela; a paleta, a escala e a compressão ficam na thread do codificador
+  if (capture_path) {
+    Chip8CapturePalette colors;
+    for (int c = 0; c < 3; c++) {
+      colors[0][c] = palette.off[c];
+      colors[1][c] = palette.on[c];
+      colors[2][c] = (uint8_t)((2 * palette.off[c] + palette.on[c]) / 3);
+      colors[3][c] = (uint8_t)((palette.off[c] + 2 * palette.on[c]) / 3);
+    }
+    emu->capture = chip8_capture_open(capture_path, machine, capture_scale, colors);
+    if (!emu->capture) {
+      printf("Erro: não foi possível criar %s\n", capture_path);
+      if (record_path || play_path) {
+        chip8_movie_free(&movie);
       }
+      chip8_release(&emu->chip8);
+      free(emu);
+      SDL_DestroyTexture(texture);
+      SDL_DestroyRenderer(renderer);
+      SDL_DestroyWindow(window);
+      SDL_Quit();
+      return 1;
     }
+  }
 
-    // Atualiza keypad com estado atual do teclado
-    // Usa SDL_GetKeyboardState para obter estado atual de todas as teclas
-    SDL_PumpEvents();
-    const Uint8* keyboard_state = SDL_GetKeyboardState(NULL);
+  // Save state ao lado da ROM (<rom>.state): F5 grava, F9 carrega; o tamanho do caminho
+  // já foi conferido, então state_path sempre cabe
+  snprintf(emu->state_path, sizeof(emu->state_path), "%s" STATE_SUFFIX, rom_path);
 
-    // Atualiza keypad: mantém estado enquanto tecla estiver pressionada
-    // Isso permite que instruções EX9E e EXA1 funcionem corretamente
-    for (int i = 0; i < 16; i++) {
-      chip8.keypad[i] = keyboard_state[keymap[i]] ? 1 : 0;
-    }
+  // Rewind: segure Backspace para voltar no tempo, um frame por frame
+  emu->rewind_buffer = chip8_rewind_create(REWIND_ARENA_BYTES, REWIND_KEYFRAME_INTERVAL);
+  if (!emu->rewind_buffer) {
+    printf("Aviso: sem memória para o rewind; recurso desativado\n");
+  }
 
-    // Executa múltiplos ciclos do CHIP-8 por frame
-    for (int i = 0; i < CYCLES_PER_FRAME; i++) {
-      chip8_cycle(&chip8);
-    }
+  emu->movie = movie;
+  emu->recording = recording;
+  emu->playing = playing;
+  emu->play_frame = play_frame;
+  emu->record_path = record_path;
+  chip8_sched_init(&emu->sched, clock_hz, vip_costs);
+  chip8_triple_init(&emu->frames);
+  chip8_input_init(&emu->input);
+  atomic_init(&emu->rewind_held, 0);
+  atomic_init(&emu->requests, 0);
+  atomic_init(&emu->quit, 0);
+  atomic_init(&emu->frame_event_pending, 0);
+  chip8_audio_init(&emu->audio);
+  emu->frame_event = SDL_RegisterEvents(1);
+  emu->wake = SDL_CreateSemaphore(0);
 
-    // Decrementa temporizadores a 60 Hz (independentemente da velocidade de execução)
-    uint32_t now = SDL_GetTicks();
-    if (now - last_timer_tick >= (1000 / TIMER_HZ)) {
-      if (chip8.delay_timer > 0) {
-        chip8.delay_timer--;
-      }
-      if (chip8.sound_timer > 0) {
-        chip8.sound_timer--;
-        // TODO: Emitir beep aqui (usando SDL_mixer ou similar)
-      }
-      last_timer_tick = now;
+  // Áudio: callbacks de 256 amostras; sem dispositivo o emulador segue mudo
+  SDL_AudioSpec want, have;
+  memset(&want, 0, sizeof(want));
+  want.freq = AUDIO_SAMPLE_RATE;
+  want.format = AUDIO_S16SYS;
+  want.channels = 1;
+  want.samples = AUDIO_BUFFER_FRAMES;
+  want.callback = audio_callback;
+  want.userdata = emu;
+  SDL_AudioDeviceID audio_device = SDL_OpenAudioDevice(NULL, 0, &want, &have, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+  if (audio_device) {
+    chip8_beeper_init(&emu->beeper, (uint32_t)have.freq, emu->sched.clock_hz);
+    chip8_sched_attach_audio(&emu->sched, &emu->audio, (uint32_t)have.freq);
+  } else {
+    printf("Aviso: sem áudio: %s\n", SDL_GetError());
+  }
+
+  SDL_Thread* thread = NULL;
+  if (emu->wake && emu->frame_event != (Uint32)-1) {
+    thread = SDL_CreateThread(emulation_thread, "chip8-emulacao", emu);
+  }
+  if (!thread) {
+    printf("Erro ao criar a thread de emulação: %s\n", SDL_GetError());
+    if (audio_device) {
+      SDL_CloseAudioDevice(audio_device);
     }
+    if (emu->wake) {
+      SDL_DestroySemaphore(emu->wake);
+    }
+    chip8_rewind_destroy(emu->rewind_buffer);
+    if (record_path || play_path) {
+      chip8_movie_free(&emu->movie);
+    }
+    chip8_capture_close(emu->capture, 0);
+    chip8_release(&emu->chip8);
+    free(emu);
+    SDL_DestroyTexture(texture);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return 1;
+  }
 
-    // Renderiza display
-    // Converte array display[] (valores 0/1) em pixels RGBA8888
-    // Usa SDL_MapRGBA para garantir ordem correta de bytes
-    void* pixels_ptr;
-    int pitch;
-    if (SDL_LockTexture(texture, NULL, &pixels_ptr, &pitch) == 0) {
-      SDL_PixelFormat* format = SDL_AllocFormat(SDL_PIXELFORMAT_RGBA8888);
-      uint32_t white = SDL_MapRGBA(format, 255, 255, 255, 255);
-      uint32_t black = SDL_MapRGBA(format, 0, 0, 0, 255);
+  if (audio_device) {
+    SDL_PauseAudioDevice(audio_device, 0);
+  }
 
-      // Converte diretamente para a textura, linha por linha
-      // IMPORTANTE: pitch pode ser maior que width * sizeof(uint32_t) devido ao alinhamento
-      uint8_t* dst = (uint8_t*)pixels_ptr;
-      for (int y = 0; y < CHIP8_HEIGHT; y++) {
-        uint32_t* row = (uint32_t*)(dst + y * pitch);
-        for (int x = 0; x < CHIP8_WIDTH; x++) {
-          // Calcula índice no array display: y * width + x
-          int display_index = y * CHIP8_WIDTH + x;
-          row[x] = chip8.display[display_index] ? white : black;
+  // Loop da renderização: dorme em SDL_WaitEvent até chegar entrada, evento de
+  // janela ou o aviso de frame novo da emulação
+  int running = 1;
+  int needs_present = 1;                 // Força o primeiro frame (e exposições da janela)
+  uint32_t upload_rows = 0xFFFFFFFFu;    // Linhas da textura desatualizadas
+  uint64_t present_input = 0;            // input_time do frame a apresentar (-L)
+  float* latency_ms = measure_latency ? calloc(LATENCY_SAMPLES, sizeof(float)) : NULL;
+  uint32_t latency_count = 0;
+  while (running) {
+    SDL_Event event;
+    if (!SDL_WaitEvent(&event)) {
+      break;
+    }
+    do {
+      if (event.type == SDL_QUIT) {
+        running = 0;
+      } else if (event.type == emu->frame_event) {
+        atomic_store(&emu->frame_event_pending, 0); // Antes do acquire: o próximo frame gera outro evento
+      } else if (event.type == SDL_WINDOWEVENT &&
+                 (event.window.event == SDL_WINDOWEVENT_EXPOSED ||
+                  event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)) {
+        needs_present = 1; // A janela precisa ser redesenhada mesmo sem mudança no display
+      } else if ((event.type == SDL_KEYDOWN && !event.key.repeat) || event.type == SDL_KEYUP) {
+        // Teclado CHIP-8: cada mudança vai para a fila com o instante de chegada (o carimbo
+        // do SDL tem resolução de ms); a emulação a aplica no ciclo correspondente
+        int down = event.type == SDL_KEYDOWN;
+        SDL_Scancode scancode = event.key.keysym.scancode;
+        for (int i = 0; i < 16; i++) {
+          if (keymap[i] == scancode) {
+            chip8_input_push(&emu->input, SDL_GetPerformanceCounter(), (uint8_t)i, down);
+            SDL_SemPost(emu->wake);
+          }
+        }
+        if (scancode == SDL_SCANCODE_BACKSPACE) {
+          atomic_store(&emu->rewind_held, down);
+          SDL_SemPost(emu->wake);
+        } else if (down && scancode == SDL_SCANCODE_F5) {
+          post_request(emu, REQUEST_SAVE);
+        } else if (down && scancode == SDL_SCANCODE_F9) {
+          post_request(emu, REQUEST_LOAD);
         }
+      } else if (event.type == SDL_RENDER_TARGETS_RESET || event.type == SDL_RENDER_DEVICE_RESET) {
+        upload_rows = 0xFFFFFFFFu; // Conteúdo da textura pode ter sido perdido
+        needs_present = 1;
       }
+    } while (SDL_PollEvent(&event));
 
-      SDL_FreeFormat(format);
-      SDL_UnlockTexture(texture);
+    // Frame mais recente publicado (os intermediários já foram descartados)
+    if (chip8_triple_acquire(&emu->frames)) {
+      upload_rows |= chip8_triple_front(&emu->frames)->dirty_rows;
+      present_input = chip8_triple_front(&emu->frames)->input_time;
+      needs_present = 1;
     }
 
-    // Desenha na janela
-    SDL_RenderClear(renderer);
-    // Define retângulo de destino para escalar a textura 64x32 para a janela escalada
-    SDL_Rect dest_rect = {0, 0, CHIP8_WIDTH * SCALE, CHIP8_HEIGHT * SCALE};
-    SDL_RenderCopy(renderer, texture, NULL, &dest_rect);
-    SDL_RenderPresent(renderer);
+    if (needs_present) {
+      const Chip8Frame* frame = chip8_triple_front(&emu->frames);
+      if (upload_rows) {
+        // Envia apenas a faixa de linhas entre a primeira e a última linha suja
+        int first = 0, last = CHIP8_HEIGHT - 1;
+        while (!(upload_rows & (1u << first))) first++;
+        while (!(upload_rows & (1u << last))) last--;
+        // Nas máquinas estendidas, cada bit de dirty_rows cobre duas linhas da textura
+        int rows_per_bit = extended ? 2 : 1;
+        SDL_Rect rows_rect = {0, first * rows_per_bit * prescale, screen_width * prescale,
+                              (last - first + 1) * rows_per_bit * prescale};
 
-    // Controle de FPS - mantém 60 FPS
-    uint32_t frame_time = SDL_GetTicks() - last_frame_time;
-    if (frame_time < frame_delay) {
-      SDL_Delay(frame_delay - frame_time);
+        // Converte as linhas empacotadas do frame (1 bit por pixel) direto para a textura
+        // IMPORTANTE: pitch pode ser maior que width * sizeof(uint32_t) devido ao alinhamento
+        void* pixels_ptr;
+        int pitch;
+        if (SDL_LockTexture(texture, &rows_rect, &pixels_ptr, &pitch) == 0) {
+          if (extended) {
+            chip8_render_screen(&render, frame->screen, frame->hires, first * 2, (last - first + 1) * 2,
+                                pixels_ptr, pitch);
+          } else {
+            chip8_render_rows(&render, frame->display, first, last - first + 1, pixels_ptr, pitch);
+          }
+          SDL_UnlockTexture(texture);
+        }
+        upload_rows = 0;
+      }
+
+      // Desenha na janela (com vsync, espera aqui: só esta thread)
+      SDL_RenderClear(renderer);
+      // Define retângulo de destino para escalar a textura (64x32 ou 128x64) para a janela escalada
+      SDL_Rect dest_rect = {0, 0, CHIP8_WIDTH * SCALE, CHIP8_HEIGHT * SCALE};
+      SDL_RenderCopy(renderer, texture, NULL, &dest_rect);
+      SDL_RenderPresent(renderer);
+      needs_present = 0;
+
+      // Latência: da chegada da tecla até o retorno do present do primeiro frame que a reflete
+      if (latency_ms && present_input) {
+        uint64_t ticks = SDL_GetPerformanceCounter() - present_input;
+        latency_ms[latency_count++ % LATENCY_SAMPLES] = (float)(1000.0 * (double)ticks / (double)SDL_GetPerformanceFrequency());
+      }
+      present_input = 0;
     }
-    last_frame_time = SDL_GetTicks();
+  }
+  if (latency_ms) {
+    print_latency(latency_ms, latency_count < LATENCY_SAMPLES ? latency_count : LATENCY_SAMPLES);
+    free(latency_ms);
   }
 
-  // Limpeza
+  // Limpeza (a emulação grava o movie antes de terminar)
+  atomic_store(&emu->quit, 1);
+  SDL_SemPost(emu->wake);
+  SDL_WaitThread(thread, NULL);
+  if (audio_device) {
+    SDL_CloseAudioDevice(audio_device);
+  }
+  if (emu->capture) {
+    unsigned long long dropped = emu->capture->dropped;
+    if (chip8_capture_close(emu->capture, emu->capture_frame) != 0) {
+      printf("Erro: falha ao gravar %s\n", capture_path);
+    } else if (dropped) {
+      printf("Vídeo gravado: %s (%llu frames descartados: o codificador não acompanhou)\n", capture_path, dropped);
+    } else {
+      printf("Vídeo gravado: %s\n", capture_path);
+    }
+  }
+  SDL_DestroySemaphore(emu->wake);
+  if (record_path || play_path) {
+    chip8_movie_free(&emu->movie);
+  }
+  chip8_rewind_destroy(emu->rewind_buffer);
+  chip8_release(&emu->chip8);
+  free(emu);
   SDL_DestroyTexture(texture);
   SDL_DestroyRenderer(renderer);
   SDL_DestroyWindow(window);
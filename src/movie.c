@@ -0,0 +1,226 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "movie.h"
+#include "sched.h"
+
+// Cabeçalho (36 bytes, little-endian): "C8MV", versão (u16), tamanho do
+// cabeçalho (u16), hash da ROM (u64), clock (u32), flags (u16), quirks (u8),
+// modelo de máquina (u8), frames (u32) e hash final do framebuffer (u64). Em
+// seguida, as sequências: máscara (u16) + repetições (LEB128)
+//
+// Versão 1 (32 bytes): no lugar do clock, ciclos por frame (u16) seguidos das
+// flags (u16); frames e hash final 4 bytes antes
+#define MOVIE_MAGIC "C8MV"
+#define MOVIE_HEADER_SIZE 36
+#define MOVIE_HEADER_SIZE_V1 32
+#define MOVIE_FLAG_FINAL_HASH 0x0001
+#define MOVIE_FLAG_VIP_COSTS  0x0002
+
+static inline void put16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put32(uint8_t *p, uint32_t v) {
+  for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static inline void put64(uint8_t *p, uint64_t v) {
+  for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static inline uint16_t get16(const uint8_t *p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t get32(const uint8_t *p) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; i++) v |= (uint32_t)p[i] << (8 * i);
+  return v;
+}
+
+static inline uint64_t get64(const uint8_t *p) {
+  uint64_t v = 0;
+  for (int i = 0; i < 8; i++) v |= (uint64_t)p[i] << (8 * i);
+  return v;
+}
+
+void chip8_movie_init(Chip8Movie *m, uint64_t rom_hash, uint32_t clock_hz, int vip_costs) {
+  memset(m, 0, sizeof(*m));
+  m->rom_hash = rom_hash;
+  m->clock_hz = clock_hz;
+  m->vip_costs = vip_costs;
+}
+
+void chip8_movie_free(Chip8Movie *m) {
+  free(m->keys);
+  m->keys = NULL;
+  m->frames = 0;
+  m->capacity = 0;
+}
+
+int chip8_movie_append(Chip8Movie *m, uint16_t keys) {
+  if (m->frames == m->capacity) {
+    uint32_t cap = m->capacity ? m->capacity * 2 : 4096;
+    uint16_t *grown = realloc(m->keys, sizeof(uint16_t) * cap);
+    if (!grown) {
+      return -1;
+    }
+    m->keys = grown;
+    m->capacity = cap;
+  }
+  m->keys[m->frames++] = keys;
+  return 0;
+}
+
+int chip8_movie_save(const Chip8Movie *m, const char *path) {
+  uint8_t header[MOVIE_HEADER_SIZE];
+  memcpy(header, MOVIE_MAGIC, 4);
+  put16(header + 4, CHIP8_MOVIE_VERSION);
+  put16(header + 6, MOVIE_HEADER_SIZE);
+  put64(header + 8, m->rom_hash);
+  put32(header + 16, m->clock_hz);
+  put16(header + 20, (m->has_final_hash ? MOVIE_FLAG_FINAL_HASH : 0) | (m->vip_costs ? MOVIE_FLAG_VIP_COSTS : 0));
+  header[22] = m->quirks;
+  header[23] = m->machine;
+  put32(header + 24, m->frames);
+  put64(header + 28, m->final_hash);
+
+  FILE *file = fopen(path, "wb");
+  if (!file) {
+    return -1;
+  }
+  int ok = fwrite(header, 1, sizeof(header), file) == sizeof(header);
+
+  for (uint32_t i = 0; i < m->frames && ok;) {
+    uint16_t keys = m->keys[i];
+    uint32_t run = 1;
+    while (i + run < m->frames && m->keys[i + run] == keys) run++;
+    i += run;
+
+    uint8_t buf[2 + 5];
+    size_t n = 2;
+    put16(buf, keys);
+    do {
+      uint8_t byte = run & 0x7F;
+      run >>= 7;
+      buf[n++] = byte | (run ? 0x80 : 0);
+    } while (run);
+    ok = fwrite(buf, 1, n, file) == n;
+  }
+
+  if (fclose(file) != 0 || !ok) {
+    return -6;
+  }
+  return 0;
+}
+
+int chip8_movie_load(Chip8Movie *m, const char *path) {
+  uint8_t header[MOVIE_HEADER_SIZE];
+
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    return -1;
+  }
+  if (fread(header, 1, 8, file) != 8 || memcmp(header, MOVIE_MAGIC, 4) != 0) {
+    fclose(file);
+    return -2;
+  }
+  uint16_t version = get16(header + 4);
+  uint16_t header_size = get16(header + 6);
+  if (version != CHIP8_MOVIE_VERSION && version != 1) {
+    fclose(file);
+    return -3;
+  }
+  if (header_size != (version == 1 ? MOVIE_HEADER_SIZE_V1 : MOVIE_HEADER_SIZE) ||
+      fread(header + 8, 1, header_size - 8u, file) != header_size - 8u) {
+    fclose(file);
+    return -2;
+  }
+
+  uint32_t frames;
+  uint16_t flags;
+  if (version == 1) {
+    chip8_movie_init(m, get64(header + 8), get16(header + 16) * (uint32_t)CHIP8_TIMER_HZ, 0);
+    flags = get16(header + 18);
+    frames = get32(header + 20);
+    m->final_hash = get64(header + 24);
+  } else {
+    flags = get16(header + 20);
+    chip8_movie_init(m, get64(header + 8), get32(header + 16), (flags & MOVIE_FLAG_VIP_COSTS) != 0);
+    m->quirks = (uint8_t)(header[22] & (CHIP8_QUIRK_COUNT - 1)); // Movies anteriores às quirks: 0
+    m->machine = header[23];
+    frames = get32(header + 24);
+    m->final_hash = get64(header + 28);
+  }
+  m->has_final_hash = (flags & MOVIE_FLAG_FINAL_HASH) != 0;
+  if (m->clock_hz < CHIP8_CLOCK_MIN_HZ || m->clock_hz > CHIP8_CLOCK_MAX_HZ || m->machine >= CHIP8_MACHINE_COUNT) {
+    fclose(file);
+    return -2;
+  }
+
+  while (m->frames < frames) {
+    uint8_t buf[2];
+    if (fread(buf, 1, 2, file) != 2) {
+      break;
+    }
+    uint16_t keys = get16(buf);
+    uint32_t run = 0;
+    int shift = 0, c;
+    do {
+      c = fgetc(file);
+      if (c == EOF || shift > 28) {
+        break;
+      }
+      run |= (uint32_t)(c & 0x7F) << shift;
+      shift += 7;
+    } while (c & 0x80);
+    if (c == EOF || run == 0 || run > frames - m->frames) {
+      break;
+    }
+    for (; run > 0; run--) {
+      if (chip8_movie_append(m, keys) != 0) {
+        fclose(file);
+        chip8_movie_free(m);
+        return -7;
+      }
+    }
+  }
+  fclose(file);
+
+  if (m->frames != frames) {
+    chip8_movie_free(m);
+    return -4;
+  }
+  return 0;
+}
+
+const char *chip8_movie_error(int code) {
+  switch (code) {
+    case 0:  return "Sucesso";
+    case -1: return "Não foi possível abrir o arquivo";
+    case -2: return "Arquivo não é um movie válido";
+    case -3: return "Versão de movie não suportada";
+    case -4: return "Movie truncado ou corrompido";
+    case -6: return "Falha ao gravar o arquivo";
+    case -7: return "Sem memória para o movie";
+    default: return "Erro desconhecido no movie";
+  }
+}
+
+int chip8_rom_file_hash(const char *path, uint64_t *hash) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    return -1;
+  }
+  uint64_t h = 0xcbf29ce484222325ULL;
+  int c;
+  while ((c = fgetc(file)) != EOF) {
+    h ^= (uint8_t)c;
+    h *= 0x100000001b3ULL;
+  }
+  fclose(file);
+  *hash = h;
+  return 0;
+}
@@ -0,0 +1,246 @@
+#define _POSIX_C_SOURCE 200809L // clock_gettime / CLOCK_MONOTONIC
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "profile.h"
+
+static const char* const op_names[CHIP8_OP_COUNT] = {
+  "????", "NOP",
+  "00E0", "00EE",
+  "1NNN", "2NNN",
+  "3XKK", "4XKK", "5XY0",
+  "6XKK", "7XKK",
+  "8XY0", "8XY1", "8XY2", "8XY3", "8XY4",
+  "8XY5", "8XY6", "8XY7", "8XYE",
+  "9XY0",
+  "ANNN", "BNNN",
+  "DXYN",
+  "EX9E", "EXA1",
+  "FX07", "FX0A", "FX15", "FX18", "FX1E",
+  "FX29", "FX33", "FX55", "FX65"
+};
+
+const char* chip8_profile_op_name(Chip8Op op) {
+  return op < CHIP8_OP_COUNT ? op_names[op] : "????";
+}
+
+#ifdef CHIP8_PROFILE
+
+_Thread_local Chip8Profile* chip8_profile_active = NULL;
+
+static inline uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+Chip8Profile* chip8_profile_create(void) {
+  Chip8Profile* p = calloc(1, sizeof(Chip8Profile));
+  if (!p) {
+    return NULL;
+  }
+  p->stacks = calloc(CHIP8_PROFILE_STACKS, sizeof(Chip8ProfileStack));
+  if (!p->stacks) {
+    free(p);
+    return NULL;
+  }
+  // Menor intervalo entre duas leituras do relógio: descontado de cada medição
+  uint64_t best = UINT64_MAX;
+  for (int i = 0; i < 1000; i++) {
+    uint64_t a = now_ns();
+    uint64_t b = now_ns();
+    if (b - a < best) {
+      best = b - a;
+    }
+  }
+  p->clock_overhead_ns = (uint32_t)best;
+  return p;
+}
+
+void chip8_profile_destroy(Chip8Profile* p) {
+  if (p) {
+    free(p->stacks);
+    free(p);
+  }
+}
+
+void chip8_profile_attach(Chip8Profile* p) {
+  chip8_profile_active = p;
+}
+
+// Conta a execução de `pc` na pilha de sub-rotinas atual (tabela com sondagem linear)
+static void count_stack(Chip8Profile* p, uint16_t pc) {
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for (int i = 0; i < p->depth; i++) {
+    h = (h ^ p->shadow[i]) * 0x100000001b3ULL;
+  }
+  h = (h ^ (0x10000u | pc)) * 0x100000001b3ULL;
+
+  for (uint32_t probe = 0; probe < 16; probe++) {
+    Chip8ProfileStack* s = &p->stacks[(h + probe) & (CHIP8_PROFILE_STACKS - 1)];
+    if (!s->used) {
+      s->used = 1;
+      s->pc = pc;
+      s->depth = p->depth;
+      memcpy(s->frames, p->shadow, sizeof(uint16_t) * p->depth);
+      s->count = 1;
+      return;
+    }
+    if (s->pc == pc && s->depth == p->depth && memcmp(s->frames, p->shadow, sizeof(uint16_t) * p->depth) == 0) {
+      s->count++;
+      return;
+    }
+  }
+  p->stacks_dropped++;
+}
+
+uint64_t chip8_profile_begin(Chip8Profile* p, const Chip8* chip8) {
+  uint16_t pc = chip8->pc & 0x0FFF;
+  uint16_t opcode = (uint16_t)((chip8->memory[pc] << 8) | chip8->memory[(pc + 1) & 0x0FFF]);
+  uint8_t op = chip8_decode(opcode).op;
+  p->instructions++;
+  p->op_count[op]++;
+  p->pc_count[pc]++;
+  p->pc_opcode[pc] = opcode;
+  p->current_op = op;
+  count_stack(p, pc);
+
+  if (op == CHIP8_OP_DXYN || (p->op_count[op] & (CHIP8_PROFILE_SAMPLE - 1)) == 0) {
+    return now_ns();
+  }
+  return 0;
+}
+
+void chip8_profile_end(Chip8Profile* p, const Chip8* chip8, uint64_t start) {
+  uint8_t op = p->current_op;
+  if (start) {
+    uint64_t ns = now_ns() - start;
+    ns = ns > p->clock_overhead_ns ? ns - p->clock_overhead_ns : 0;
+    p->op_timed[op]++;
+    p->op_ns[op] += ns;
+    if (op == CHIP8_OP_DXYN) {
+      p->draw_calls++;
+      p->draw_ns += ns;
+    }
+  }
+  // Pilha sombra: depois da instrução, o PC de um 2NNN é a entrada da sub-rotina
+  if (op == CHIP8_OP_2NNN) {
+    if (p->depth < CHIP8_PROFILE_MAX_DEPTH) {
+      p->shadow[p->depth++] = chip8->pc & 0x0FFF;
+    }
+  } else if (op == CHIP8_OP_00EE && p->depth > 0) {
+    p->depth--;
+  }
+}
+
+#else // Sem -DCHIP8_PROFILE: nada é medido
+
+Chip8Profile* chip8_profile_create(void) {
+  return NULL;
+}
+
+void chip8_profile_destroy(Chip8Profile* p) {
+  (void)p;
+}
+
+void chip8_profile_attach(Chip8Profile* p) {
+  (void)p;
+}
+
+#endif
+
+// Tempo estimado de um handler: média das execuções cronometradas × execuções
+static double estimated_ns(const Chip8Profile* p, int op) {
+  return p->op_timed[op] ? (double)p->op_ns[op] / (double)p->op_timed[op] * (double)p->op_count[op] : 0.0;
+}
+
+static const Chip8Profile* sort_profile; // qsort não recebe contexto
+
+static int compare_ops(const void* a, const void* b) {
+  uint64_t x = sort_profile->op_count[*(const int*)a], y = sort_profile->op_count[*(const int*)b];
+  return (x < y) - (x > y);
+}
+
+static int compare_pcs(const void* a, const void* b) {
+  uint64_t x = sort_profile->pc_count[*(const int*)a], y = sort_profile->pc_count[*(const int*)b];
+  return (x < y) - (x > y);
+}
+
+void chip8_profile_report(const Chip8Profile* p, FILE* out, int top_pcs) {
+  double total_ns = 0;
+  for (int op = 0; op < CHIP8_OP_COUNT; op++) {
+    total_ns += estimated_ns(p, op);
+  }
+  double instructions = p->instructions ? (double)p->instructions : 1.0;
+
+  int ops[CHIP8_OP_COUNT];
+  for (int op = 0; op < CHIP8_OP_COUNT; op++) {
+    ops[op] = op;
+  }
+  sort_profile = p;
+  qsort(ops, CHIP8_OP_COUNT, sizeof(int), compare_ops);
+
+  fprintf(out, "Perfil de chip8_cycle: %llu instruções, ~%.3f ms estimados (1 em %d execuções cronometrada)\n",
+          (unsigned long long)p->instructions, total_ns / 1e6, CHIP8_PROFILE_SAMPLE);
+  fprintf(out, "%-8s %14s %7s %10s %12s %7s\n", "Handler", "Execuções", "%", "ns/exec", "Tempo (ms)", "%tempo");
+  for (int i = 0; i < CHIP8_OP_COUNT && p->op_count[ops[i]]; i++) {
+    int op = ops[i];
+    double ns = estimated_ns(p, op);
+    fprintf(out, "%-8s %14llu %6.2f%% %10.1f %12.3f %6.2f%%\n", op_names[op],
+            (unsigned long long)p->op_count[op], 100.0 * (double)p->op_count[op] / instructions,
+            p->op_timed[op] ? (double)p->op_ns[op] / (double)p->op_timed[op] : 0.0,
+            ns / 1e6, total_ns > 0 ? 100.0 * ns / total_ns : 0.0);
+  }
+  fprintf(out, "inst_DXYN: %llu chamadas, %.3f ms medidos, %.1f ns/chamada\n",
+          (unsigned long long)p->draw_calls, (double)p->draw_ns / 1e6,
+          p->draw_calls ? (double)p->draw_ns / (double)p->draw_calls : 0.0);
+
+  int* pcs = malloc(sizeof(int) * 4096);
+  if (!pcs) {
+    return;
+  }
+  for (int pc = 0; pc < 4096; pc++) {
+    pcs[pc] = pc;
+  }
+  qsort(pcs, 4096, sizeof(int), compare_pcs);
+  fprintf(out, "PCs mais executados:\n");
+  for (int i = 0; i < top_pcs && i < 4096 && p->pc_count[pcs[i]]; i++) {
+    int pc = pcs[i];
+    fprintf(out, "  0x%03X  %04X %-5s %14llu %6.2f%%\n", pc, p->pc_opcode[pc],
+            op_names[chip8_decode(p->pc_opcode[pc]).op], (unsigned long long)p->pc_count[pc],
+            100.0 * (double)p->pc_count[pc] / instructions);
+  }
+  if (p->stacks_dropped) {
+    fprintf(out, "Aviso: %llu execuções fora das pilhas colapsadas (tabela cheia)\n",
+            (unsigned long long)p->stacks_dropped);
+  }
+  free(pcs);
+}
+
+int chip8_profile_write_collapsed(const Chip8Profile* p, const char* path, const char* root) {
+  FILE* out = fopen(path, "w");
+  if (!out) {
+    return -1;
+  }
+  // ';' separa quadros e o último espaço separa a contagem: o nome da raiz não pode ter ';'
+  char name[256];
+  snprintf(name, sizeof(name), "%s", root);
+  for (char* c = name; *c; c++) {
+    if (*c == ';') *c = '_';
+  }
+
+  for (uint32_t i = 0; i < CHIP8_PROFILE_STACKS && p->stacks; i++) {
+    const Chip8ProfileStack* s = &p->stacks[i];
+    if (!s->used) {
+      continue;
+    }
+    fprintf(out, "%s", name);
+    for (int d = 0; d < s->depth; d++) {
+      fprintf(out, ";sub_0x%03X", s->frames[d]);
+    }
+    fprintf(out, ";0x%03X_%s %llu\n", s->pc, op_names[chip8_decode(p->pc_opcode[s->pc]).op],
+            (unsigned long long)s->count);
+  }
+  return fclose(out) == 0 ? 0 : -1;
+}
@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <string.h>
+#include "library.h"
+#include "quirks.h"
+
+#define QUIRKS_VIP   (CHIP8_QUIRK_SHIFT_VY | CHIP8_QUIRK_LOAD_STORE_I | CHIP8_QUIRK_CLIP)
+#define QUIRKS_SCHIP (CHIP8_QUIRK_JUMP_VX | CHIP8_QUIRK_CLIP)
+#define QUIRKS_XOCHIP (CHIP8_QUIRK_SHIFT_VY | CHIP8_QUIRK_LOAD_STORE_I)
+
+const Chip8QuirkProfile chip8_quirk_profiles[] = {
+  {"modern", CHIP8_QUIRKS_MODERN, "interpretadores atuais: desloca VX, I fixo, BNNN com V0, sprites dão a volta"},
+  {"vip", QUIRKS_VIP, "interpretador original do COSMAC VIP (1977): desloca VY, FX55/FX65 avançam I, corta nas bordas"},
+  {"schip", QUIRKS_SCHIP, "SUPER-CHIP 1.1 (HP 48): BNNN com VX, corta nas bordas"},
+  {"xochip", QUIRKS_XOCHIP, "XO-CHIP (Octo): desloca VY, FX55/FX65 avançam I, sprites dão a volta"},
+  {NULL, 0, NULL},
+};
+
+static const struct {
+  const char* name;
+  uint8_t quirk;
+} quirk_names[] = {
+  {"shift_vy", CHIP8_QUIRK_SHIFT_VY},
+  {"load_store_i", CHIP8_QUIRK_LOAD_STORE_I},
+  {"jump_vx", CHIP8_QUIRK_JUMP_VX},
+  {"clip", CHIP8_QUIRK_CLIP},
+};
+
+#define QUIRK_NAMES (int)(sizeof(quirk_names) / sizeof(quirk_names[0]))
+
+// Banco de dados: SHA-1 da ROM -> quirks com que ela foi escrita
+// Programas que não dependem de nenhuma quirk (ou que seguem as modernas) ficam de fora
+static const struct {
+  const char* sha1;
+  uint8_t quirks;
+} known_roms[] = {
+  // Programas do COSMAC VIP (1977-1980), escritos para o interpretador original
+  {"ea9af3c09b0d9e265fcd92bcc5d51a2939fdf27a", QUIRKS_VIP}, // 15 Puzzle [Roger Ivie]
+  {"feaa2b999737630a6402e990df4d0558f79ba43e", QUIRKS_VIP}, // Addition Problems [Paul C. Moews]
+  {"a27dcf88a931f70c3ccf3c01a5410b263bac48bc", QUIRKS_VIP}, // Animal Race [Brian Astle]
+  {"3368d56efeb584c509bafb548f1ee5e71ac1bc70", QUIRKS_VIP}, // Biorhythm [Jef Winsor]
+  {"b3fed4ed1eb0ed693c9731dbe53b29a76236c781", QUIRKS_VIP}, // Bowling [Gooitzen van der Wal]
+  {"193915dcde1365ae054c4eaa21a35baa27cd3356", QUIRKS_VIP}, // Breakout [Carmelo Cortez, 1979]
+  {"614a2b3d0bb5d62a16d963ac2d3a79eb3dd22742", QUIRKS_VIP}, // Coin Flipping [Carmelo Cortez, 1978]
+  {"35158696bd94ea22ef34e899fff1f15f7154d4fd", QUIRKS_VIP}, // Craps [Camerlo Cortez, 1978]
+  {"8e5f19d8ae9f3346779613359610967a5ed95fa8", QUIRKS_VIP}, // Deflection [John Fort]
+  {"dbb52193db4063149c3d8768ab47dd740d90955c", QUIRKS_VIP}, // Hi-Lo [Jef Winsor, 1978]
+  {"fc724ae0125f5f1ac94a79fe3afc6318b1f57556", QUIRKS_VIP}, // Kaleidoscope [Joseph Weisbecker, 1978]
+  {"72e8f3a10a32bd7fb91322ecab87249f95e81e57", QUIRKS_VIP}, // Lunar Lander (Udo Pernisz, 1979)
+  {"669e32b6f42f52da658e428f501aabcdfa37fb2e", QUIRKS_VIP}, // Mastermind FourRow (Robert Lindley, 1978)
+  {"fa7c04f68d78e0faf6d136a3babe3943fc2e02f1", QUIRKS_VIP}, // Most Dangerous Game [Peter Maruhnic]
+  {"4031dae5c7545a1adc160a661be36f19fc1d47b2", QUIRKS_VIP}, // Nim [Carmelo Cortez, 1978]
+  {"726cb39afa7e17725af7fab37d153277d86bff77", QUIRKS_VIP}, // Programmable Spacefighters [Jef Winsor]
+  {"ff639eceaf221ae66151a03779b41fae7118d2d8", QUIRKS_VIP}, // Reversi [Philip Baltzer]
+  {"3d1d029d6e31206d245c0ba881c0d1f003953bad", QUIRKS_VIP}, // Rocket [Joseph Weisbecker, 1978]
+  {"24960090b2afc9de2a4cb3ee7daf6a21456bb49b", QUIRKS_VIP}, // Russian Roulette [Carmelo Cortez, 1978]
+  {"448f9d30d2157ab42679b809d4fb0b43d145f74f", QUIRKS_VIP}, // Sequence Shoot [Joyce Weisbecker]
+  {"443550abf646bc7f475ef0466f8e1232ec7474f3", QUIRKS_VIP}, // Shooting Stars [Philip Baltzer, 1978]
+  {"7623fa0fa915979226566b24107360e7537735f4", QUIRKS_VIP}, // Slide [Joyce Weisbecker]
+  {"ed829190e37815771e7a8c675ba0074996a2ddb0", QUIRKS_VIP}, // Space Intercept [Joseph Weisbecker, 1978]
+  {"1bd92042717c3bc4f7f34cab34be2887145a6704", QUIRKS_VIP}, // Spooky Spot [Joseph Weisbecker, 1978]
+  {"89aadf7c28bcd1c11e71ad9bd6eeaf0e7be474f3", QUIRKS_VIP}, // Submarine [Carmelo Cortez, 1978]
+  {"83a2f9c8153be955c28e788bd803aa1d25131330", QUIRKS_VIP}, // Sum Fun [Joyce Weisbecker]
+  {"d666688a8fce468a7d88b536bc1ef5f35ba12031", QUIRKS_VIP}, // Wipe Off [Joseph Weisbecker]
+  // Port do Blitz do VIP: o prédio da última linha só é atingido se o sprite for cortado
+  {"6f6509f38220e057a7e32ebb22dd353c1078e3e7", CHIP8_QUIRK_CLIP}, // Blitz [David Winter]
+  {NULL, 0},
+};
+
+int chip8_quirks_lookup(const uint8_t sha1[20], uint8_t* quirks) {
+  char hex[41];
+  chip8_sha1_hex(sha1, hex);
+  for (int i = 0; known_roms[i].sha1; i++) {
+    if (memcmp(known_roms[i].sha1, hex, 40) == 0) {
+      *quirks = known_roms[i].quirks;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+uint8_t chip8_quirks_for_rom(const uint8_t* data, size_t size, uint8_t fallback) {
+  uint8_t sha1[20];
+  uint8_t quirks = fallback;
+  chip8_sha1(data, size, sha1);
+  chip8_quirks_lookup(sha1, &quirks);
+  return quirks;
+}
+
+int chip8_quirks_parse(const char* text, uint8_t* quirks) {
+  uint8_t result = 0;
+  while (*text) {
+    size_t len = strcspn(text, ",");
+    int found = 0;
+    for (int i = 0; chip8_quirk_profiles[i].name && !found; i++) {
+      if (strlen(chip8_quirk_profiles[i].name) == len && strncmp(chip8_quirk_profiles[i].name, text, len) == 0) {
+        result |= chip8_quirk_profiles[i].quirks;
+        found = 1;
+      }
+    }
+    for (int i = 0; i < QUIRK_NAMES && !found; i++) {
+      if (strlen(quirk_names[i].name) == len && strncmp(quirk_names[i].name, text, len) == 0) {
+        result |= quirk_names[i].quirk;
+        found = 1;
+      }
+    }
+    if (!found) {
+      return -1;
+    }
+    text += len;
+    if (*text == ',') {
+      text++;
+    }
+  }
+  *quirks = result;
+  return 0;
+}
+
+const char* chip8_quirks_describe(uint8_t quirks, char* out, size_t size) {
+  for (int i = 0; chip8_quirk_profiles[i].name; i++) {
+    if (chip8_quirk_profiles[i].quirks == quirks) {
+      snprintf(out, size, "%s", chip8_quirk_profiles[i].name);
+      return out;
+    }
+  }
+  size_t used = 0;
+  out[0] = '\0';
+  for (int i = 0; i < QUIRK_NAMES; i++) {
+    if ((quirks & quirk_names[i].quirk) && used < size) {
+      used += (size_t)snprintf(out + used, size - used, "%s%s", used ? "," : "", quirk_names[i].name);
+    }
+  }
+  return out;
+}
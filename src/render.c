@@ -0,0 +1,179 @@
+#include <string.h>
+#include <stdlib.h>
+#include "render.h"
+
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(CHIP8_NO_SIMD)
+#define RENDER_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+const Chip8Palette chip8_palettes[] = {
+  {"classico", {0x00, 0x00, 0x00}, {0xFF, 0xFF, 0xFF}},
+  {"invertido", {0xFF, 0xFF, 0xFF}, {0x00, 0x00, 0x00}},
+  {"fosforo", {0x00, 0x14, 0x00}, {0x33, 0xFF, 0x33}},
+  {"ambar", {0x1A, 0x0E, 0x00}, {0xFF, 0xB0, 0x00}},
+  {"lcd", {0x9B, 0xBC, 0x0F}, {0x0F, 0x38, 0x0F}},
+  {NULL, {0, 0, 0}, {0, 0, 0}}
+};
+
+// Lê exatamente 6 dígitos hexadecimais como RGB
+static int parse_rgb(const char *s, uint8_t rgb[3]) {
+  char buf[7];
+  for (int i = 0; i < 6; i++) {
+    char ch = s[i];
+    if (!((ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'f') || (ch >= 'A' && ch <= 'F'))) {
+      return -1;
+    }
+    buf[i] = ch;
+  }
+  buf[6] = '\0';
+  unsigned long v = strtoul(buf, NULL, 16);
+  rgb[0] = (uint8_t)(v >> 16);
+  rgb[1] = (uint8_t)(v >> 8);
+  rgb[2] = (uint8_t)v;
+  return 0;
+}
+
+int chip8_palette_parse(const char *spec, Chip8Palette *out) {
+  for (int i = 0; chip8_palettes[i].name; i++) {
+    if (strcmp(spec, chip8_palettes[i].name) == 0) {
+      *out = chip8_palettes[i];
+      return 0;
+    }
+  }
+
+  // Paleta personalizada: RRGGBB:RRGGBB (um '#' opcional antes de cada cor)
+  const char *a = spec[0] == '#' ? spec + 1 : spec;
+  const char *sep = strchr(a, ':');
+  if (!sep || sep - a != 6) return -1;
+  const char *b = sep[1] == '#' ? sep + 2 : sep + 1;
+  if (strlen(b) != 6) return -1;
+  if (parse_rgb(a, out->off) != 0 || parse_rgb(b, out->on) != 0) return -1;
+  out->name = "personalizada";
+  return 0;
+}
+
+// Caminho escalar: seleciona a cor sem desvio (off ^ (diff & máscara))
+static void expand_scalar(uint32_t *dst, uint64_t bits, uint32_t off, uint32_t on) {
+  uint32_t diff = off ^ on;
+  for (int x = 0; x < CHIP8_WIDTH; x++) {
+    // O bit 63 é a coluna 0
+    dst[x] = off ^ (diff & (0u - (uint32_t)((bits >> (63 - x)) & 1)));
+  }
+}
+
+#ifdef RENDER_X86_SIMD
+// SSE2: 4 pixels por iteração. O nibble é replicado nas 4 lanes e cada lane
+// testa o seu bit; cmpeq gera a máscara usada para escolher a cor
+static void expand_sse2(uint32_t *dst, uint64_t bits, uint32_t off, uint32_t on) {
+  const __m128i sel = _mm_set_epi32(1, 2, 4, 8); // lane 0 = bit mais significativo
+  const __m128i voff = _mm_set1_epi32((int)off);
+  const __m128i vdiff = _mm_set1_epi32((int)(off ^ on));
+  for (int g = 0; g < CHIP8_WIDTH / 4; g++) {
+    __m128i v = _mm_set1_epi32((int)((bits >> (60 - 4 * g)) & 0xF));
+    __m128i m = _mm_cmpeq_epi32(_mm_and_si128(v, sel), sel);
+    _mm_storeu_si128((__m128i *)(dst + 4 * g), _mm_xor_si128(voff, _mm_and_si128(vdiff, m)));
+  }
+}
+
+// AVX2: 8 pixels (um byte do display) por iteração
+__attribute__((target("avx2")))
+static void expand_avx2(uint32_t *dst, uint64_t bits, uint32_t off, uint32_t on) {
+  const __m256i sel = _mm256_set_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+  const __m256i voff = _mm256_set1_epi32((int)off);
+  const __m256i vdiff = _mm256_set1_epi32((int)(off ^ on));
+  for (int g = 0; g < CHIP8_WIDTH / 8; g++) {
+    __m256i v = _mm256_set1_epi32((int)((bits >> (56 - 8 * g)) & 0xFF));
+    __m256i m = _mm256_cmpeq_epi32(_mm256_and_si256(v, sel), sel);
+    _mm256_storeu_si256((__m256i *)(dst + 8 * g), _mm256_xor_si256(voff, _mm256_and_si256(vdiff, m)));
+  }
+}
+#endif
+
+void chip8_render_init(Chip8Render *r, uint32_t off, uint32_t on, int scale) {
+  r->off = off;
+  r->on = on;
+  r->scale = scale < 1 ? 1 : (scale > CHIP8_RENDER_MAX_SCALE ? CHIP8_RENDER_MAX_SCALE : scale);
+  r->expand = expand_scalar;
+  r->backend = "escalar";
+  r->planes[0] = off;
+  r->planes[1] = on;
+  r->planes[2] = on;
+  r->planes[3] = on;
+#ifdef RENDER_X86_SIMD
+  // SSE2 faz parte da base do x86-64; AVX2 depende da CPU
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    r->expand = expand_avx2;
+    r->backend = "avx2";
+  } else {
+    r->expand = expand_sse2;
+    r->backend = "sse2";
+  }
+#endif
+}
+
+void chip8_render_rows(const Chip8Render *r, const uint64_t *display, int first, int count,
+                       void *dst, int pitch) {
+  uint8_t *out = (uint8_t *)dst;
+  int s = r->scale;
+
+  if (s == 1) {
+    // Sem escala: expande direto para a textura
+    for (int y = 0; y < count; y++) {
+      r->expand((uint32_t *)(out + y * pitch), display[first + y], r->off, r->on);
+    }
+    return;
+  }
+
+  // Pré-escala inteira: expande para um buffer temporário, replica cada pixel
+  // s vezes na primeira linha de destino e copia essa linha s - 1 vezes
+  uint32_t line[CHIP8_WIDTH];
+  size_t line_bytes = (size_t)CHIP8_WIDTH * (size_t)s * sizeof(uint32_t);
+  for (int y = 0; y < count; y++) {
+    uint8_t *base = out + (size_t)y * (size_t)s * (size_t)pitch;
+    uint32_t *row = (uint32_t *)base;
+    r->expand(line, display[first + y], r->off, r->on);
+    for (int x = 0; x < CHIP8_WIDTH; x++) {
+      uint32_t px = line[x];
+      for (int k = 0; k < s; k++) {
+        *row++ = px;
+      }
+    }
+    for (int k = 1; k < s; k++) {
+      memcpy(base + (size_t)k * (size_t)pitch, base, line_bytes);
+    }
+  }
+}
+
+void chip8_render_set_planes(Chip8Render *r, uint32_t second, uint32_t both) {
+  r->planes[2] = second;
+  r->planes[3] = both;
+}
+
+void chip8_render_screen(const Chip8Render *r, const uint64_t screen[CHIP8_PLANES][CHIP8_HIRES_HEIGHT][2],
+                         int hires, int first, int count, void *dst, int pitch) {
+  uint8_t *out = (uint8_t *)dst;
+  int s = r->scale;
+  size_t line_bytes = (size_t)CHIP8_HIRES_WIDTH * (size_t)s * sizeof(uint32_t);
+
+  for (int y = 0; y < count; y++) {
+    // Em lores, a linha y da saída vem da linha y / 2 e cada coluna x da coluna x / 2
+    int sy = hires ? first + y : (first + y) >> 1;
+    uint8_t *base = out + (size_t)y * (size_t)s * (size_t)pitch;
+    uint32_t *row = (uint32_t *)base;
+    for (int x = 0; x < CHIP8_HIRES_WIDTH; x++) {
+      int sx = hires ? x : x >> 1;
+      unsigned bit = 63 - (sx & 63);
+      unsigned planes = (unsigned)((screen[0][sy][sx >> 6] >> bit) & 1) |
+                        (unsigned)(((screen[1][sy][sx >> 6] >> bit) & 1) << 1);
+      uint32_t px = r->planes[planes];
+      for (int k = 0; k < s; k++) {
+        *row++ = px;
+      }
+    }
+    for (int k = 1; k < s; k++) {
+      memcpy(base + (size_t)k * (size_t)pitch, base, line_bytes);
+    }
+  }
+}
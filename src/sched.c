@@ -0,0 +1,129 @@
+#include <stddef.h>
+#include "sched.h"
+
+void chip8_sched_init(Chip8Sched* s, uint32_t clock_hz, int vip_costs) {
+  s->clock_hz = clock_hz;
+  s->vip_costs = vip_costs;
+  s->units = 0;
+  s->target = 0;
+  s->ticks = 0;
+  s->instructions = 0;
+  s->quantum = UINT32_MAX;
+  s->audio = NULL;
+  s->audio_base = 0;
+}
+
+void chip8_sched_attach_audio(Chip8Sched* s, Chip8AudioRing* ring, uint32_t sample_rate) {
+  s->audio = ring;
+  s->quantum = s->clock_hz / sample_rate > 1 ? s->clock_hz / sample_rate : 1;
+}
+
+void chip8_sched_sync_audio(const Chip8Sched* s, const Chip8* chip8) {
+  if (s->audio) {
+    chip8_audio_update(s->audio, s->audio_base + s->units, chip8->sound_timer > 0);
+  }
+}
+
+uint64_t chip8_sched_until_tick(const Chip8Sched* s) {
+  // O tick k acontece na primeira unidade u com u * 60 >= k * clock_hz
+  uint64_t next = ((s->ticks + 1) * s->clock_hz + CHIP8_TIMER_HZ - 1) / CHIP8_TIMER_HZ;
+  return next - s->units;
+}
+
+void chip8_sched_advance(Chip8Sched* s, Chip8* chip8, uint64_t units) {
+  s->units += units;
+  uint64_t ticks = s->units * CHIP8_TIMER_HZ / s->clock_hz;
+  // Com os dois temporizadores zerados os ticks restantes não mudam nada
+  while (s->ticks < ticks && (chip8->delay_timer || chip8->sound_timer)) {
+    chip8_tick_timers(chip8);
+    s->ticks++;
+    if (s->audio) {
+      // O som desliga exatamente no tick
+      uint64_t at = (s->ticks * s->clock_hz + CHIP8_TIMER_HZ - 1) / CHIP8_TIMER_HZ;
+      chip8_audio_update(s->audio, s->audio_base + at, chip8->sound_timer > 0);
+    }
+  }
+  s->ticks = ticks;
+}
+
+void chip8_sched_step(Chip8Sched* s, Chip8* chip8, uint64_t n) {
+  s->instructions += n;
+  if (s->audio) {
+    // Um FX18 dentro do bloco conta como executado no fim dele (no máximo uma amostra depois)
+    chip8_audio_update(s->audio, s->audio_base + s->units + n, chip8->sound_timer > 0);
+  }
+  chip8_sched_advance(s, chip8, n);
+}
+
+void chip8_sched_seek(Chip8Sched* s, uint64_t ticks) {
+  s->audio_base += s->units; // O tempo do áudio não volta junto
+  s->ticks = ticks;
+  s->units = (ticks * s->clock_hz + CHIP8_TIMER_HZ - 1) / CHIP8_TIMER_HZ;
+  s->target = s->units;
+  s->audio_base -= s->units;
+}
+
+// Custos aproximados do interpretador CHIP-8 original do COSMAC VIP, em µs
+// (1,76 MHz, 8 ciclos de clock por ciclo de máquina, DMA de vídeo incluído)
+uint32_t chip8_vip_cost(uint16_t opcode) {
+  switch (opcode & 0xF000) {
+    case 0x0000: return opcode == 0x00E0 ? 109 : 105;
+    case 0x1000: return 105;
+    case 0x2000: return 105;
+    case 0x3000: return 55;
+    case 0x4000: return 55;
+    case 0x5000: return 73;
+    case 0x6000: return 27;
+    case 0x7000: return 45;
+    case 0x8000: return 200;
+    case 0x9000: return 73;
+    case 0xA000: return 55;
+    case 0xB000: return 105;
+    case 0xC000: return 164;
+    case 0xD000: return 340 + 238 * (opcode & 0x000F); // Fora a espera pelo vblank (ver chip8_sched_run)
+    case 0xE000: return 73;
+    default:
+      switch (opcode & 0x00FF) {
+        case 0x1E: return 86;
+        case 0x29: return 91;
+        case 0x33: return 927;
+        case 0x55:
+        case 0x65: return 605;
+        default:   return 45; // FX07, FX0A, FX15, FX18
+      }
+  }
+}
+
+void chip8_sched_run(Chip8Sched* s, Chip8* chip8, uint64_t units) {
+  // O alvo acumula: o que uma instrução longa ultrapassou é descontado na chamada seguinte
+  if (s->target < s->units) {
+    s->target = s->units;
+  }
+  s->target += units;
+
+  while (s->units < s->target) {
+    if (!s->vip_costs) {
+      // Modelo uniforme: blocos de chip8_run que terminam exatamente em cada tick
+      uint64_t n = chip8_sched_until_tick(s);
+      if (n > s->target - s->units) {
+        n = s->target - s->units;
+      }
+      if (n > s->quantum) {
+        n = s->quantum;
+      }
+      chip8_run(chip8, (uint32_t)n);
+      chip8_sched_step(s, chip8, n);
+    } else {
+      uint16_t pc = chip8->pc;
+      uint16_t opcode = (uint16_t)((chip8->memory[pc & 0x0FFF] << 8) | chip8->memory[(pc + 1) & 0x0FFF]);
+      if ((opcode & 0xF000) == 0xD000) {
+        // O interpretador do VIP só desenha depois da interrupção de vídeo (60 Hz)
+        chip8_sched_advance(s, chip8, chip8_sched_until_tick(s));
+      }
+      chip8_run(chip8, 1);
+      s->instructions++;
+      chip8_sched_sync_audio(s, chip8);
+      chip8_sched_advance(s, chip8, chip8_vip_cost(opcode));
+    }
+  }
+}
@@ -0,0 +1,556 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "machine.h"
+#include "state.h"
+
+// Cabeçalho do arquivo: "C8ST", versão (u16), tamanho do cabeçalho (u16),
+// tamanho da imagem (u32) e FNV-1a de 32 bits da imagem (u32)
+#define STATE_MAGIC "C8ST"
+#define STATE_HEADER_SIZE 16
+
+// Pior caso do RLE: tudo literal, um byte de tag a cada 128 bytes
+#define RLE_MAX_SIZE (CHIP8_STATE_SIZE + CHIP8_STATE_SIZE / 128 + 16)
+
+static inline void put16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put32(uint8_t *p, uint32_t v) {
+  for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static inline void put64(uint8_t *p, uint64_t v) {
+  for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static inline uint16_t get16(const uint8_t *p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t get32(const uint8_t *p) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; i++) v |= (uint32_t)p[i] << (8 * i);
+  return v;
+}
+
+static inline uint64_t get64(const uint8_t *p) {
+  uint64_t v = 0;
+  for (int i = 0; i < 8; i++) v |= (uint64_t)p[i] << (8 * i);
+  return v;
+}
+
+static uint32_t fnv1a32(const uint8_t *p, size_t len) {
+  uint32_t hash = 0x811c9dc5u;
+  for (size_t i = 0; i < len; i++) {
+    hash ^= p[i];
+    hash *= 0x01000193u;
+  }
+  return hash;
+}
+
+// Layout da imagem (versão 1): memória, V, I, PC, pilha, SP, temporizadores,
+// teclado, acessos fora da memória e display. A memória vem primeiro para que
+// os deltas do rewind fiquem alinhados com os endereços. A versão 2 acrescenta
+// as quirks e as máquinas estendidas: modelo, resolução, planos, pitch, flags,
+// padrão de áudio, o restante dos 64 KB e o framebuffer planar. A versão 3 é a
+// 2 sem os blocos que o modelo não tem (no XO-CHIP, as duas são iguais)
+size_t chip8_state_size(Chip8Machine machine) {
+  size_t size = CHIP8_STATE_CHIP8_SIZE;
+  if (machine == CHIP8_MACHINE_XOCHIP) {
+    size += CHIP8_MEMORY_SIZE - 4096;
+  }
+  if (machine == CHIP8_MACHINE_SCHIP || machine == CHIP8_MACHINE_XOCHIP) {
+    size += CHIP8_PLANES * CHIP8_HIRES_HEIGHT * 2 * 8;
+  }
+  return size;
+}
+
+size_t chip8_state_pack(const Chip8 *c, uint8_t out[CHIP8_STATE_SIZE]) {
+  uint8_t *p = out;
+  memcpy(p, c->memory, 4096); p += 4096;
+  memcpy(p, c->V, 16); p += 16;
+  put16(p, c->I); p += 2;
+  put16(p, c->pc); p += 2;
+  for (int i = 0; i < 16; i++, p += 2) put16(p, c->stack[i]);
+  *p++ = c->sp;
+  *p++ = c->delay_timer;
+  *p++ = c->sound_timer;
+  memcpy(p, c->keypad, 16); p += 16;
+  put32(p, c->oob_accesses); p += 4;
+  for (int y = 0; y < CHIP8_HEIGHT; y++, p += 8) put64(p, c->display[y]);
+
+  *p++ = c->quirks;
+  *p++ = c->machine;
+  *p++ = c->hires;
+  *p++ = c->planes;
+  *p++ = c->pitch;
+  memcpy(p, c->flags, 16); p += 16;
+  memcpy(p, c->audio_pattern, 16); p += 16;
+  if (c->machine == CHIP8_MACHINE_XOCHIP) {
+    memcpy(p, c->ext->memory, CHIP8_MEMORY_SIZE - 4096); p += CHIP8_MEMORY_SIZE - 4096;
+  }
+  if (c->machine != CHIP8_MACHINE_CHIP8) {
+    for (int plane = 0; plane < CHIP8_PLANES; plane++) {
+      for (int y = 0; y < CHIP8_HIRES_HEIGHT; y++, p += 16) {
+        put64(p, c->ext->screen[plane][y][0]);
+        put64(p + 8, c->ext->screen[plane][y][1]);
+      }
+    }
+  }
+  return (size_t)(p - out);
+}
+
+// Modelo gravado na imagem (a versão 1 é sempre CHIP-8); -1 se o byte não é um Chip8Machine
+static int image_machine(const uint8_t *in, size_t size, int version) {
+  if (version < 2 || size <= CHIP8_STATE_V1_SIZE + 1) {
+    return CHIP8_MACHINE_CHIP8; // Sem o byte: o tamanho não confere e unpack recusa
+  }
+  return in[CHIP8_STATE_V1_SIZE + 1] < CHIP8_MACHINE_COUNT ? in[CHIP8_STATE_V1_SIZE + 1] : -1;
+}
+
+static int unpack(Chip8 *c, const uint8_t *in, size_t size, int version) {
+  int model = image_machine(in, size, version);
+  if (model < 0) {
+    return -2;
+  }
+  Chip8Machine machine = (Chip8Machine)model;
+  size_t expected = version == 1 ? CHIP8_STATE_V1_SIZE : version == 2 ? CHIP8_STATE_SIZE : chip8_state_size(machine);
+  if (size != expected) {
+    return -2;
+  }
+  if (chip8_machine_ext(c, machine) != 0) {
+    return -7;
+  }
+  const uint8_t *p = in;
+
+  // Invalida só as instruções pré-decodificadas cujos bytes mudaram
+  for (uint16_t a = 0; a < 4096; a++) {
+    if (c->memory[a] != p[a]) {
+      c->memory[a] = p[a];
+      chip8_invalidate(c, a, 1);
+    }
+  }
+  p += 4096;
+  memcpy(c->V, p, 16); p += 16;
+  c->I = get16(p); p += 2;
+  c->pc = get16(p); p += 2;
+  for (int i = 0; i < 16; i++, p += 2) c->stack[i] = get16(p);
+  c->sp = *p++;
+  c->delay_timer = *p++;
+  c->sound_timer = *p++;
+  memcpy(c->keypad, p, 16); p += 16;
+  c->oob_accesses = get32(p); p += 4;
+  for (int y = 0; y < CHIP8_HEIGHT; y++, p += 8) c->display[y] = get64(p);
+
+  c->machine = (uint8_t)machine;
+  if (version >= 2) {
+    c->quirks = p[0] & (CHIP8_QUIRK_COUNT - 1);
+    c->hires = p[2] & 1;
+    c->planes = p[3] & 3;
+    c->pitch = p[4];
+    p += 5;
+    memcpy(c->flags, p, 16); p += 16;
+    memcpy(c->audio_pattern, p, 16); p += 16;
+    // A versão 2 tem os dois blocos em qualquer modelo; o que o modelo não usa é pulado
+    if (machine == CHIP8_MACHINE_XOCHIP) {
+      memcpy(c->ext->memory, p, CHIP8_MEMORY_SIZE - 4096);
+    }
+    if (machine == CHIP8_MACHINE_XOCHIP || version == 2) {
+      p += CHIP8_MEMORY_SIZE - 4096;
+    }
+    if (machine != CHIP8_MACHINE_CHIP8) {
+      for (int plane = 0; plane < CHIP8_PLANES; plane++) {
+        for (int y = 0; y < CHIP8_HIRES_HEIGHT; y++, p += 16) {
+          c->ext->screen[plane][y][0] = get64(p);
+          c->ext->screen[plane][y][1] = get64(p + 8);
+        }
+      }
+    }
+  } else {
+    // A versão 1 não tem as quirks: ficam as de c (as do banco de ROMs, via chip8_load_rom)
+    c->hires = 0;
+    c->planes = 0;
+    c->pitch = 0;
+    memset(c->flags, 0, sizeof(c->flags));
+    memset(c->audio_pattern, 0, sizeof(c->audio_pattern));
+  }
+
+  // O display inteiro precisa ser redesenhado
+  c->dirty_rows = 0xFFFFFFFFu;
+  c->display_gen++;
+  return 0;
+}
+
+int chip8_state_unpack(Chip8 *c, const uint8_t *in, size_t size) {
+  return unpack(c, in, size, CHIP8_STATE_VERSION);
+}
+
+int chip8_save_state(const Chip8 *c, const char *path) {
+  uint8_t header[STATE_HEADER_SIZE];
+  uint8_t body[CHIP8_STATE_SIZE];
+
+  size_t size = chip8_state_pack(c, body);
+  memcpy(header, STATE_MAGIC, 4);
+  put16(header + 4, CHIP8_STATE_VERSION);
+  put16(header + 6, STATE_HEADER_SIZE);
+  put32(header + 8, (uint32_t)size);
+  put32(header + 12, fnv1a32(body, size));
+
+  FILE *file = fopen(path, "wb");
+  if (!file) {
+    return -1;
+  }
+  size_t written = fwrite(header, 1, sizeof(header), file);
+  written += fwrite(body, 1, size, file);
+  if (fclose(file) != 0 || written != sizeof(header) + size) {
+    return -6;
+  }
+  return 0;
+}
+
+int chip8_load_state(Chip8 *c, const char *path) {
+  uint8_t header[STATE_HEADER_SIZE];
+  uint8_t body[CHIP8_STATE_SIZE];
+
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    return -1;
+  }
+  if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+      memcmp(header, STATE_MAGIC, 4) != 0) {
+    fclose(file);
+    return -2;
+  }
+  uint16_t version = get16(header + 4);
+  if (version < 1 || version > CHIP8_STATE_VERSION) {
+    fclose(file);
+    return -3;
+  }
+  // Na versão 3 o tamanho depende do modelo, conferido por unpack
+  size_t size = get32(header + 8);
+  if (get16(header + 6) != STATE_HEADER_SIZE || size > CHIP8_STATE_SIZE) {
+    fclose(file);
+    return -2;
+  }
+  size_t read = fread(body, 1, size, file);
+  fclose(file);
+  if (read != size) {
+    return -4;
+  }
+  if (fnv1a32(body, size) != get32(header + 12)) {
+    return -5;
+  }
+  // A sessão fixou a resolução e a apresentação pelo modelo: o arquivo não pode trocá-lo
+  int machine = image_machine(body, size, version);
+  if (machine >= 0 && machine != c->machine) {
+    return -8;
+  }
+
+  return unpack(c, body, size, version);
+}
+
+const char *chip8_state_error(int code) {
+  switch (code) {
+    case 0:  return "Sucesso";
+    case -1: return "Não foi possível abrir o arquivo";
+    case -2: return "Arquivo não é um save state válido";
+    case -3: return "Versão de save state não suportada";
+    case -4: return "Save state truncado";
+    case -5: return "Save state corrompido (checksum inválido)";
+    case -6: return "Falha ao gravar o arquivo";
+    case -7: return "Sem memória para o modelo do save state";
+    case -8: return "O save state é de outro modelo (--machine)";
+    default: return "Erro desconhecido no save state";
+  }
+}
+
+// RLE orientado a zeros (o XOR entre frames consecutivos é quase todo zero):
+//   0x00-0x7F: tag + 1 bytes literais em seguida
+//   0x80-0xFE: tag - 0x7F bytes zero
+//   0xFF:      sequência longa de zeros, tamanho nos 2 bytes seguintes (LE)
+static size_t rle_encode(const uint8_t *in, size_t len, uint8_t *out) {
+  size_t i = 0, o = 0;
+  while (i < len) {
+    if (in[i] == 0) {
+      size_t run = 0;
+      while (i + run < len && in[i + run] == 0 && run < 0xFFFF) run++;
+      if (run < 128) {
+        out[o++] = (uint8_t)(0x7F + run);
+      } else {
+        out[o++] = 0xFF;
+        put16(out + o, (uint16_t)run);
+        o += 2;
+      }
+      i += run;
+    } else {
+      // Literal até 128 bytes; um zero isolado fica no literal (mais barato que uma tag)
+      size_t start = i, n = 0;
+      while (i < len && n < 128 && !(in[i] == 0 && (i + 1 >= len || in[i + 1] == 0))) {
+        i++;
+        n++;
+      }
+      out[o++] = (uint8_t)(n - 1);
+      memcpy(out + o, in + start, n);
+      o += n;
+    }
+  }
+  return o;
+}
+
+// Aplica (XOR) os dados codificados sobre dst
+static void rle_xor(uint8_t *dst, const uint8_t *in, size_t in_len) {
+  size_t i = 0, o = 0;
+  while (i < in_len) {
+    uint8_t tag = in[i++];
+    if (tag < 0x80) {
+      size_t n = (size_t)tag + 1;
+      for (size_t k = 0; k < n; k++) dst[o + k] ^= in[i + k];
+      i += n;
+      o += n;
+    } else if (tag < 0xFF) {
+      o += (size_t)tag - 0x7F;
+    } else {
+      o += get16(in + i);
+      i += 2;
+    }
+  }
+}
+
+typedef struct {
+    uint32_t offset;            // posição dos dados na arena
+    uint32_t size;
+    uint32_t frame;
+    uint8_t  key;               // 1 = keyframe (imagem completa), 0 = XOR com o frame anterior
+} RewindRecord;
+
+struct Chip8Rewind {
+    uint8_t *arena;
+    size_t arena_size;
+    RewindRecord *records;      // anel de descritores, do mais antigo ao mais novo
+    uint32_t capacity;
+    uint32_t first;
+    uint32_t count;
+    size_t used;
+    uint32_t deltas;            // registros de delta no anel = frames que dá para voltar
+    uint32_t keyframe_interval;
+    uint32_t since_key;         // frames desde o último keyframe
+    uint32_t frame;             // número do frame mais novo
+    int have_current;
+    size_t size;                // bytes das imagens do histórico (chip8_state_size do modelo)
+    uint8_t current[CHIP8_STATE_SIZE]; // imagem do frame mais novo
+    uint8_t work[CHIP8_STATE_SIZE];
+    uint8_t encoded[RLE_MAX_SIZE];
+};
+
+static inline RewindRecord *record_at(Chip8Rewind *r, uint32_t i) {
+  return &r->records[(r->first + i) % r->capacity];
+}
+
+static void evict_oldest(Chip8Rewind *r) {
+  RewindRecord *old = record_at(r, 0);
+  r->used -= old->size;
+  if (!old->key) {
+    r->deltas--;
+  }
+  r->first = (r->first + 1) % r->capacity;
+  r->count--;
+}
+
+static void drop_newest(Chip8Rewind *r) {
+  RewindRecord *rec = record_at(r, r->count - 1);
+  r->used -= rec->size;
+  if (!rec->key) {
+    r->deltas--;
+  }
+  r->count--;
+}
+
+// Copia r->encoded para a arena, descartando os registros mais antigos que estiverem no caminho
+// (-1 sem gravar nada se o registro é maior que a arena inteira)
+static int store(Chip8Rewind *r, size_t size, int key, uint32_t frame) {
+  if (size > r->arena_size) {
+    return -1;
+  }
+
+  // Descarta os mais antigos até haver espaço contíguo para o registro
+  size_t pos = 0;
+  while (r->count > 0) {
+    if (r->count < r->capacity) {
+      RewindRecord *oldest = record_at(r, 0);
+      RewindRecord *newest = record_at(r, r->count - 1);
+      size_t end = (size_t)newest->offset + newest->size;
+      if (oldest->offset <= newest->offset) {
+        // Dados contíguos [oldest, end): livre no fim da arena e antes do mais antigo
+        if (end + size <= r->arena_size) {
+          pos = end;
+          break;
+        }
+        if (size <= oldest->offset) {
+          pos = 0;
+          break;
+        }
+      } else if (end + size <= oldest->offset) {
+        // Dados já deram a volta: livre apenas entre o mais novo e o mais antigo
+        pos = end;
+        break;
+      }
+    }
+    evict_oldest(r);
+  }
+
+  memcpy(r->arena + pos, r->encoded, size);
+  RewindRecord *rec = &r->records[(r->first + r->count) % r->capacity];
+  rec->offset = (uint32_t)pos;
+  rec->size = (uint32_t)size;
+  rec->frame = frame;
+  rec->key = (uint8_t)key;
+  r->count++;
+  r->used += size;
+  if (!key) {
+    r->deltas++;
+  }
+  return 0;
+}
+
+Chip8Rewind *chip8_rewind_create(size_t arena_bytes, uint32_t keyframe_interval) {
+  Chip8Rewind *r = calloc(1, sizeof(*r));
+  if (!r) {
+    return NULL;
+  }
+  r->arena_size = arena_bytes;
+  r->arena = malloc(arena_bytes);
+  // Um frame sem mudanças ocupa 3 bytes: limita os descritores a uma fração da arena
+  r->capacity = (uint32_t)(arena_bytes / 16 + 16);
+  r->records = malloc(sizeof(RewindRecord) * r->capacity);
+  if (!r->arena || !r->records) {
+    chip8_rewind_destroy(r);
+    return NULL;
+  }
+  r->keyframe_interval = keyframe_interval > 0 ? keyframe_interval : 1;
+  return r;
+}
+
+void chip8_rewind_destroy(Chip8Rewind *r) {
+  if (!r) {
+    return;
+  }
+  free(r->arena);
+  free(r->records);
+  free(r);
+}
+
+void chip8_rewind_clear(Chip8Rewind *r) {
+  r->first = 0;
+  r->count = 0;
+  r->used = 0;
+  r->deltas = 0;
+  r->since_key = 0;
+  r->frame = 0;
+  r->have_current = 0;
+}
+
+int chip8_rewind_push(Chip8Rewind *r, const Chip8 *c) {
+  size_t size = chip8_state_pack(c, r->work);
+
+  // Outro modelo (imagem de outro tamanho) também recomeça o histórico
+  if (!r->have_current || size != r->size) {
+    chip8_rewind_clear(r);
+    r->size = size;
+    if (store(r, rle_encode(r->work, size, r->encoded), 1, 0) != 0) {
+      return -1; // Nem o keyframe cabe: o próximo push tenta de novo do zero
+    }
+    memcpy(r->current, r->work, size);
+    r->have_current = 1;
+    return 0;
+  }
+
+  // Delta: XOR com o frame anterior (em work), e work vira o novo frame atual
+  for (size_t i = 0; i < size; i++) {
+    uint8_t next = r->work[i];
+    r->work[i] ^= r->current[i];
+    r->current[i] = next;
+  }
+  r->frame++;
+  if (store(r, rle_encode(r->work, size, r->encoded), 0, r->frame) != 0) {
+    // Sem o delta, nenhum registro anterior leva a este frame: o histórico recomeça
+    // nele, com um keyframe
+    r->have_current = 0;
+    return chip8_rewind_push(r, c);
+  }
+
+  if (++r->since_key >= r->keyframe_interval &&
+      store(r, rle_encode(r->current, size, r->encoded), 1, r->frame) == 0) {
+    r->since_key = 0; // Se o keyframe não coube, o próximo push tenta de novo
+  }
+  return 0;
+}
+
+int chip8_rewind_step_back(Chip8Rewind *r, Chip8 *c, uint32_t frames) {
+  if (frames == 0 || frames > r->deltas) {
+    return -1;
+  }
+  uint32_t target = r->frame - frames;
+
+  // Keyframe mais recente com frame <= target (se houver) e distância até o alvo
+  int32_t key_index = -1;
+  for (int32_t i = (int32_t)r->count - 1; i >= 0; i--) {
+    RewindRecord *rec = record_at(r, (uint32_t)i);
+    if (rec->key && rec->frame <= target) {
+      key_index = i;
+      break;
+    }
+  }
+
+  if (key_index >= 0 && target - record_at(r, (uint32_t)key_index)->frame < frames) {
+    // Mais perto a partir do keyframe: reconstrói para frente
+    RewindRecord *key = record_at(r, (uint32_t)key_index);
+    memset(r->current, 0, r->size);
+    rle_xor(r->current, r->arena + key->offset, key->size);
+    for (uint32_t i = (uint32_t)key_index + 1; i < r->count; i++) {
+      RewindRecord *rec = record_at(r, i);
+      if (rec->frame > target) {
+        break;
+      }
+      if (!rec->key) {
+        rle_xor(r->current, r->arena + rec->offset, rec->size);
+      }
+    }
+  } else {
+    // Desfaz os deltas a partir do frame mais novo (XOR é a própria inversa)
+    for (int32_t i = (int32_t)r->count - 1; i >= 0; i--) {
+      RewindRecord *rec = record_at(r, (uint32_t)i);
+      if (rec->frame <= target) {
+        break;
+      }
+      if (!rec->key) {
+        rle_xor(r->current, r->arena + rec->offset, rec->size);
+      }
+    }
+  }
+
+  // O futuro descartado deixa de existir; o delta e o keyframe do alvo ficam
+  while (r->count > 0 && record_at(r, r->count - 1)->frame > target) {
+    drop_newest(r);
+  }
+  r->frame = target;
+  r->since_key = r->keyframe_interval; // Próximo push grava keyframe se não houver um recente
+  for (int32_t i = (int32_t)r->count - 1; i >= 0; i--) {
+    RewindRecord *rec = record_at(r, (uint32_t)i);
+    if (rec->key) {
+      r->since_key = target - rec->frame;
+      break;
+    }
+  }
+
+  return chip8_state_unpack(c, r->current, r->size) == 0 ? 0 : -1;
+}
+
+uint32_t chip8_rewind_frames(const Chip8Rewind *r) {
+  return r->deltas;
+}
+
+size_t chip8_rewind_used(const Chip8Rewind *r) {
+  return r->used;
+}
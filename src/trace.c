@@ -0,0 +1,305 @@
+#define _POSIX_C_SOURCE 200809L // pthread / nanosleep
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "trace.h"
+
+static const uint8_t trace_magic[8] = {'C', '8', 'T', 'R', 'A', 'C', 'E', 0};
+
+#define FLUSH_BATCH 4096    // Registros convertidos por fwrite
+#define FLUSH_IDLE_NS 1000000 // Espera da thread de gravação com o ring vazio (1 ms)
+
+static inline void put16(uint8_t* p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put32(uint8_t* p, uint32_t v) {
+  put16(p, (uint16_t)v);
+  put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static inline uint16_t get16(const uint8_t* p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t get32(const uint8_t* p) {
+  return get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+#ifdef CHIP8_TRACE
+
+_Thread_local Chip8Trace* chip8_trace_active = NULL;
+
+// Grava os registros [tail, head) no arquivo e libera o espaço no ring
+static size_t flush_ring(Chip8Trace* t) {
+  static _Thread_local uint8_t buffer[FLUSH_BATCH * CHIP8_TRACE_RECORD_SIZE];
+  size_t tail = atomic_load_explicit(&t->tail, memory_order_relaxed);
+  // acquire: pareia com o release da emulação, os registros até head estão completos
+  size_t head = atomic_load_explicit(&t->head, memory_order_acquire);
+  size_t done = 0;
+  while (tail != head) {
+    size_t n = head - tail < FLUSH_BATCH ? head - tail : FLUSH_BATCH;
+    for (size_t k = 0; k < n; k++) {
+      const Chip8TraceRecord* r = &t->ring[(tail + k) & (CHIP8_TRACE_RING - 1)];
+      uint8_t* p = buffer + k * CHIP8_TRACE_RECORD_SIZE;
+      put16(p, r->pc);
+      put16(p + 2, r->opcode);
+      put16(p + 4, r->i);
+      p[6] = r->reg;
+      p[7] = r->value;
+      put32(p + 8, r->delta);
+    }
+    tail += n;
+    done += n;
+    // release: a emulação só reutiliza as posições depois de convertidas
+    atomic_store_explicit(&t->tail, tail, memory_order_release);
+    if (!t->write_error && fwrite(buffer, CHIP8_TRACE_RECORD_SIZE, n, t->file) != n) {
+      t->write_error = 1;
+    }
+  }
+  return done;
+}
+
+static void* flush_main(void* arg) {
+  Chip8Trace* t = arg;
+  while (!atomic_load_explicit(&t->stop, memory_order_acquire)) {
+    if (flush_ring(t) == 0) {
+      struct timespec idle = {0, FLUSH_IDLE_NS};
+      nanosleep(&idle, NULL);
+    }
+  }
+  flush_ring(t);
+  return NULL;
+}
+
+Chip8Trace* chip8_trace_open(const char* path) {
+  Chip8Trace* t = calloc(1, sizeof(Chip8Trace));
+  pthread_t* thread = malloc(sizeof(pthread_t));
+  if (!t || !thread) {
+    free(t);
+    free(thread);
+    return NULL;
+  }
+  t->ring = malloc(sizeof(Chip8TraceRecord) * CHIP8_TRACE_RING);
+  t->file = t->ring ? fopen(path, "wb") : NULL;
+  uint8_t header[16] = {0};
+  memcpy(header, trace_magic, sizeof(trace_magic));
+  put16(header + 8, CHIP8_TRACE_VERSION);
+  put16(header + 10, CHIP8_TRACE_RECORD_SIZE);
+  if (!t->file || fwrite(header, 1, sizeof(header), t->file) != sizeof(header)) {
+    if (t->file) {
+      fclose(t->file);
+    }
+    free(t->ring);
+    free(t);
+    free(thread);
+    return NULL;
+  }
+  atomic_init(&t->head, 0);
+  atomic_init(&t->tail, 0);
+  atomic_init(&t->stop, 0);
+  if (pthread_create(thread, NULL, flush_main, t) != 0) {
+    fclose(t->file);
+    free(t->ring);
+    free(t);
+    free(thread);
+    return NULL;
+  }
+  t->thread = thread;
+  return t;
+}
+
+int chip8_trace_close(Chip8Trace* t) {
+  if (!t) {
+    return -1;
+  }
+  if (chip8_trace_active == t) {
+    chip8_trace_active = NULL;
+  }
+  atomic_store_explicit(&t->stop, 1, memory_order_release);
+  pthread_join(*(pthread_t*)t->thread, NULL);
+  int status = t->write_error ? -1 : 0;
+  if (fclose(t->file) != 0) {
+    status = -1;
+  }
+  free(t->thread);
+  free(t->ring);
+  free(t);
+  return status;
+}
+
+void chip8_trace_attach(Chip8Trace* t) {
+  chip8_trace_active = t;
+}
+
+void chip8_trace_advance(Chip8Trace* t, uint64_t n) {
+  if (t) {
+    t->cycles += n;
+  }
+}
+
+void chip8_trace_record(Chip8Trace* t, const Chip8* chip8, uint16_t pc, uint16_t opcode, const uint8_t v_before[16]) {
+  t->cycles++;
+  size_t head = atomic_load_explicit(&t->head, memory_order_relaxed);
+  if (head - t->cached_tail >= CHIP8_TRACE_RING) {
+    t->cached_tail = atomic_load_explicit(&t->tail, memory_order_acquire);
+    if (head - t->cached_tail >= CHIP8_TRACE_RING) {
+      // Ring cheio: descarta sem esperar; o delta do próximo registro inclui este ciclo
+      t->dropped++;
+      t->pending |= CHIP8_TRACE_GAP;
+      return;
+    }
+  }
+
+  Chip8TraceRecord* r = &t->ring[head & (CHIP8_TRACE_RING - 1)];
+  r->pc = pc;
+  r->opcode = opcode;
+  r->i = chip8->I;
+  r->reg = t->pending;
+  r->value = 0;
+  if (memcmp(v_before, chip8->V, 16) != 0) {
+    int k = 0;
+    while (v_before[k] == chip8->V[k]) {
+      k++;
+    }
+    r->reg |= CHIP8_TRACE_REG_CHANGED | (uint8_t)k;
+    r->value = chip8->V[k];
+    if (memcmp(v_before + k + 1, chip8->V + k + 1, (size_t)(15 - k)) != 0) {
+      r->reg |= CHIP8_TRACE_REG_MULTI;
+    }
+  }
+  r->delta = t->cycles > UINT32_MAX ? UINT32_MAX : (uint32_t)t->cycles;
+  t->cycles = 0;
+  t->pending = 0;
+  t->records++;
+  // release: a thread de gravação vê o registro completo antes do novo head
+  atomic_store_explicit(&t->head, head + 1, memory_order_release);
+}
+
+#else // Sem -DCHIP8_TRACE: nada é gravado
+
+Chip8Trace* chip8_trace_open(const char* path) {
+  (void)path;
+  return NULL;
+}
+
+int chip8_trace_close(Chip8Trace* t) {
+  (void)t;
+  return -1;
+}
+
+void chip8_trace_attach(Chip8Trace* t) {
+  (void)t;
+}
+
+void chip8_trace_advance(Chip8Trace* t, uint64_t n) {
+  (void)t;
+  (void)n;
+}
+
+#endif
+
+int chip8_trace_read_header(FILE* in) {
+  uint8_t header[16];
+  if (fread(header, 1, sizeof(header), in) != sizeof(header) ||
+      memcmp(header, trace_magic, sizeof(trace_magic)) != 0 ||
+      get16(header + 8) != CHIP8_TRACE_VERSION || get16(header + 10) != CHIP8_TRACE_RECORD_SIZE) {
+    return -1;
+  }
+  return 0;
+}
+
+int chip8_trace_read(FILE* in, Chip8TraceRecord* r) {
+  uint8_t p[CHIP8_TRACE_RECORD_SIZE];
+  if (fread(p, 1, sizeof(p), in) != sizeof(p)) {
+    return 0;
+  }
+  r->pc = get16(p);
+  r->opcode = get16(p + 2);
+  r->i = get16(p + 4);
+  r->reg = p[6];
+  r->value = p[7];
+  r->delta = get32(p + 8);
+  return 1;
+}
+
+const char* chip8_disassemble(uint16_t opcode, char* out, size_t size) {
+  unsigned x = (opcode >> 8) & 0x0F;
+  unsigned y = (opcode >> 4) & 0x0F;
+  unsigned n = opcode & 0x0F;
+  unsigned kk = opcode & 0xFF;
+  unsigned nnn = opcode & 0x0FFF;
+
+  switch (opcode & 0xF000) {
+    case 0x0000:
+      if (opcode == 0x00E0) {
+        snprintf(out, size, "CLS");
+      } else if (opcode == 0x00EE) {
+        snprintf(out, size, "RET");
+      } else {
+        snprintf(out, size, "SYS 0x%03X", nnn);
+      }
+      return out;
+    case 0x1000: snprintf(out, size, "JP 0x%03X", nnn); return out;
+    case 0x2000: snprintf(out, size, "CALL 0x%03X", nnn); return out;
+    case 0x3000: snprintf(out, size, "SE V%X, 0x%02X", x, kk); return out;
+    case 0x4000: snprintf(out, size, "SNE V%X, 0x%02X", x, kk); return out;
+    case 0x5000:
+      if (n == 0) {
+        snprintf(out, size, "SE V%X, V%X", x, y);
+        return out;
+      }
+      break;
+    case 0x6000: snprintf(out, size, "LD V%X, 0x%02X", x, kk); return out;
+    case 0x7000: snprintf(out, size, "ADD V%X, 0x%02X", x, kk); return out;
+    case 0x8000: {
+      static const char* const alu[16] = {
+        "LD", "OR", "AND", "XOR", "ADD", "SUB", "SHR", "SUBN",
+        NULL, NULL, NULL, NULL, NULL, NULL, "SHL", NULL
+      };
+      if (alu[n]) {
+        snprintf(out, size, "%s V%X, V%X", alu[n], x, y);
+        return out;
+      }
+      break;
+    }
+    case 0x9000:
+      if (n == 0) {
+        snprintf(out, size, "SNE V%X, V%X", x, y);
+        return out;
+      }
+      break;
+    case 0xA000: snprintf(out, size, "LD I, 0x%03X", nnn); return out;
+    case 0xB000: snprintf(out, size, "JP V0, 0x%03X", nnn); return out;
+    case 0xC000: snprintf(out, size, "RND V%X, 0x%02X", x, kk); return out;
+    case 0xD000: snprintf(out, size, "DRW V%X, V%X, %u", x, y, n); return out;
+    case 0xE000:
+      if (kk == 0x9E) {
+        snprintf(out, size, "SKP V%X", x);
+        return out;
+      }
+      if (kk == 0xA1) {
+        snprintf(out, size, "SKNP V%X", x);
+        return out;
+      }
+      break;
+    case 0xF000:
+      switch (kk) {
+        case 0x07: snprintf(out, size, "LD V%X, DT", x); return out;
+        case 0x0A: snprintf(out, size, "LD V%X, K", x); return out;
+        case 0x15: snprintf(out, size, "LD DT, V%X", x); return out;
+        case 0x18: snprintf(out, size, "LD ST, V%X", x); return out;
+        case 0x1E: snprintf(out, size, "ADD I, V%X", x); return out;
+        case 0x29: snprintf(out, size, "LD F, V%X", x); return out;
+        case 0x33: snprintf(out, size, "LD B, V%X", x); return out;
+        case 0x55: snprintf(out, size, "LD [I], V%X", x); return out;
+        case 0x65: snprintf(out, size, "LD V%X, [I]", x); return out;
+      }
+      break;
+  }
+  snprintf(out, size, "DW 0x%04X", opcode);
+  return out;
+}
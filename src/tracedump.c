@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace.h"
+
+// Decodifica um trace gravado com --trace (chip8_headless) em desmontagem:
+// uma linha por instrução com o ciclo emulado, PC, opcode, mnemônico, o
+// registrador alterado e I
+
+static void usage(const char* prog) {
+  printf("Uso: %s arquivo.trace [-s ciclo] [-n registros] [--pc endereco]\n", prog);
+  printf("  -s C         começa no primeiro registro a partir do ciclo C\n");
+  printf("  -n N         mostra no máximo N registros\n");
+  printf("  --pc A       só as instruções no endereço A (hexadecimal)\n");
+}
+
+int main(int argc, char* argv[]) {
+  const char* path = NULL;
+  unsigned long long start_cycle = 0;
+  unsigned long long limit = 0; // 0 = todos
+  long pc_filter = -1;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      start_cycle = strtoull(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      limit = strtoull(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "--pc") == 0 && i + 1 < argc) {
+      pc_filter = strtol(argv[++i], NULL, 16);
+    } else if (argv[i][0] != '-' && !path) {
+      path = argv[i];
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (!path) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  FILE* in = fopen(path, "rb");
+  if (!in) {
+    printf("Erro: não foi possível abrir %s\n", path);
+    return 1;
+  }
+  if (chip8_trace_read_header(in) != 0) {
+    printf("Erro: %s não é um trace (ou é de outra versão)\n", path);
+    fclose(in);
+    return 1;
+  }
+
+  // O ciclo de cada registro é a soma dos deltas: o primeiro registro é o ciclo 1
+  Chip8TraceRecord r;
+  unsigned long long cycle = 0, records = 0, shown = 0, gaps = 0, ticks = 0;
+  char text[32];
+  while (chip8_trace_read(in, &r)) {
+    cycle += r.delta;
+    records++;
+    gaps += (r.reg & CHIP8_TRACE_GAP) != 0;
+    ticks += (r.reg & CHIP8_TRACE_TICK) != 0;
+    if (cycle < start_cycle || (pc_filter >= 0 && r.pc != pc_filter) || (limit && shown >= limit)) {
+      continue;
+    }
+    if (r.reg & CHIP8_TRACE_GAP) {
+      printf("             ... registros descartados (ring cheio)\n");
+    }
+    char change[16] = "";
+    if (r.reg & CHIP8_TRACE_REG_CHANGED) {
+      snprintf(change, sizeof(change), "V%X=%02X%s", r.reg & 0x0F, r.value,
+               (r.reg & CHIP8_TRACE_REG_MULTI) ? "+" : "");
+    }
+    printf("%12llu  %03X  %04X  %-16s %-8s I=%03X%s\n", cycle, r.pc, r.opcode,
+           chip8_disassemble(r.opcode, text, sizeof(text)), change, r.i,
+           (r.reg & CHIP8_TRACE_TICK) ? "  [tick]" : "");
+    shown++;
+  }
+  fclose(in);
+
+  printf("%llu registros, %llu ciclos, %llu ticks, %llu trechos descartados\n", records, cycle, ticks, gaps);
+  return 0;
+}
@@ -0,0 +1,49 @@
+#include <string.h>
+#include "triple.h"
+
+#define TRIPLE_FRESH 4u // Bit de middle: o buffer intermediário ainda não foi consumido
+
+void chip8_triple_init(Chip8TripleBuffer* t) {
+  memset(t->buffers, 0, sizeof(t->buffers));
+  t->back = 0;
+  t->carry_dirty = 0;
+  t->carry_input = 0;
+  t->front = 2;
+  atomic_init(&t->middle, 1u);
+}
+
+void chip8_triple_publish(Chip8TripleBuffer* t, Chip8* chip8, uint64_t frame, uint64_t input_time) {
+  Chip8Frame* f = &t->buffers[t->back];
+  memcpy(f->display, chip8->display, sizeof(f->display));
+  f->machine = chip8->machine;
+  f->hires = chip8->hires;
+  if (chip8->machine != CHIP8_MACHINE_CHIP8) {
+    memcpy(f->screen, chip8->ext->screen, sizeof(f->screen));
+  }
+  f->dirty_rows = chip8_take_dirty_rows(chip8) | t->carry_dirty;
+  f->display_gen = chip8->display_gen;
+  f->frame = frame;
+  f->input_time = t->carry_input ? t->carry_input : input_time;
+
+  // release: o leitor que pegar este índice vê o conteúdo acima
+  unsigned old = atomic_exchange_explicit(&t->middle, t->back | TRIPLE_FRESH, memory_order_acq_rel);
+  t->back = old & 3u;
+
+  // O frame substituído não chegou ao leitor: suas linhas sujas e a entrada seguem para o próximo
+  t->carry_dirty = (old & TRIPLE_FRESH) ? t->buffers[t->back].dirty_rows : 0;
+  t->carry_input = (old & TRIPLE_FRESH) ? t->buffers[t->back].input_time : 0;
+}
+
+int chip8_triple_acquire(Chip8TripleBuffer* t) {
+  if (!(atomic_load_explicit(&t->middle, memory_order_relaxed) & TRIPLE_FRESH)) {
+    return 0;
+  }
+  // acquire: pareia com o release do escritor
+  unsigned old = atomic_exchange_explicit(&t->middle, t->front, memory_order_acq_rel);
+  t->front = old & 3u;
+  return 1;
+}
+
+const Chip8Frame* chip8_triple_front(const Chip8TripleBuffer* t) {
+  return &t->buffers[t->front];
+}